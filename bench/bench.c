@@ -0,0 +1,418 @@
+// bench.c
+// Headless micro-benchmarks for the editing core. The core modules are
+// linked against the raylib stand-in in bench/stub, tile and wall data are
+// loaded through the regular loaders from an in-memory database, and every
+// scenario is reported as one JSON object per line on stdout.
+#define _POSIX_C_SOURCE 200809L // dup, fdopen
+
+#include "database.h"
+#include "draw.h"
+#include "edge.h"
+#include "grid.h"
+#include "profile.h"
+#include "renderbench.h"
+#include "undo.h"
+#include "wall.h"
+#include <sqlite3.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// definitions
+#define BENCH_MAX_REPS 64
+
+// structs
+typedef struct {
+  sqlite3 *db;
+  Map *map;
+  Tile *tileTypes;
+  Edge *edgeTypes;
+  Wall *wallTypes;
+  WallOrientMap *wallOrientationMap;
+  DrawingState *drawState;
+  UndoRedoManager manager;
+  int (*coords)[2]; // scratch coordinate list, GRID_SIZE^2 entries
+  int coordCount;
+  int undoDepth;
+} BenchContext;
+
+typedef struct {
+  int reps;         // timed repetitions per scenario
+  int warmup;       // untimed operations before the first repetition
+  double minRepMs;  // each repetition runs until at least this long
+  const char *only; // run only scenarios whose name contains this
+  FILE *out;        // results stream (stdout before it is silenced)
+} BenchOptions;
+
+typedef void (*BenchOp)(BenchContext *ctx);
+
+// Sample data mirroring utils/generate_tables.sh and assets/*.conf
+static const char *schemaSql =
+    "CREATE TABLE tile(tile_key INTEGER PRIMARY KEY, walkable INTEGER,"
+    "  edge_indicator INTEGER, edge_priority INTEGER);"
+    "CREATE TABLE texture(texture_key INTEGER PRIMARY KEY, type TEXT,"
+    "  tile_key INTEGER, wall_quadrant_key INTEGER, data BLOB);"
+    "CREATE TABLE wall(wall_key INTEGER PRIMARY KEY, orientation_key INTEGER,"
+    "  wall_group_key INTEGER, wall_type_key INTEGER);"
+    "CREATE TABLE wall_quadrant(wall_quadrant_key INTEGER PRIMARY KEY,"
+    "  wall_key INTEGER, quadrant_key INTEGER,"
+    "  primary_wall_quadrant_indicator INTEGER);"
+    "INSERT INTO tile VALUES (0, 0, 0, 1), (1, 0, 1, 4), (2, 0, 0, 1),"
+    "  (3, 0, 1, 3), (4, 0, 0, 1), (5, 0, 1, 2);"
+    "INSERT INTO wall VALUES (1, 1, 1, 1), (2, 2, 1, 1), (3, 3, 1, 1),"
+    "  (4, 4, 1, 1), (5, 1, 1, 2), (6, 2, 1, 2), (7, 1, 1, 3), (8, 2, 1, 3);";
+
+static const int tileVariants[][2] = {
+    {0, 1}, {1, 20}, {2, 8}, {3, 8}, {4, 7}, {5, 5}};
+static const int edgeTileKeys[] = {1, 3, 5};
+
+// Setup functions
+static void insertTexture(sqlite3_stmt *stmt, const char *type, int tileKey,
+                          int wallQuadrantKey) {
+  sqlite3_bind_text(stmt, 1, type, -1, SQLITE_STATIC);
+  sqlite3_bind_int(stmt, 2, tileKey);
+  sqlite3_bind_int(stmt, 3, wallQuadrantKey);
+  sqlite3_bind_zeroblob(stmt, 4, TILE_SIZE * TILE_SIZE * 4);
+  sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+}
+
+static sqlite3 *createBenchDatabase(void) {
+  sqlite3 *db;
+  if (sqlite3_open(":memory:", &db) != SQLITE_OK ||
+      sqlite3_exec(db, schemaSql, NULL, NULL, NULL) != SQLITE_OK) {
+    fprintf(stderr, "Error creating bench database: %s\n", sqlite3_errmsg(db));
+    return NULL;
+  }
+
+  sqlite3_stmt *texStmt;
+  sqlite3_prepare_v2(db,
+                     "INSERT INTO texture (type, tile_key, wall_quadrant_key, "
+                     "data) VALUES (?, ?, ?, ?);",
+                     -1, &texStmt, NULL);
+  sqlite3_stmt *quadStmt;
+  sqlite3_prepare_v2(db, "INSERT INTO wall_quadrant VALUES (?, ?, ?, ?);", -1,
+                     &quadStmt, NULL);
+
+  sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+  for (size_t i = 0; i < sizeof(tileVariants) / sizeof(tileVariants[0]);
+       i++) {
+    for (int v = 0; v < tileVariants[i][1]; v++) {
+      insertTexture(texStmt, "tile", tileVariants[i][0], 0);
+    }
+  }
+  for (size_t i = 0; i < sizeof(edgeTileKeys) / sizeof(edgeTileKeys[0]);
+       i++) {
+    for (int e = 0; e < 12; e++) {
+      insertTexture(texStmt, "edge", edgeTileKeys[i], 0);
+    }
+  }
+  int wallQuadrantKey = 1;
+  for (int wallKey = 1; wallKey <= 8; wallKey++) {
+    for (int quadrant = 1; quadrant <= 4; quadrant++) {
+      sqlite3_bind_int(quadStmt, 1, wallQuadrantKey);
+      sqlite3_bind_int(quadStmt, 2, wallKey);
+      sqlite3_bind_int(quadStmt, 3, quadrant);
+      sqlite3_bind_int(quadStmt, 4, quadrant == 4);
+      sqlite3_step(quadStmt);
+      sqlite3_reset(quadStmt);
+      insertTexture(texStmt, "wall", 0, wallQuadrantKey);
+      wallQuadrantKey++;
+    }
+  }
+  sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
+
+  sqlite3_finalize(texStmt);
+  sqlite3_finalize(quadStmt);
+  return db;
+}
+
+static void fillSquare(BenchContext *ctx, int size) {
+  WorldCoords coords = {0, 0, size - 1, size - 1};
+  ctx->coordCount = getBoundingBoxSize(coords);
+  coordsToArray(coords, ctx->coords);
+}
+
+static void fillPerimeter(BenchContext *ctx, int size) {
+  WorldCoords coords = {0, 0, size - 1, size - 1};
+  ctx->coordCount = getBoundingPerimeterSize(coords);
+  coordsToPerimeterArray(coords, ctx->coords);
+}
+
+static Array2DPtr coordData(BenchContext *ctx) {
+  return (Array2DPtr){.arrayLength = ctx->coordCount, .array = ctx->coords};
+}
+
+// Timing
+static int compareDoubles(const void *a, const void *b) {
+  double da = *(const double *)a;
+  double db = *(const double *)b;
+  return (da > db) - (da < db);
+}
+
+static void measure(BenchOptions *options, BenchContext *ctx,
+                    const char *scenario, const char *param, int value,
+                    long cellsPerOp, BenchOp op) {
+  if (options->only != NULL && strstr(scenario, options->only) == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < options->warmup; i++) {
+    op(ctx);
+  }
+
+  double nsPerOp[BENCH_MAX_REPS];
+  long totalOps = 0;
+  for (int r = 0; r < options->reps; r++) {
+    long ops = 0;
+    double start = profileNow();
+    double elapsed = 0.0;
+    do {
+      op(ctx);
+      ops++;
+      elapsed = profileNow() - start;
+    } while (elapsed < options->minRepMs);
+    nsPerOp[r] = elapsed * 1000000.0 / ops;
+    totalOps += ops;
+  }
+
+  qsort(nsPerOp, options->reps, sizeof(double), compareDoubles);
+  double median = nsPerOp[options->reps / 2];
+  double cellsPerSecond = median > 0.0 ? cellsPerOp * 1e9 / median : 0.0;
+
+  fprintf(options->out,
+          "{\"scenario\":\"%s\",\"param\":\"%s\",\"value\":%d,"
+          "\"grid_size\":%d,\"cells_per_op\":%ld,\"reps\":%d,\"ops\":%ld,"
+          "\"ns_per_op\":%.1f,\"ns_per_op_min\":%.1f,\"ns_per_op_max\":%.1f,"
+          "\"cells_per_s\":%.0f}\n",
+          scenario, param, value, GRID_SIZE, cellsPerOp, options->reps,
+          totalOps, median, nsPerOp[0], nsPerOp[options->reps - 1],
+          cellsPerSecond);
+  fflush(options->out);
+}
+
+// Operations
+static void opComputeEdges(BenchContext *ctx) {
+  computeEdges(ctx->coords, ctx->coordCount, ctx->map, ctx->tileTypes,
+               ctx->edgeTypes);
+}
+
+static void opComputeWalls(BenchContext *ctx) {
+  computeWalls(ctx->coords, ctx->coordCount, ctx->map, ctx->wallTypes);
+}
+
+static void opCalculatePath(BenchContext *ctx) {
+  WorldCoords coords = {0, 0, ctx->coords[0][0], ctx->coords[0][1]};
+  int length = abs(coords.endX) + abs(coords.endY) + 1;
+  Array2DPtr pathData = {.arrayLength = length, .array = ctx->coords + 1};
+  calculatePath(coords, pathData, ctx->drawState);
+}
+
+static void opUpdateDrawnTiles(BenchContext *ctx) {
+  updateDrawnTiles(coordData(ctx), ctx->drawState, ctx->tileTypes);
+}
+
+static void opWallOrientations(BenchContext *ctx) {
+  calculateWallOrientations(ctx->drawState, ctx->wallOrientationMap);
+}
+
+static void opUndoRedo(BenchContext *ctx) {
+  for (int i = 0; i < ctx->undoDepth; i++) {
+    undo(&ctx->manager, ctx->map, ctx->tileTypes, ctx->edgeTypes,
+         ctx->wallTypes);
+  }
+  for (int i = 0; i < ctx->undoDepth; i++) {
+    redo(&ctx->manager, ctx->map, ctx->tileTypes, ctx->edgeTypes,
+         ctx->wallTypes);
+  }
+}
+
+// Scenarios
+static void resetDrawState(DrawingState *drawState, DrawType drawType,
+                           DrawMode drawMode) {
+  drawState->drawType = drawType;
+  drawState->drawMode = drawMode;
+  drawState->pathMode = PATH_DIAGONAL;
+  drawState->previousPathMode = PATH_DIAGONAL;
+  drawState->activeTileKey = 3;
+  drawState->activeWallKey = 1;
+  drawState->drawnTilesCount = 0;
+  drawState->hasCapturedDragDirection = false;
+}
+
+static void benchMapPasses(BenchOptions *options, BenchContext *ctx) {
+  const int mapSizes[] = {16, 32, 64, 128, 256, 512, 1024};
+  for (size_t i = 0; i < sizeof(mapSizes) / sizeof(mapSizes[0]); i++) {
+    int size = mapSizes[i];
+    if (size > GRID_SIZE) {
+      break;
+    }
+    fillSquare(ctx, size);
+    measure(options, ctx, "computeEdges", "map_size", size, ctx->coordCount,
+            opComputeEdges);
+    measure(options, ctx, "computeWalls", "map_size", size, ctx->coordCount,
+            opComputeWalls);
+  }
+}
+
+static void benchPaths(BenchOptions *options, BenchContext *ctx) {
+  const int pathLengths[] = {8, 32, 128, 512};
+  for (size_t i = 0; i < sizeof(pathLengths) / sizeof(pathLengths[0]); i++) {
+    int length = pathLengths[i];
+    if (length >= GRID_SIZE) {
+      length = GRID_SIZE - 1;
+    }
+
+    // Shallow L-shaped path, stored after the end point in coords[0]
+    resetDrawState(ctx->drawState, DRAW_WALL, MODE_PATHING);
+    ctx->coords[0][0] = length;
+    ctx->coords[0][1] = length / 2;
+    measure(options, ctx, "calculatePath", "path_length", length,
+            length + length / 2 + 1, opCalculatePath);
+
+    // Orient the walls of the same path
+    opCalculatePath(ctx);
+    int count = length + length / 2 + 1;
+    for (int j = 0; j < count; j++) {
+      ctx->drawState->drawnTiles[j][0] = ctx->coords[j + 1][0];
+      ctx->drawState->drawnTiles[j][1] = ctx->coords[j + 1][1];
+    }
+    ctx->drawState->drawnTilesCount = count;
+    measure(options, ctx, "calculateWallOrientations", "path_length", length,
+            count, opWallOrientations);
+
+    if (length == GRID_SIZE - 1) {
+      break;
+    }
+  }
+}
+
+static void benchBoxes(BenchOptions *options, BenchContext *ctx) {
+  const int boxSizes[] = {4, 8, 16, 32, 64};
+  for (size_t i = 0; i < sizeof(boxSizes) / sizeof(boxSizes[0]); i++) {
+    int size = boxSizes[i];
+    if (size > GRID_SIZE) {
+      break;
+    }
+
+    // Steady state of a box drag: the same box every frame
+    resetDrawState(ctx->drawState, DRAW_TILE, MODE_BOX);
+    fillSquare(ctx, size);
+    opUpdateDrawnTiles(ctx);
+    measure(options, ctx, "updateDrawnTiles", "box_size", size,
+            ctx->coordCount, opUpdateDrawnTiles);
+
+    resetDrawState(ctx->drawState, DRAW_WALL, MODE_BOX);
+    fillPerimeter(ctx, size);
+    opUpdateDrawnTiles(ctx);
+    measure(options, ctx, "calculateWallOrientations", "box_size", size,
+            ctx->coordCount, opWallOrientations);
+  }
+}
+
+static void benchUndo(BenchOptions *options, BenchContext *ctx) {
+  const int undoDepths[] = {1, 8, 32, 128};
+  const int boxSize = 8;
+  for (size_t i = 0; i < sizeof(undoDepths) / sizeof(undoDepths[0]); i++) {
+    int depth = undoDepths[i];
+    freeUndoHistory(&ctx->manager);
+
+    // Paint `depth` boxes across the map, one batch each
+    for (int d = 0; d < depth; d++) {
+      int x0 = (d * boxSize) % (GRID_SIZE - boxSize);
+      int y0 = ((d * boxSize) / (GRID_SIZE - boxSize) * boxSize) %
+               (GRID_SIZE - boxSize);
+      WorldCoords coords = {x0, y0, x0 + boxSize - 1, y0 + boxSize - 1};
+      resetDrawState(ctx->drawState, DRAW_TILE, MODE_BOX);
+      ctx->drawState->activeTileKey = 1 + d % 5;
+      ctx->coordCount = getBoundingBoxSize(coords);
+      coordsToArray(coords, ctx->coords);
+      opUpdateDrawnTiles(ctx);
+
+      int (*visitedTiles)[2] = malloc(GRID_SIZE * GRID_SIZE * sizeof(int[2]));
+      int visitedCount = 0;
+      calculateEdgeGrid(ctx->drawState, visitedTiles, &visitedCount);
+      createTileChangeBatch(&ctx->manager, ctx->map, ctx->drawState,
+                            visitedTiles, visitedCount);
+      applyTiles(ctx->map, ctx->drawState);
+      computeEdges(visitedTiles, visitedCount, ctx->map, ctx->tileTypes,
+                   ctx->edgeTypes);
+      free(visitedTiles);
+    }
+
+    ctx->undoDepth = depth;
+    measure(options, ctx, "undoRedo", "undo_depth", depth,
+            2L * depth * boxSize * boxSize, opUndoRedo);
+  }
+  freeUndoHistory(&ctx->manager);
+}
+
+// Entry point
+int main(int argc, char *argv[]) {
+  BenchOptions options = {
+      .reps = 7, .warmup = 3, .minRepMs = 20.0, .only = NULL};
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+      options.reps = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+      options.warmup = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+      options.minRepMs = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc) {
+      options.only = argv[++i];
+    } else {
+      fprintf(stderr,
+              "Usage: %s [--reps N] [--warmup N] [--min-ms MS] [--only NAME]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (options.reps < 1) {
+    options.reps = 1;
+  } else if (options.reps > BENCH_MAX_REPS) {
+    options.reps = BENCH_MAX_REPS;
+  }
+
+  // Keep results on the real stdout and silence the core's logging
+  options.out = fdopen(dup(STDOUT_FILENO), "w");
+  if (options.out == NULL || freopen("/dev/null", "w", stdout) == NULL) {
+    fprintf(stderr, "Error redirecting output\n");
+    return 1;
+  }
+
+  BenchContext ctx = {0};
+  ctx.db = createBenchDatabase();
+  ctx.map = (Map *)calloc(1, sizeof(Map));
+  ctx.drawState = (DrawingState *)calloc(1, sizeof(DrawingState));
+  ctx.coords = malloc((GRID_SIZE * GRID_SIZE + 1) * sizeof(int[2]));
+  if (ctx.db == NULL || ctx.map == NULL || ctx.drawState == NULL ||
+      ctx.coords == NULL) {
+    fprintf(stderr, "Bench setup failed\n");
+    return 1;
+  }
+
+  ctx.tileTypes = loadTiles(ctx.db, ctx.map);
+  ctx.edgeTypes = loadEdges(ctx.db, ctx.map);
+  ctx.wallTypes = loadWalls(ctx.db, ctx.map);
+  ctx.wallOrientationMap = loadWallOrientationsMap(ctx.db);
+  if (ctx.tileTypes == NULL || ctx.edgeTypes == NULL ||
+      ctx.wallTypes == NULL || ctx.wallOrientationMap == NULL) {
+    fprintf(stderr, "Bench setup failed\n");
+    return 1;
+  }
+
+  generateBenchMap(ctx.map, ctx.tileTypes, 1);
+  computeMapEdges(ctx.tileTypes, ctx.edgeTypes, ctx.map);
+  computeMapWalls(ctx.wallTypes, ctx.map);
+
+  benchMapPasses(&options, &ctx);
+  benchPaths(&options, &ctx);
+  benchBoxes(&options, &ctx);
+  benchUndo(&options, &ctx);
+
+  fclose(options.out);
+  sqlite3_close(ctx.db);
+  return 0;
+}
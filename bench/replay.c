@@ -0,0 +1,157 @@
+// replay.c
+// Headless replay of a session recorded with `./main --record <file>`. The
+// recorded frames are fed through editorFrame against the raylib stand-in
+// as fast as possible, with the RNG seeded from the recording so tile
+// styles come out the same as in the live session. The database is opened
+// read-only, so :save commands in the recording leave it untouched.
+#define _POSIX_C_SOURCE 200809L // dup, fdopen
+
+#include "editor.h"
+#include "input.h"
+#include "profile.h"
+#include "trace.h"
+#include <sqlite3.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Helper functions
+static int compareDoubles(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int count, double p) {
+  if (count == 0) {
+    return 0.0;
+  }
+  int index = (int)(p * (count - 1) + 0.5);
+  return sorted[index];
+}
+
+static void usage(void) {
+  printf("Usage: replay <recording> [--db <path>] [--trace [file]]\n");
+}
+
+// Entry point
+int main(int argc, char *argv[]) {
+
+  // Parse command line options
+  const char *recordingPath = NULL;
+  const char *dbPath = "test.db";
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--db") == 0 && i + 1 < argc) {
+      dbPath = argv[++i];
+    } else if (strcmp(argv[i], "--trace") == 0) {
+      const char *path = TRACE_DEFAULT_PATH;
+      if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+        path = argv[++i];
+      }
+      traceInit(path, TRACE_CAPACITY);
+    } else if (argv[i][0] != '-' && recordingPath == NULL) {
+      recordingPath = argv[i];
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  if (recordingPath == NULL) {
+    usage();
+    return 1;
+  }
+
+  InputRecordingHeader header;
+  FILE *recording = inputRecordingOpen(recordingPath, &header);
+  if (recording == NULL) {
+    return 1;
+  }
+
+  sqlite3 *db;
+  if (sqlite3_open_v2(dbPath, &db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK) {
+    printf("Error opening database %s: %s\n", dbPath, sqlite3_errmsg(db));
+    fclose(recording);
+    return 1;
+  }
+
+  // Editor output is silenced; the report goes to the original stdout
+  FILE *out = fdopen(dup(fileno(stdout)), "w");
+  fflush(stdout);
+  if (freopen("/dev/null", "w", stdout) == NULL) {
+    out = stderr;
+  }
+
+  // Size the editor from the first recorded frame
+  InputFrame input;
+  int windowWidth = 800;
+  int windowHeight = 600;
+  long firstFrame = ftell(recording);
+  if (inputRecordingRead(recording, &input)) {
+    windowWidth = input.screenWidth;
+    windowHeight = input.screenHeight;
+  }
+  fseek(recording, firstFrame, SEEK_SET);
+
+  srand(header.seed);
+  header.mapTable[sizeof(header.mapTable) - 1] = '\0';
+  Editor *editor = (Editor *)calloc(1, sizeof(Editor));
+  editorInit(editor, db, header.mapTable, windowWidth, windowHeight);
+
+  // Feed every recorded frame through the editor
+  int capacity = 1024;
+  int frameCount = 0;
+  double *frameMs = (double *)malloc(capacity * sizeof(double));
+  double stageTotals[STAGE_COUNT] = {0};
+  double replayStart = profileNow();
+  while (inputRecordingRead(recording, &input)) {
+    profileBeginFrame();
+    editorFrame(editor, &input);
+    profileEndFrame();
+
+    const FrameProfile *frame = profileLastFrame();
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+      stageTotals[stage] += frame->stageMs[stage];
+    }
+
+    if (frameCount == capacity) {
+      capacity *= 2;
+      frameMs = (double *)realloc(frameMs, capacity * sizeof(double));
+    }
+    frameMs[frameCount] = frame->frameMs;
+    frameCount++;
+  }
+  double totalMs = profileNow() - replayStart;
+  fclose(recording);
+
+  // Report
+  qsort(frameMs, frameCount, sizeof(double), compareDoubles);
+  double sum = 0.0;
+  for (int i = 0; i < frameCount; i++) {
+    sum += frameMs[i];
+  }
+  fprintf(out, "recording:  %s (seed %u, map %s)\n", recordingPath,
+          header.seed, header.mapTable);
+  fprintf(out, "frames:     %d\n", frameCount);
+  fprintf(out, "total:      %.3f ms\n", totalMs);
+  fprintf(out, "frame mean: %.4f ms\n", frameCount ? sum / frameCount : 0.0);
+  fprintf(out, "frame p50:  %.4f ms\n", percentile(frameMs, frameCount, 0.50));
+  fprintf(out, "frame p95:  %.4f ms\n", percentile(frameMs, frameCount, 0.95));
+  fprintf(out, "frame p99:  %.4f ms\n", percentile(frameMs, frameCount, 0.99));
+  fprintf(out, "frame max:  %.4f ms\n",
+          frameCount ? frameMs[frameCount - 1] : 0.0);
+  for (int stage = 0; stage < STAGE_COUNT; stage++) {
+    fprintf(out, "stage %-15s %.3f ms\n", profileStageName(stage),
+            stageTotals[stage]);
+  }
+  fprintf(out, "map hash:   %016llx\n",
+          (unsigned long long)editorMapHash(&editor->map));
+  fflush(out);
+
+  free(frameMs);
+  editorShutdown(editor);
+  free(editor);
+  traceShutdown();
+  sqlite3_close(db);
+  return 0;
+}
@@ -0,0 +1,258 @@
+// raylib.h
+// Headless stand-in for raylib used by the bench and replay targets. It
+// declares the subset of the raylib API used by the editor; the definitions
+// in raylib_stub.c never open a window or touch GL.
+#ifndef RAYLIB_H
+#define RAYLIB_H
+
+// includes
+#include <stdbool.h>
+
+// structs
+typedef struct Vector2 {
+  float x;
+  float y;
+} Vector2;
+
+typedef struct Vector3 {
+  float x;
+  float y;
+  float z;
+} Vector3;
+
+typedef struct Vector4 {
+  float x;
+  float y;
+  float z;
+  float w;
+} Vector4;
+
+typedef struct Matrix {
+  float m0, m4, m8, m12;
+  float m1, m5, m9, m13;
+  float m2, m6, m10, m14;
+  float m3, m7, m11, m15;
+} Matrix;
+
+typedef struct Color {
+  unsigned char r;
+  unsigned char g;
+  unsigned char b;
+  unsigned char a;
+} Color;
+
+typedef struct Rectangle {
+  float x;
+  float y;
+  float width;
+  float height;
+} Rectangle;
+
+typedef struct Image {
+  void *data;
+  int width;
+  int height;
+  int mipmaps;
+  int format;
+} Image;
+
+typedef struct Texture {
+  unsigned int id;
+  int width;
+  int height;
+  int mipmaps;
+  int format;
+} Texture;
+
+typedef Texture Texture2D;
+
+typedef struct RenderTexture {
+  unsigned int id;
+  Texture texture;
+  Texture depth;
+} RenderTexture;
+
+typedef RenderTexture RenderTexture2D;
+
+typedef struct Camera2D {
+  Vector2 offset;
+  Vector2 target;
+  float rotation;
+  float zoom;
+} Camera2D;
+
+// definitions
+#define PI 3.14159265358979323846f
+
+// colors
+#define CLITERAL(type) (type)
+#define LIGHTGRAY CLITERAL(Color){200, 200, 200, 255}
+#define GRAY CLITERAL(Color){130, 130, 130, 255}
+#define DARKGRAY CLITERAL(Color){80, 80, 80, 255}
+#define YELLOW CLITERAL(Color){253, 249, 0, 255}
+#define GOLD CLITERAL(Color){255, 203, 0, 255}
+#define ORANGE CLITERAL(Color){255, 161, 0, 255}
+#define RED CLITERAL(Color){230, 41, 55, 255}
+#define MAROON CLITERAL(Color){190, 33, 55, 255}
+#define GREEN CLITERAL(Color){0, 228, 48, 255}
+#define LIME CLITERAL(Color){0, 158, 47, 255}
+#define SKYBLUE CLITERAL(Color){102, 191, 255, 255}
+#define BLUE CLITERAL(Color){0, 121, 241, 255}
+#define PURPLE CLITERAL(Color){200, 122, 255, 255}
+#define WHITE CLITERAL(Color){255, 255, 255, 255}
+#define BLACK CLITERAL(Color){0, 0, 0, 255}
+#define BLANK CLITERAL(Color){0, 0, 0, 0}
+#define MAGENTA CLITERAL(Color){255, 0, 255, 255}
+#define RAYWHITE CLITERAL(Color){245, 245, 245, 255}
+
+// enums
+typedef enum {
+  FLAG_WINDOW_RESIZABLE = 0x00000004,
+  FLAG_WINDOW_HIDDEN = 0x00000080,
+} ConfigFlags;
+
+typedef enum {
+  KEY_NULL = 0,
+  KEY_SPACE = 32,
+  KEY_MINUS = 45,
+  KEY_SEMICOLON = 59,
+  KEY_EQUAL = 61,
+  KEY_A = 65,
+  KEY_B = 66,
+  KEY_C = 67,
+  KEY_D = 68,
+  KEY_E = 69,
+  KEY_F = 70,
+  KEY_G = 71,
+  KEY_H = 72,
+  KEY_I = 73,
+  KEY_J = 74,
+  KEY_K = 75,
+  KEY_L = 76,
+  KEY_M = 77,
+  KEY_N = 78,
+  KEY_O = 79,
+  KEY_P = 80,
+  KEY_Q = 81,
+  KEY_R = 82,
+  KEY_S = 83,
+  KEY_T = 84,
+  KEY_U = 85,
+  KEY_V = 86,
+  KEY_W = 87,
+  KEY_X = 88,
+  KEY_Y = 89,
+  KEY_Z = 90,
+  KEY_ESCAPE = 256,
+  KEY_ENTER = 257,
+  KEY_TAB = 258,
+  KEY_BACKSPACE = 259,
+  KEY_DELETE = 261,
+  KEY_RIGHT = 262,
+  KEY_LEFT = 263,
+  KEY_DOWN = 264,
+  KEY_UP = 265,
+  KEY_PAGE_UP = 266,
+  KEY_PAGE_DOWN = 267,
+  KEY_F1 = 290,
+  KEY_F2 = 291,
+  KEY_F3 = 292,
+  KEY_F4 = 293,
+  KEY_F5 = 294,
+  KEY_LEFT_SHIFT = 340,
+  KEY_LEFT_CONTROL = 341,
+  KEY_LEFT_ALT = 342,
+  KEY_RIGHT_SHIFT = 344,
+  KEY_RIGHT_CONTROL = 345,
+  KEY_RIGHT_ALT = 346,
+} KeyboardKey;
+
+typedef enum {
+  MOUSE_BUTTON_LEFT = 0,
+  MOUSE_BUTTON_RIGHT = 1,
+  MOUSE_BUTTON_MIDDLE = 2,
+} MouseButton;
+
+typedef enum {
+  PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 = 7,
+} PixelFormat;
+
+typedef enum {
+  TEXTURE_FILTER_POINT = 0,
+  TEXTURE_FILTER_BILINEAR = 1,
+} TextureFilter;
+
+// window and timing
+void InitWindow(int width, int height, const char *title);
+void CloseWindow(void);
+bool WindowShouldClose(void);
+void SetWindowState(unsigned int flags);
+void SetConfigFlags(unsigned int flags);
+int GetScreenWidth(void);
+int GetScreenHeight(void);
+void SetTargetFPS(int fps);
+float GetFrameTime(void);
+double GetTime(void);
+void SetExitKey(int key);
+void EnableEventWaiting(void);
+void DisableEventWaiting(void);
+
+// drawing
+void ClearBackground(Color color);
+void BeginDrawing(void);
+void EndDrawing(void);
+void BeginMode2D(Camera2D camera);
+void EndMode2D(void);
+void BeginTextureMode(RenderTexture2D target);
+void EndTextureMode(void);
+void BeginScissorMode(int x, int y, int width, int height);
+void EndScissorMode(void);
+
+// input
+bool IsKeyPressed(int key);
+bool IsKeyDown(int key);
+bool IsKeyReleased(int key);
+int GetCharPressed(void);
+bool IsMouseButtonPressed(int button);
+bool IsMouseButtonDown(int button);
+bool IsMouseButtonReleased(int button);
+Vector2 GetMousePosition(void);
+Vector2 GetMouseDelta(void);
+float GetMouseWheelMove(void);
+
+// shapes
+void DrawLine(int startPosX, int startPosY, int endPosX, int endPosY,
+              Color color);
+void DrawLineEx(Vector2 startPos, Vector2 endPos, float thick, Color color);
+void DrawCircleV(Vector2 center, float radius, Color color);
+void DrawRectangle(int posX, int posY, int width, int height, Color color);
+void DrawRectangleRec(Rectangle rec, Color color);
+void DrawRectangleLines(int posX, int posY, int width, int height,
+                        Color color);
+void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color);
+
+// images and textures
+Image GenImageColor(int width, int height, Color color);
+void UnloadImage(Image image);
+void ImageDrawPixel(Image *dst, int posX, int posY, Color color);
+Texture2D LoadTextureFromImage(Image image);
+RenderTexture2D LoadRenderTexture(int width, int height);
+void UnloadTexture(Texture2D texture);
+void UnloadRenderTexture(RenderTexture2D target);
+void UpdateTexture(Texture2D texture, const void *pixels);
+void UpdateTextureRec(Texture2D texture, Rectangle rec, const void *pixels);
+void SetTextureFilter(Texture2D texture, int filter);
+void DrawTexture(Texture2D texture, int posX, int posY, Color tint);
+void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position,
+                    Color tint);
+void DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest,
+                    Vector2 origin, float rotation, Color tint);
+
+// colors and text
+Color Fade(Color color, float alpha);
+void DrawText(const char *text, int posX, int posY, int fontSize, Color color);
+int MeasureText(const char *text, int fontSize);
+const char *TextFormat(const char *text, ...);
+bool CheckCollisionPointRec(Vector2 point, Rectangle rec);
+
+#endif // RAYLIB_H
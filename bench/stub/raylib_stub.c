@@ -0,0 +1,301 @@
+// raylib_stub.c
+// No-op definitions for the headless raylib stand-in. Textures receive
+// unique ids so the editing core can tell loaded textures from empty ones.
+#include "raylib.h"
+#include "rlgl.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Variables
+static unsigned int nextTextureId = 1;
+static int screenWidth = 800;
+static int screenHeight = 600;
+
+// Window and timing
+void InitWindow(int width, int height, const char *title) {
+  (void)title;
+  screenWidth = width;
+  screenHeight = height;
+}
+void CloseWindow(void) {}
+bool WindowShouldClose(void) { return true; }
+void SetWindowState(unsigned int flags) { (void)flags; }
+void SetConfigFlags(unsigned int flags) { (void)flags; }
+int GetScreenWidth(void) { return screenWidth; }
+int GetScreenHeight(void) { return screenHeight; }
+void SetTargetFPS(int fps) { (void)fps; }
+float GetFrameTime(void) { return 1.0f / 60.0f; }
+double GetTime(void) { return 0.0; }
+void SetExitKey(int key) { (void)key; }
+void EnableEventWaiting(void) {}
+void DisableEventWaiting(void) {}
+
+// Drawing
+void ClearBackground(Color color) { (void)color; }
+void BeginDrawing(void) {}
+void EndDrawing(void) {}
+void BeginMode2D(Camera2D camera) { (void)camera; }
+void EndMode2D(void) {}
+void BeginTextureMode(RenderTexture2D target) { (void)target; }
+void EndTextureMode(void) {}
+void BeginScissorMode(int x, int y, int width, int height) {
+  (void)x;
+  (void)y;
+  (void)width;
+  (void)height;
+}
+void EndScissorMode(void) {}
+
+// Input
+bool IsKeyPressed(int key) {
+  (void)key;
+  return false;
+}
+bool IsKeyDown(int key) {
+  (void)key;
+  return false;
+}
+bool IsKeyReleased(int key) {
+  (void)key;
+  return false;
+}
+int GetCharPressed(void) { return 0; }
+bool IsMouseButtonPressed(int button) {
+  (void)button;
+  return false;
+}
+bool IsMouseButtonDown(int button) {
+  (void)button;
+  return false;
+}
+bool IsMouseButtonReleased(int button) {
+  (void)button;
+  return false;
+}
+Vector2 GetMousePosition(void) { return (Vector2){0, 0}; }
+Vector2 GetMouseDelta(void) { return (Vector2){0, 0}; }
+float GetMouseWheelMove(void) { return 0.0f; }
+
+// Shapes
+void DrawLine(int startPosX, int startPosY, int endPosX, int endPosY,
+              Color color) {
+  (void)startPosX;
+  (void)startPosY;
+  (void)endPosX;
+  (void)endPosY;
+  (void)color;
+}
+void DrawLineEx(Vector2 startPos, Vector2 endPos, float thick, Color color) {
+  (void)startPos;
+  (void)endPos;
+  (void)thick;
+  (void)color;
+}
+void DrawCircleV(Vector2 center, float radius, Color color) {
+  (void)center;
+  (void)radius;
+  (void)color;
+}
+void DrawRectangle(int posX, int posY, int width, int height, Color color) {
+  (void)posX;
+  (void)posY;
+  (void)width;
+  (void)height;
+  (void)color;
+}
+void DrawRectangleRec(Rectangle rec, Color color) {
+  (void)rec;
+  (void)color;
+}
+void DrawRectangleLines(int posX, int posY, int width, int height,
+                        Color color) {
+  (void)posX;
+  (void)posY;
+  (void)width;
+  (void)height;
+  (void)color;
+}
+void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color) {
+  (void)rec;
+  (void)lineThick;
+  (void)color;
+}
+
+// Images and textures
+Image GenImageColor(int width, int height, Color color) {
+  Color *pixels = (Color *)malloc(width * height * sizeof(Color));
+  for (int i = 0; pixels != NULL && i < width * height; i++) {
+    pixels[i] = color;
+  }
+  return (Image){.data = pixels,
+                 .width = width,
+                 .height = height,
+                 .mipmaps = 1,
+                 .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+}
+void UnloadImage(Image image) { free(image.data); }
+void ImageDrawPixel(Image *dst, int posX, int posY, Color color) {
+  if (posX >= 0 && posX < dst->width && posY >= 0 && posY < dst->height) {
+    ((Color *)dst->data)[posY * dst->width + posX] = color;
+  }
+}
+Texture2D LoadTextureFromImage(Image image) {
+  return (Texture2D){.id = nextTextureId++,
+                     .width = image.width,
+                     .height = image.height,
+                     .mipmaps = 1,
+                     .format = image.format};
+}
+RenderTexture2D LoadRenderTexture(int width, int height) {
+  Texture2D texture = {.id = nextTextureId++,
+                       .width = width,
+                       .height = height,
+                       .mipmaps = 1,
+                       .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+  return (RenderTexture2D){.id = texture.id, .texture = texture};
+}
+void UnloadTexture(Texture2D texture) { (void)texture; }
+void UnloadRenderTexture(RenderTexture2D target) { (void)target; }
+void UpdateTexture(Texture2D texture, const void *pixels) {
+  (void)texture;
+  (void)pixels;
+}
+void UpdateTextureRec(Texture2D texture, Rectangle rec, const void *pixels) {
+  (void)texture;
+  (void)rec;
+  (void)pixels;
+}
+void SetTextureFilter(Texture2D texture, int filter) {
+  (void)texture;
+  (void)filter;
+}
+void DrawTexture(Texture2D texture, int posX, int posY, Color tint) {
+  (void)texture;
+  (void)posX;
+  (void)posY;
+  (void)tint;
+}
+void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position,
+                    Color tint) {
+  (void)texture;
+  (void)source;
+  (void)position;
+  (void)tint;
+}
+void DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest,
+                    Vector2 origin, float rotation, Color tint) {
+  (void)texture;
+  (void)source;
+  (void)dest;
+  (void)origin;
+  (void)rotation;
+  (void)tint;
+}
+
+// Colors and text
+Color Fade(Color color, float alpha) {
+  if (alpha < 0.0f) {
+    alpha = 0.0f;
+  } else if (alpha > 1.0f) {
+    alpha = 1.0f;
+  }
+  color.a = (unsigned char)(255.0f * alpha);
+  return color;
+}
+void DrawText(const char *text, int posX, int posY, int fontSize,
+              Color color) {
+  (void)text;
+  (void)posX;
+  (void)posY;
+  (void)fontSize;
+  (void)color;
+}
+int MeasureText(const char *text, int fontSize) {
+  int length = 0;
+  while (text[length] != '\0') {
+    length++;
+  }
+  return length * fontSize / 2;
+}
+const char *TextFormat(const char *text, ...) {
+  static char buffer[1024];
+  va_list args;
+  va_start(args, text);
+  vsnprintf(buffer, sizeof(buffer), text, args);
+  va_end(args);
+  return buffer;
+}
+bool CheckCollisionPointRec(Vector2 point, Rectangle rec) {
+  return point.x >= rec.x && point.x < rec.x + rec.width && point.y >= rec.y &&
+         point.y < rec.y + rec.height;
+}
+
+// rlgl
+static unsigned int nextBufferId = 1;
+static int defaultShaderLocs[32] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                                    11, 12, 13, 14, 15};
+
+unsigned int rlLoadVertexArray(void) { return nextBufferId++; }
+unsigned int rlLoadVertexBuffer(const void *buffer, int size, bool dynamic) {
+  (void)buffer;
+  (void)size;
+  (void)dynamic;
+  return nextBufferId++;
+}
+void rlUpdateVertexBuffer(unsigned int bufferId, const void *data, int dataSize,
+                          int offset) {
+  (void)bufferId;
+  (void)data;
+  (void)dataSize;
+  (void)offset;
+}
+void rlUnloadVertexArray(unsigned int vaoId) { (void)vaoId; }
+void rlUnloadVertexBuffer(unsigned int vboId) { (void)vboId; }
+void rlSetVertexAttribute(unsigned int index, int compSize, int type,
+                          bool normalized, int stride, int offset) {
+  (void)index;
+  (void)compSize;
+  (void)type;
+  (void)normalized;
+  (void)stride;
+  (void)offset;
+}
+void rlSetVertexAttributeDefault(int locIndex, const void *value,
+                                 int attribType, int count) {
+  (void)locIndex;
+  (void)value;
+  (void)attribType;
+  (void)count;
+}
+void rlEnableVertexAttribute(unsigned int index) { (void)index; }
+bool rlEnableVertexArray(unsigned int vaoId) { return vaoId != 0; }
+void rlDisableVertexArray(void) {}
+void rlDrawVertexArray(int offset, int count) {
+  (void)offset;
+  (void)count;
+}
+void rlDrawRenderBatchActive(void) {}
+unsigned int rlGetShaderIdDefault(void) { return 1; }
+int *rlGetShaderLocsDefault(void) { return defaultShaderLocs; }
+void rlEnableShader(unsigned int id) { (void)id; }
+void rlDisableShader(void) {}
+void rlSetUniform(int locIndex, const void *value, int uniformType, int count) {
+  (void)locIndex;
+  (void)value;
+  (void)uniformType;
+  (void)count;
+}
+void rlSetUniformMatrix(int locIndex, Matrix mat) {
+  (void)locIndex;
+  (void)mat;
+}
+void rlActiveTextureSlot(int slot) { (void)slot; }
+void rlEnableTexture(unsigned int id) { (void)id; }
+void rlDisableTexture(void) {}
+Matrix rlGetMatrixModelview(void) {
+  return (Matrix){.m0 = 1, .m5 = 1, .m10 = 1, .m15 = 1};
+}
+Matrix rlGetMatrixProjection(void) {
+  return (Matrix){.m0 = 1, .m5 = 1, .m10 = 1, .m15 = 1};
+}
@@ -0,0 +1,83 @@
+// rlgl.h
+// Headless stand-in for the subset of rlgl used by the vertex buffer
+// renderer. Vertex arrays and buffers receive unique ids; nothing is drawn.
+#ifndef RLGL_H
+#define RLGL_H
+
+// includes
+#include "raylib.h"
+#include <stdbool.h>
+
+// definitions
+#define RL_FLOAT 0x1406
+
+// enums
+typedef enum {
+  RL_SHADER_LOC_VERTEX_POSITION = 0,
+  RL_SHADER_LOC_VERTEX_TEXCOORD01,
+  RL_SHADER_LOC_VERTEX_TEXCOORD02,
+  RL_SHADER_LOC_VERTEX_NORMAL,
+  RL_SHADER_LOC_VERTEX_TANGENT,
+  RL_SHADER_LOC_VERTEX_COLOR,
+  RL_SHADER_LOC_MATRIX_MVP,
+  RL_SHADER_LOC_MATRIX_VIEW,
+  RL_SHADER_LOC_MATRIX_PROJECTION,
+  RL_SHADER_LOC_MATRIX_MODEL,
+  RL_SHADER_LOC_MATRIX_NORMAL,
+  RL_SHADER_LOC_VECTOR_VIEW,
+  RL_SHADER_LOC_COLOR_DIFFUSE,
+  RL_SHADER_LOC_COLOR_SPECULAR,
+  RL_SHADER_LOC_COLOR_AMBIENT,
+  RL_SHADER_LOC_MAP_ALBEDO,
+} rlShaderLocationIndex;
+
+#define RL_SHADER_LOC_MAP_DIFFUSE RL_SHADER_LOC_MAP_ALBEDO
+
+typedef enum {
+  RL_SHADER_UNIFORM_FLOAT = 0,
+  RL_SHADER_UNIFORM_VEC2,
+  RL_SHADER_UNIFORM_VEC3,
+  RL_SHADER_UNIFORM_VEC4,
+  RL_SHADER_UNIFORM_INT,
+  RL_SHADER_UNIFORM_IVEC2,
+  RL_SHADER_UNIFORM_IVEC3,
+  RL_SHADER_UNIFORM_IVEC4,
+  RL_SHADER_UNIFORM_SAMPLER2D
+} rlShaderUniformDataType;
+
+typedef enum {
+  RL_SHADER_ATTRIB_FLOAT = 0,
+  RL_SHADER_ATTRIB_VEC2,
+  RL_SHADER_ATTRIB_VEC3,
+  RL_SHADER_ATTRIB_VEC4
+} rlShaderAttributeDataType;
+
+// functions
+unsigned int rlLoadVertexArray(void);
+unsigned int rlLoadVertexBuffer(const void *buffer, int size, bool dynamic);
+void rlUpdateVertexBuffer(unsigned int bufferId, const void *data, int dataSize,
+                          int offset);
+void rlUnloadVertexArray(unsigned int vaoId);
+void rlUnloadVertexBuffer(unsigned int vboId);
+void rlSetVertexAttribute(unsigned int index, int compSize, int type,
+                          bool normalized, int stride, int offset);
+void rlSetVertexAttributeDefault(int locIndex, const void *value,
+                                 int attribType, int count);
+void rlEnableVertexAttribute(unsigned int index);
+bool rlEnableVertexArray(unsigned int vaoId);
+void rlDisableVertexArray(void);
+void rlDrawVertexArray(int offset, int count);
+void rlDrawRenderBatchActive(void);
+unsigned int rlGetShaderIdDefault(void);
+int *rlGetShaderLocsDefault(void);
+void rlEnableShader(unsigned int id);
+void rlDisableShader(void);
+void rlSetUniform(int locIndex, const void *value, int uniformType, int count);
+void rlSetUniformMatrix(int locIndex, Matrix mat);
+void rlActiveTextureSlot(int slot);
+void rlEnableTexture(unsigned int id);
+void rlDisableTexture(void);
+Matrix rlGetMatrixModelview(void);
+Matrix rlGetMatrixProjection(void);
+
+#endif // RLGL_H
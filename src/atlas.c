@@ -0,0 +1,104 @@
+// atlas.c
+#include "atlas.h"
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+Atlas atlas = {0};
+
+// Helper functions
+static int clampIndex(int value, int max) {
+  if (value < 0) {
+    return 0;
+  }
+  return value > max ? max : value;
+}
+
+// Atlas functions
+// Copies a loaded sprite into the next free slot, extruding its border.
+// Sprites that do not fit are counted in atlas.missing.
+void atlasAdd(Texture2D texture, const Color *pixels) {
+  if (texture.id == 0) {
+    return; // not loaded, so no renderer draws it
+  }
+  if (texture.id >= ATLAS_MAX_TEXTURE_ID) {
+    printf("Warning: texture %u not added to atlas\n", texture.id);
+    atlas.missing++;
+    return;
+  }
+  if (atlas.spriteCount >= ATLAS_MAX_SPRITES) {
+    printf("Warning: atlas full, texture %u not added\n", texture.id);
+    atlas.missing++;
+    return;
+  }
+  if (atlas.pixels == NULL) {
+    atlas.pixels = (Color *)calloc(ATLAS_SIZE * ATLAS_SIZE, sizeof(Color));
+    if (atlas.pixels == NULL) {
+      printf("Memory allocation failed\n");
+      atlas.missing++;
+      return;
+    }
+  }
+
+  int slot = atlas.spriteCount;
+  int originX = (slot % ATLAS_COLUMNS) * ATLAS_SLOT;
+  int originY = (slot / ATLAS_COLUMNS) * ATLAS_SLOT;
+  for (int y = 0; y < ATLAS_SLOT; y++) {
+    for (int x = 0; x < ATLAS_SLOT; x++) {
+      int sx = clampIndex(x - ATLAS_PADDING, TILE_SIZE - 1);
+      int sy = clampIndex(y - ATLAS_PADDING, TILE_SIZE - 1);
+      atlas.pixels[(originY + y) * ATLAS_SIZE + originX + x] =
+          pixels[sy * TILE_SIZE + sx];
+    }
+  }
+
+  atlas.slotById[texture.id] = (short)(slot + 1);
+  atlas.spriteCount++;
+}
+
+// Uploads the atlas once every sprite has been added
+bool atlasBuild(void) {
+  if (atlas.pixels == NULL) {
+    return false;
+  }
+
+  Image image = {.data = atlas.pixels,
+                 .width = ATLAS_SIZE,
+                 .height = ATLAS_SIZE,
+                 .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+                 .mipmaps = 1};
+  atlas.texture = LoadTextureFromImage(image);
+  SetTextureFilter(atlas.texture, TEXTURE_FILTER_POINT);
+  free(atlas.pixels);
+  atlas.pixels = NULL;
+
+  atlas.loaded = atlas.texture.id != 0;
+  printf("Atlas built with %d sprites\n", atlas.spriteCount);
+  return atlas.loaded;
+}
+
+bool atlasRegion(Texture2D texture, AtlasRegion *region) {
+  if (texture.id == 0 || texture.id >= ATLAS_MAX_TEXTURE_ID ||
+      atlas.slotById[texture.id] == 0) {
+    return false;
+  }
+
+  int slot = atlas.slotById[texture.id] - 1;
+  float x = (slot % ATLAS_COLUMNS) * ATLAS_SLOT + ATLAS_PADDING;
+  float y = (slot / ATLAS_COLUMNS) * ATLAS_SLOT + ATLAS_PADDING;
+  region->u0 = x / ATLAS_SIZE;
+  region->v0 = y / ATLAS_SIZE;
+  region->u1 = (x + TILE_SIZE) / ATLAS_SIZE;
+  region->v1 = (y + TILE_SIZE) / ATLAS_SIZE;
+  return true;
+}
+
+void atlasUnload(void) {
+  if (atlas.loaded) {
+    UnloadTexture(atlas.texture);
+  }
+  free(atlas.pixels);
+  memset(&atlas, 0, sizeof(Atlas));
+}
@@ -0,0 +1,44 @@
+// atlas.h
+#ifndef ATLAS_H
+#define ATLAS_H
+
+// includes
+#include "database.h"
+#include <raylib.h>
+#include <stdbool.h>
+
+// definitions
+#define ATLAS_SIZE 1024 // atlas texture width and height in pixels
+#define ATLAS_PADDING 1 // extruded border around each sprite
+#define ATLAS_SLOT (TILE_SIZE + 2 * ATLAS_PADDING)
+#define ATLAS_COLUMNS (ATLAS_SIZE / ATLAS_SLOT)
+#define ATLAS_MAX_SPRITES (ATLAS_COLUMNS * ATLAS_COLUMNS)
+#define ATLAS_MAX_TEXTURE_ID 4096 // texture ids looked up directly
+
+// structs
+typedef struct {
+  float u0, v0, u1, v1; // normalized texture coordinates
+} AtlasRegion;
+
+typedef struct {
+  Color *pixels;     // CPU copy, freed once uploaded
+  Texture2D texture; // uploaded atlas
+  int spriteCount;
+  int missing; // loaded sprites left out, so meshes would have holes
+  short slotById[ATLAS_MAX_TEXTURE_ID]; // slot + 1 per texture id, 0 if none
+  bool loaded;
+} Atlas;
+
+// globals
+extern Atlas atlas;
+
+// functions
+void atlasAdd(Texture2D texture, const Color *pixels);
+
+bool atlasBuild(void);
+
+bool atlasRegion(Texture2D texture, AtlasRegion *region);
+
+void atlasUnload(void);
+
+#endif // ATLAS_H
@@ -0,0 +1,319 @@
+// autotile.c
+#include "autotile.h"
+#include "chunk.h"
+#include "keyindex.h"
+#include "trace.h"
+#include "wall.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+WallAutotiler wallAutotiler = {0};
+
+// Cells already resolved during one edit
+static unsigned char markedCells[(GRID_SIZE * GRID_SIZE + 7) / 8];
+
+static const int neighbourOffsets[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+// Helper functions
+static bool isMarked(int x, int y) {
+  int bit = x * GRID_SIZE + y;
+  return markedCells[bit / 8] & (1 << (bit % 8));
+}
+
+static void setMarked(int x, int y, bool marked) {
+  int bit = x * GRID_SIZE + y;
+  if (marked) {
+    markedCells[bit / 8] |= (unsigned char)(1 << (bit % 8));
+  } else {
+    markedCells[bit / 8] &= (unsigned char)~(1 << (bit % 8));
+  }
+}
+
+// A wall's sprites hang from its cell's top-left corner, so its own style
+// shows the links to its west and north neighbours; the links to the east
+// and south are drawn by those neighbours.
+static int maskOrientation(int mask) {
+  bool west = mask & AUTOTILE_WEST;
+  bool north = mask & AUTOTILE_NORTH;
+  if (west && north)
+    return WALL_STYLE_CORNER;
+  if (west)
+    return WALL_STYLE_HORIZONTAL;
+  if (north)
+    return WALL_STYLE_VERTICAL;
+  return WALL_STYLE_POST;
+}
+
+static int neighbourMask(const Map *map, int x, int y) {
+  int mask = 0;
+  if (y > 0 && map->grid[x][y - 1][2] != 0)
+    mask |= AUTOTILE_NORTH;
+  if (x + 1 < GRID_SIZE && map->grid[x + 1][y][2] != 0)
+    mask |= AUTOTILE_EAST;
+  if (y + 1 < GRID_SIZE && map->grid[x][y + 1][2] != 0)
+    mask |= AUTOTILE_SOUTH;
+  if (x > 0 && map->grid[x - 1][y][2] != 0)
+    mask |= AUTOTILE_WEST;
+  return mask;
+}
+
+// Records a resolved cell, extending the last span when the cell continues
+// it. Only counts spans when out is NULL.
+static void emitCell(TileChangeSpan *out, TileChangeSpan *last, int *count,
+                     int x, int y, int oldKey, int newKey) {
+  if (*count > 0 && last->x == x && last->y + last->length == y &&
+      last->oldKey == oldKey && last->newKey == newKey) {
+    last->length++;
+  } else {
+    *last = (TileChangeSpan){x, y, 1, oldKey, newKey};
+    (*count)++;
+  }
+  if (out != NULL) {
+    out[*count - 1] = *last;
+  }
+}
+
+// The spans' cells with their resolved keys, then each neighbour whose key
+// changes. Counts the spans when out is NULL, otherwise writes them and the
+// changed cells. The map must already hold the spans' new keys.
+static int resolveSpans(Map *map, const TileChangeSpan *spans, int spanCount,
+                        TileChangeSpan *out, int *neighbourCount) {
+  for (int i = 0; i < spanCount; i++) {
+    for (int y = spans[i].y; y < spans[i].y + spans[i].length; y++) {
+      setMarked(spans[i].x, y, true);
+    }
+  }
+
+  TileChangeSpan last = {0};
+  int count = 0;
+  *neighbourCount = 0;
+  for (int i = 0; i < spanCount; i++) {
+    int x = spans[i].x;
+    for (int y = spans[i].y; y < spans[i].y + spans[i].length; y++) {
+      int wallKey = autotileResolve(map, spans[i].newKey, x, y);
+      emitCell(out, &last, &count, x, y, spans[i].oldKey, wallKey);
+      if (out != NULL && wallKey != map->grid[x][y][2]) {
+        keyIndexUpdate(map, DRAW_WALL, x, y, map->grid[x][y][2], wallKey);
+        map->grid[x][y][2] = wallKey;
+      }
+    }
+  }
+
+  // Neighbours keep their group but may gain or lose a link
+  for (int i = 0; i < spanCount; i++) {
+    for (int y = spans[i].y; y < spans[i].y + spans[i].length; y++) {
+      for (int j = 0; j < 4; j++) {
+        int nx = spans[i].x + neighbourOffsets[j][0];
+        int ny = y + neighbourOffsets[j][1];
+        if (nx < 0 || nx >= GRID_SIZE || ny < 0 || ny >= GRID_SIZE ||
+            isMarked(nx, ny) || map->grid[nx][ny][2] == 0) {
+          continue;
+        }
+        setMarked(nx, ny, true);
+
+        int oldKey = map->grid[nx][ny][2];
+        int wallKey = autotileResolve(map, oldKey, nx, ny);
+        if (wallKey == oldKey) {
+          continue;
+        }
+        emitCell(out, &last, &count, nx, ny, oldKey, wallKey);
+        (*neighbourCount)++;
+        if (out != NULL) {
+          markCellDirty(map, nx, ny);
+          keyIndexUpdate(map, DRAW_WALL, nx, ny, oldKey, wallKey);
+          map->grid[nx][ny][2] = wallKey;
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < spanCount; i++) {
+    for (int y = spans[i].y; y < spans[i].y + spans[i].length; y++) {
+      setMarked(spans[i].x, y, false);
+      for (int j = 0; j < 4; j++) {
+        int nx = spans[i].x + neighbourOffsets[j][0];
+        int ny = y + neighbourOffsets[j][1];
+        if (nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE) {
+          setMarked(nx, ny, false);
+        }
+      }
+    }
+  }
+  return count;
+}
+
+// Autotile functions
+// Builds a mask table per wall group from the orientation map. Autotiling
+// stays off when there is no orientation map.
+bool autotileInit(Wall wallTypes[], int maxWallKey,
+                  WallOrientMap *wallOrientationMap) {
+  autotileUnload();
+  if (wallOrientationMap == NULL || maxWallKey < 1) {
+    return false;
+  }
+
+  int keyCount = maxWallKey + 1;
+  wallAutotiler.keyGroups = (int *)malloc(keyCount * sizeof(int));
+  wallAutotiler.groupKeys =
+      (int (*)[AUTOTILE_MASK_COUNT])malloc(keyCount *
+                                            sizeof(int[AUTOTILE_MASK_COUNT]));
+  if (wallAutotiler.keyGroups == NULL || wallAutotiler.groupKeys == NULL) {
+    printf("Memory allocation failed\n");
+    autotileUnload();
+    return false;
+  }
+  wallAutotiler.keyCount = keyCount;
+
+  // One row per distinct group; every member resolves through it
+  wallAutotiler.keyGroups[0] = -1;
+  for (int key = 1; key < keyCount; key++) {
+    wallAutotiler.keyGroups[key] = -1;
+    if (wallTypes[key].wallKey != key) {
+      continue;
+    }
+    for (int other = 1; other < key; other++) {
+      if (wallAutotiler.keyGroups[other] >= 0 &&
+          wallTypes[other].wallGroupKey == wallTypes[key].wallGroupKey) {
+        wallAutotiler.keyGroups[key] = wallAutotiler.keyGroups[other];
+        break;
+      }
+    }
+    if (wallAutotiler.keyGroups[key] >= 0) {
+      continue;
+    }
+
+    int group = wallAutotiler.groupCount++;
+    wallAutotiler.keyGroups[key] = group;
+    for (int mask = 0; mask < AUTOTILE_MASK_COUNT; mask++) {
+      wallAutotiler.groupKeys[group][mask] = lookupWallOrientation(
+          wallOrientationMap, key, maskOrientation(mask));
+    }
+  }
+
+  wallAutotiler.enabled = true;
+  printf("Autotiling %d wall groups\n", wallAutotiler.groupCount);
+  return true;
+}
+
+// Member of wallKey's group matching the occupied neighbours of (x, y)
+int autotileResolve(const Map *map, int wallKey, int x, int y) {
+  if (!wallAutotiler.enabled || wallKey <= 0 ||
+      wallKey >= wallAutotiler.keyCount ||
+      wallAutotiler.keyGroups[wallKey] < 0) {
+    return wallKey;
+  }
+  int group = wallAutotiler.keyGroups[wallKey];
+  return wallAutotiler.groupKeys[group][neighbourMask(map, x, y)];
+}
+
+// Resolves the drawn walls against their neighbours as if they were
+// placed, and appends every existing neighbour whose key changes to the
+// drawn cells. Only the drawn cells and their neighbours are visited.
+// Returns the number of cells appended.
+int autotileDrawnWalls(Map *map, DrawingState *drawState) {
+  if (!wallAutotiler.enabled || drawState->drawType != DRAW_WALL ||
+      drawState->drawnTilesCount == 0) {
+    return 0;
+  }
+  traceBegin("autotileDrawnWalls");
+
+  int count = drawState->drawnTilesCount;
+  int *savedKeys = (int *)malloc(count * sizeof(int));
+  if (savedKeys == NULL) {
+    printf("Memory allocation failed\n");
+    traceEnd("autotileDrawnWalls");
+    return 0;
+  }
+
+  // Place the drawn walls so every mask sees the edit
+  for (int i = 0; i < count; i++) {
+    int x = drawState->drawnTiles[i][0];
+    int y = drawState->drawnTiles[i][1];
+    savedKeys[i] = map->grid[x][y][2];
+    map->grid[x][y][2] = drawState->drawnTiles[i][2];
+    setMarked(x, y, true);
+  }
+
+  for (int i = 0; i < count; i++) {
+    drawState->drawnTiles[i][2] =
+        autotileResolve(map, drawState->drawnTiles[i][2],
+                        drawState->drawnTiles[i][0],
+                        drawState->drawnTiles[i][1]);
+  }
+
+  // Neighbours keep their group but may gain or lose a link
+  for (int i = 0; i < count; i++) {
+    for (int j = 0; j < 4; j++) {
+      int x = drawState->drawnTiles[i][0] + neighbourOffsets[j][0];
+      int y = drawState->drawnTiles[i][1] + neighbourOffsets[j][1];
+      if (x < 0 || x >= GRID_SIZE || y < 0 || y >= GRID_SIZE ||
+          isMarked(x, y) || map->grid[x][y][2] == 0) {
+        continue;
+      }
+      setMarked(x, y, true);
+
+      int wallKey = autotileResolve(map, map->grid[x][y][2], x, y);
+      if (wallKey != map->grid[x][y][2]) {
+        int index = drawState->drawnTilesCount++;
+        drawState->drawnTiles[index][0] = x;
+        drawState->drawnTiles[index][1] = y;
+        drawState->drawnTiles[index][2] = wallKey;
+      }
+    }
+  }
+
+  // Restore the map and clear the marks
+  for (int i = 0; i < count; i++) {
+    int x = drawState->drawnTiles[i][0];
+    int y = drawState->drawnTiles[i][1];
+    map->grid[x][y][2] = savedKeys[i];
+    setMarked(x, y, false);
+    for (int j = 0; j < 4; j++) {
+      int nx = x + neighbourOffsets[j][0];
+      int ny = y + neighbourOffsets[j][1];
+      if (nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE) {
+        setMarked(nx, ny, false);
+      }
+    }
+  }
+
+  free(savedKeys);
+  traceEnd("autotileDrawnWalls");
+  return drawState->drawnTilesCount - count;
+}
+
+// Resolves walls already written over spans, and their four neighbours.
+// Spans are split where the resolved keys differ, and each neighbour whose
+// key changes is written and added, so the spans stay one undo step.
+// Returns the number of neighbours changed.
+int autotileSpans(Map *map, TileChangeSpan **spans, int *spanCount) {
+  if (!wallAutotiler.enabled || *spanCount == 0) {
+    return 0;
+  }
+  traceBegin("autotileSpans");
+
+  int neighbourCount = 0;
+  int count = resolveSpans(map, *spans, *spanCount, NULL, &neighbourCount);
+  TileChangeSpan *resolved =
+      (TileChangeSpan *)malloc(count * sizeof(TileChangeSpan));
+  if (resolved == NULL) {
+    printf("Memory allocation failed\n");
+    traceEnd("autotileSpans");
+    return 0;
+  }
+  resolveSpans(map, *spans, *spanCount, resolved, &neighbourCount);
+
+  free(*spans);
+  *spans = resolved;
+  *spanCount = count;
+  traceEnd("autotileSpans");
+  return neighbourCount;
+}
+
+void autotileUnload(void) {
+  free(wallAutotiler.keyGroups);
+  free(wallAutotiler.groupKeys);
+  memset(&wallAutotiler, 0, sizeof(WallAutotiler));
+}
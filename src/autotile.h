@@ -0,0 +1,44 @@
+// autotile.h
+#ifndef AUTOTILE_H
+#define AUTOTILE_H
+
+// includes
+#include "database.h"
+#include "draw.h"
+#include "undo.h"
+#include <stdbool.h>
+
+// definitions
+// Occupied neighbours of a wall cell
+#define AUTOTILE_NORTH 1
+#define AUTOTILE_EAST 2
+#define AUTOTILE_SOUTH 4
+#define AUTOTILE_WEST 8
+#define AUTOTILE_MASK_COUNT 16
+
+// structs
+// Wall key for every neighbour mask, one table per wall group
+typedef struct {
+  bool enabled;
+  int keyCount;                          // maxWallKey + 1
+  int *keyGroups;                        // group row of each wall key, or -1
+  int groupCount;
+  int (*groupKeys)[AUTOTILE_MASK_COUNT]; // [group][mask]
+} WallAutotiler;
+
+// globals
+extern WallAutotiler wallAutotiler;
+
+// functions
+bool autotileInit(Wall wallTypes[], int maxWallKey,
+                  WallOrientMap *wallOrientationMap);
+
+int autotileResolve(const Map *map, int wallKey, int x, int y);
+
+int autotileDrawnWalls(Map *map, DrawingState *drawState);
+
+int autotileSpans(Map *map, TileChangeSpan **spans, int *spanCount);
+
+void autotileUnload(void);
+
+#endif // AUTOTILE_H
@@ -0,0 +1,32 @@
+// chunk.c
+#include "chunk.h"
+
+// Chunk functions
+// Every change to a cell's tile, style, wall, edges or wall quadrants goes
+// through here so cached per-chunk data can be rebuilt incrementally.
+void markCellDirty(Map *map, int x, int y) {
+  if (x < 0 || x >= GRID_SIZE || y < 0 || y >= GRID_SIZE) {
+    return;
+  }
+  map->chunkDirty[x / CHUNK_SIZE][y / CHUNK_SIZE] = CHUNK_DIRTY_ALL;
+}
+
+void markMapDirty(Map *map) {
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      map->chunkDirty[cx][cy] = CHUNK_DIRTY_ALL;
+    }
+  }
+}
+
+bool chunkIsDirty(const Map *map, int cx, int cy, ChunkDirtyFlag flag) {
+  return (map->chunkDirty[cx][cy] & flag) != 0;
+}
+
+void setChunkDirty(Map *map, int cx, int cy, ChunkDirtyFlag flag) {
+  map->chunkDirty[cx][cy] |= (unsigned short)flag;
+}
+
+void clearChunkDirty(Map *map, int cx, int cy, ChunkDirtyFlag flag) {
+  map->chunkDirty[cx][cy] &= (unsigned short)~flag;
+}
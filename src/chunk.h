@@ -0,0 +1,34 @@
+// chunk.h
+#ifndef CHUNK_H
+#define CHUNK_H
+
+// includes
+#include "database.h"
+#include <stdbool.h>
+
+// enums
+typedef enum {
+  CHUNK_DIRTY_LOD = 1 << 0,     // lod.c colour texture
+  CHUNK_DIRTY_MESH = 1 << 1,    // mesh.c vertex buffers
+  CHUNK_DIRTY_MINIMAP = 1 << 2, // minimap.c chunk summaries
+  CHUNK_DIRTY_RUNS = 1 << 3,    // runindex.c cell runs
+  CHUNK_DIRTY_REGION = 1 << 4,  // regiontree.c uniform chunk keys
+  CHUNK_DIRTY_STATS = 1 << 5,   // stats.c summed-area tables
+  CHUNK_DIRTY_WALK = 1 << 6,    // walkmap.c walkability bits
+  CHUNK_DIRTY_PATH = 1 << 7,    // hpa.c chunk entrances
+  CHUNK_DIRTY_CONNECT = 1 << 8, // connectivity.c local components
+  CHUNK_DIRTY_ALL = 0xffff
+} ChunkDirtyFlag;
+
+// functions
+void markCellDirty(Map *map, int x, int y);
+
+void markMapDirty(Map *map);
+
+bool chunkIsDirty(const Map *map, int cx, int cy, ChunkDirtyFlag flag);
+
+void setChunkDirty(Map *map, int cx, int cy, ChunkDirtyFlag flag);
+
+void clearChunkDirty(Map *map, int cx, int cy, ChunkDirtyFlag flag);
+
+#endif // CHUNK_H
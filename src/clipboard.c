@@ -0,0 +1,402 @@
+// clipboard.c
+#include "clipboard.h"
+#include "autotile.h"
+#include "chunk.h"
+#include "edge.h"
+#include "keyindex.h"
+#include "lod.h"
+#include "profile.h"
+#include "tilestyle.h"
+#include "trace.h"
+#include "wall.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Definitions
+// Neighbours a wall joins. An orientation records the west and north joins
+// (box drawing puts a post at the top left and a corner at the bottom
+// right); a wall's east and south joins are recorded by those neighbours.
+#define JOIN_NORTH 1
+#define JOIN_EAST 2
+#define JOIN_SOUTH 4
+#define JOIN_WEST 8
+
+// Helper functions
+static int wallOrientation(Wall wallTypes[], int maxWallKey, int wallKey) {
+  if (wallKey <= 0 || wallKey > maxWallKey ||
+      wallTypes[wallKey].wallKey != wallKey) {
+    return WALL_STYLE_NONE;
+  }
+  return wallTypes[wallKey].orientationKey;
+}
+
+static int orientationJoins(int orient) {
+  switch (orient) {
+  case WALL_STYLE_HORIZONTAL:
+    return JOIN_WEST;
+  case WALL_STYLE_VERTICAL:
+    return JOIN_NORTH;
+  case WALL_STYLE_CORNER:
+    return JOIN_WEST | JOIN_NORTH;
+  default:
+    return 0;
+  }
+}
+
+static int joinsOrientation(int joins) {
+  bool west = joins & JOIN_WEST;
+  bool north = joins & JOIN_NORTH;
+  if (west && north) {
+    return WALL_STYLE_CORNER;
+  } else if (west) {
+    return WALL_STYLE_HORIZONTAL;
+  } else if (north) {
+    return WALL_STYLE_VERTICAL;
+  }
+  return WALL_STYLE_POST;
+}
+
+static int transformJoins(int joins, ClipboardTransform transform) {
+  int east = joins & JOIN_EAST;
+  int west = joins & JOIN_WEST;
+  int north = joins & JOIN_NORTH;
+  int south = joins & JOIN_SOUTH;
+  switch (transform) {
+  case CLIPBOARD_ROTATE: // north -> east -> south -> west -> north
+    return ((joins << 1) | (joins >> 3)) & 0xf;
+  case CLIPBOARD_FLIP_X:
+    return north | south | (east ? JOIN_WEST : 0) | (west ? JOIN_EAST : 0);
+  case CLIPBOARD_FLIP_Y:
+    return east | west | (north ? JOIN_SOUTH : 0) | (south ? JOIN_NORTH : 0);
+  }
+  return joins;
+}
+
+// The walls written over rect link to the walls around it, so with
+// autotiling on the edit grows by a ring of one cell and every wall in it
+// is resolved as if cells were written. Takes ownership of cells and
+// returns the grown cells, or NULL when memory runs out.
+static int (*autotileRect(Map *map, WorldCoords *rect, int (*cells)[3]))[3] {
+  int height = rect->endY - rect->startY + 1;
+  WorldCoords ring = {rect->startX - 1, rect->startY - 1, rect->endX + 1,
+                      rect->endY + 1};
+  clampCoordinate(&ring.startX, 0, GRID_SIZE - 1);
+  clampCoordinate(&ring.startY, 0, GRID_SIZE - 1);
+  clampCoordinate(&ring.endX, 0, GRID_SIZE - 1);
+  clampCoordinate(&ring.endY, 0, GRID_SIZE - 1);
+  int ringWidth = ring.endX - ring.startX + 1;
+  int ringHeight = ring.endY - ring.startY + 1;
+
+  int (*grown)[3] =
+      (int (*)[3])malloc(ringWidth * ringHeight * sizeof(int[3]));
+  int *savedWalls =
+      (int *)malloc((rect->endX - rect->startX + 1) * height * sizeof(int));
+  if (grown == NULL || savedWalls == NULL) {
+    printf("Memory allocation failed\n");
+    free(grown);
+    free(savedWalls);
+    free(cells);
+    return NULL;
+  }
+
+  // The ring as it is with the rect's cells inside, whose walls are placed
+  // in the map for the masks to see
+  for (int x = ring.startX; x <= ring.endX; x++) {
+    int column = (x - ring.startX) * ringHeight;
+    memcpy(grown[column], map->grid[x][ring.startY],
+           ringHeight * sizeof(int[3]));
+    if (x < rect->startX || x > rect->endX) {
+      continue;
+    }
+    int source = (x - rect->startX) * height;
+    memcpy(grown[column + rect->startY - ring.startY], cells[source],
+           height * sizeof(int[3]));
+    for (int i = 0; i < height; i++) {
+      savedWalls[source + i] = map->grid[x][rect->startY + i][2];
+      map->grid[x][rect->startY + i][2] = cells[source + i][2];
+    }
+  }
+
+  for (int x = ring.startX; x <= ring.endX; x++) {
+    for (int y = ring.startY; y <= ring.endY; y++) {
+      int *cell = grown[(x - ring.startX) * ringHeight + y - ring.startY];
+      cell[2] = autotileResolve(map, cell[2], x, y);
+    }
+  }
+
+  for (int x = rect->startX; x <= rect->endX; x++) {
+    int source = (x - rect->startX) * height;
+    for (int i = 0; i < height; i++) {
+      map->grid[x][rect->startY + i][2] = savedWalls[source + i];
+    }
+  }
+
+  free(savedWalls);
+  free(cells);
+  *rect = ring;
+  return grown;
+}
+
+// Writes whole cells over rect and records them as one undo batch. Takes
+// ownership of newCells, laid out column by column at the rect's size.
+static void replaceRect(Map *map, WorldCoords rect, int (*newCells)[3],
+                        UndoRedoManager *manager, Tile tileTypes[],
+                        Edge edgeTypes[], Wall wallTypes[]) {
+  if (wallAutotiler.enabled) {
+    newCells = autotileRect(map, &rect, newCells);
+    if (newCells == NULL) {
+      return;
+    }
+  }
+
+  int width = rect.endX - rect.startX + 1;
+  int height = rect.endY - rect.startY + 1;
+
+  // The rectangle and a ring of one cell around it
+  WorldCoords ring = {rect.startX - 1, rect.startY - 1, rect.endX + 1,
+                      rect.endY + 1};
+  clampCoordinate(&ring.startX, 0, GRID_SIZE - 1);
+  clampCoordinate(&ring.startY, 0, GRID_SIZE - 1);
+  clampCoordinate(&ring.endX, 0, GRID_SIZE - 1);
+  clampCoordinate(&ring.endY, 0, GRID_SIZE - 1);
+  int ringCount =
+      (ring.endX - ring.startX + 1) * (ring.endY - ring.startY + 1);
+
+  int (*oldCells)[3] = (int (*)[3])malloc(width * height * sizeof(int[3]));
+  int (*visitedTiles)[2] = (int (*)[2])malloc(ringCount * sizeof(int[2]));
+  if (oldCells == NULL || visitedTiles == NULL) {
+    printf("Memory allocation failed\n");
+    free(oldCells);
+    free(visitedTiles);
+    free(newCells);
+    return;
+  }
+
+  // Bulk column copies
+  for (int x = rect.startX; x <= rect.endX; x++) {
+    int column = (x - rect.startX) * height;
+    memcpy(oldCells[column], map->grid[x][rect.startY],
+           height * sizeof(int[3]));
+    for (int i = 0; i < height; i++) {
+      int y = rect.startY + i;
+      markCellDirty(map, x, y);
+      keyIndexUpdate(map, DRAW_TILE, x, y, oldCells[column + i][0],
+                     newCells[column + i][0]);
+      keyIndexUpdate(map, DRAW_WALL, x, y, oldCells[column + i][2],
+                     newCells[column + i][2]);
+    }
+    memcpy(map->grid[x][rect.startY], newCells[column],
+           height * sizeof(int[3]));
+  }
+
+  // One edge and wall recompute over the rectangle and its border
+  int visitedCount = 0;
+  for (int x = ring.startX; x <= ring.endX; x++) {
+    for (int y = ring.startY; y <= ring.endY; y++) {
+      visitedTiles[visitedCount][0] = x;
+      visitedTiles[visitedCount][1] = y;
+      visitedCount++;
+    }
+  }
+  computeEdges(visitedTiles, visitedCount, map, tileTypes, edgeTypes);
+  computeWalls(visitedTiles, visitedCount, map, wallTypes);
+
+  createRectChangeBatch(manager, rect, oldCells, newCells, visitedTiles,
+                        visitedCount);
+  free(visitedTiles);
+}
+
+// Clipboard functions
+bool clipboardCopy(Clipboard *clipboard, Map *map, WorldCoords rect) {
+  int width = rect.endX - rect.startX + 1;
+  int height = rect.endY - rect.startY + 1;
+  int (*cells)[3] = (int (*)[3])malloc(width * height * sizeof(int[3]));
+  if (cells == NULL) {
+    printf("Memory allocation failed\n");
+    return false;
+  }
+
+  for (int x = rect.startX; x <= rect.endX; x++) {
+    memcpy(cells[(x - rect.startX) * height], map->grid[x][rect.startY],
+           height * sizeof(int[3]));
+  }
+
+  clipboardFree(clipboard);
+  clipboard->width = width;
+  clipboard->height = height;
+  clipboard->cells = cells;
+  printf("Copied %dx%d cells\n", width, height);
+  return true;
+}
+
+// Copies rect, then clears it to tile 0 with no walls
+void clipboardCut(Clipboard *clipboard, Map *map, WorldCoords rect,
+                  UndoRedoManager *manager, Tile tileTypes[],
+                  Edge edgeTypes[], Wall wallTypes[]) {
+  if (!clipboardCopy(clipboard, map, rect)) {
+    return;
+  }
+  int (*cleared)[3] = (int (*)[3])calloc(
+      clipboard->width * clipboard->height, sizeof(int[3]));
+  if (cleared == NULL) {
+    printf("Memory allocation failed\n");
+    return;
+  }
+  traceBegin("clipboardCut");
+  replaceRect(map, rect, cleared, manager, tileTypes, edgeTypes, wallTypes);
+  traceEnd("clipboardCut");
+}
+
+// Pastes with the top left cell at (x, y), clipped to the grid
+void clipboardPaste(const Clipboard *clipboard, Map *map, int x, int y,
+                    UndoRedoManager *manager, Tile tileTypes[],
+                    Edge edgeTypes[], Wall wallTypes[]) {
+  if (clipboard->cells == NULL) {
+    return;
+  }
+
+  WorldCoords rect = {x, y, x + clipboard->width - 1,
+                      y + clipboard->height - 1};
+  clampCoordinate(&rect.endX, 0, GRID_SIZE - 1);
+  clampCoordinate(&rect.endY, 0, GRID_SIZE - 1);
+  int width = rect.endX - rect.startX + 1;
+  int height = rect.endY - rect.startY + 1;
+
+  int (*cells)[3] = (int (*)[3])malloc(width * height * sizeof(int[3]));
+  if (cells == NULL) {
+    printf("Memory allocation failed\n");
+    return;
+  }
+  for (int column = 0; column < width; column++) {
+    memcpy(cells[column * height], clipboard->cells[column * clipboard->height],
+           height * sizeof(int[3]));
+  }
+
+  traceBegin("clipboardPaste");
+  replaceRect(map, rect, cells, manager, tileTypes, edgeTypes, wallTypes);
+  traceEnd("clipboardPaste");
+}
+
+// Rotates or flips the clipboard. Oriented walls are re-keyed through the
+// wall orientation map so posts, corners and straight runs still join up.
+void clipboardTransform(Clipboard *clipboard, ClipboardTransform transform,
+                        Wall wallTypes[], int maxWallKey,
+                        WallOrientMap *wallOrientationMap) {
+  if (clipboard->cells == NULL) {
+    return;
+  }
+
+  int width = clipboard->width;
+  int height = clipboard->height;
+  int newWidth = transform == CLIPBOARD_ROTATE ? height : width;
+  int newHeight = transform == CLIPBOARD_ROTATE ? width : height;
+  int (*cells)[3] = (int (*)[3])malloc(width * height * sizeof(int[3]));
+  if (cells == NULL) {
+    printf("Memory allocation failed\n");
+    return;
+  }
+
+  for (int x = 0; x < width; x++) {
+    for (int y = 0; y < height; y++) {
+      int newX = x;
+      int newY = y;
+      switch (transform) {
+      case CLIPBOARD_ROTATE:
+        newX = height - 1 - y;
+        newY = x;
+        break;
+      case CLIPBOARD_FLIP_X:
+        newX = width - 1 - x;
+        break;
+      case CLIPBOARD_FLIP_Y:
+        newY = height - 1 - y;
+        break;
+      }
+
+      int *from = clipboard->cells[x * height + y];
+      int *to = cells[newX * newHeight + newY];
+      memcpy(to, from, sizeof(int[3]));
+
+      // Re-key oriented walls from their joins after the transform
+      int orient = wallOrientation(wallTypes, maxWallKey, from[2]);
+      if (orient == WALL_STYLE_NONE) {
+        continue;
+      }
+      int joins = orientationJoins(orient);
+      if (x + 1 < width &&
+          orientationJoins(wallOrientation(
+              wallTypes, maxWallKey, clipboard->cells[(x + 1) * height + y][2])) &
+              JOIN_WEST) {
+        joins |= JOIN_EAST;
+      }
+      if (y + 1 < height &&
+          orientationJoins(wallOrientation(
+              wallTypes, maxWallKey, clipboard->cells[x * height + y + 1][2])) &
+              JOIN_NORTH) {
+        joins |= JOIN_SOUTH;
+      }
+      to[2] = lookupWallOrientation(
+          wallOrientationMap, from[2],
+          joinsOrientation(transformJoins(joins, transform)));
+    }
+  }
+
+  free(clipboard->cells);
+  clipboard->cells = cells;
+  clipboard->width = newWidth;
+  clipboard->height = newHeight;
+}
+
+// Draws the clipboard translucently over the map with its top left cell at
+// (x, y)
+void clipboardDrawPreview(const Clipboard *clipboard, int x, int y,
+                          Tile tileTypes[], Wall wallTypes[], Camera2D camera,
+                          int screenWidth, int screenHeight) {
+  if (clipboard->cells == NULL) {
+    return;
+  }
+
+  WorldCoords bounds = GetVisibleGridBounds(camera, screenWidth, screenHeight);
+  int startX = x > bounds.startX ? x : bounds.startX;
+  int startY = y > bounds.startY ? y : bounds.startY;
+  int endX = x + clipboard->width - 1;
+  int endY = y + clipboard->height - 1;
+  endX = endX < bounds.endX ? endX : bounds.endX;
+  endY = endY < bounds.endY ? endY : bounds.endY;
+  bool colorOnly = lodLevel(camera.zoom) == LOD_COLOR;
+  Color tint = Fade(WHITE, 0.7f);
+
+  for (int cellX = startX; cellX <= endX; cellX++) {
+    for (int cellY = startY; cellY <= endY; cellY++) {
+      int *cell = clipboard->cells[(cellX - x) * clipboard->height +
+                                   (cellY - y)];
+      Vector2 pos = {cellX * TILE_SIZE, cellY * TILE_SIZE};
+      int style = resolveTileStyle(tileTypes, cell[0], cell[1], cellX, cellY);
+      if (colorOnly) {
+        Color color = cell[2] != 0 ? wallTypes[cell[2]].color
+                                   : tileTypes[cell[0]].color[style];
+        DrawRectangle(pos.x, pos.y, TILE_SIZE, TILE_SIZE, Fade(color, 0.7f));
+        continue;
+      }
+      Texture2D tileTexture = tileTypes[cell[0]].tex[style];
+      DrawTexture(tileTexture, pos.x, pos.y, tint);
+      profileCountDraw(tileTexture);
+      if (cell[2] != 0) {
+        Texture2D wallTexture = wallTypes[cell[2]].wallTex[3].tex;
+        DrawTexture(wallTexture, pos.x, pos.y, tint);
+        profileCountDraw(wallTexture);
+      }
+    }
+  }
+
+  DrawRectangleLines(x * TILE_SIZE, y * TILE_SIZE, clipboard->width * TILE_SIZE,
+                     clipboard->height * TILE_SIZE, SKYBLUE);
+}
+
+void clipboardFree(Clipboard *clipboard) {
+  free(clipboard->cells);
+  clipboard->cells = NULL;
+  clipboard->width = 0;
+  clipboard->height = 0;
+}
@@ -0,0 +1,58 @@
+// clipboard.h
+#ifndef CLIPBOARD_H
+#define CLIPBOARD_H
+
+// includes
+#include "database.h"
+#include "grid.h"
+#include "undo.h"
+#include <raylib.h>
+#include <stdbool.h>
+
+// enums
+typedef enum {
+  CLIPBOARD_ROTATE, // 90 degrees clockwise
+  CLIPBOARD_FLIP_X, // mirror left to right
+  CLIPBOARD_FLIP_Y  // mirror top to bottom
+} ClipboardTransform;
+
+// structs
+// Copied cells in Map.grid's layout (tile key, style, wall key), column by
+// column, so a paste is one memcpy per column
+typedef struct {
+  int width;
+  int height;
+  int (*cells)[3];
+} Clipboard;
+
+typedef struct {
+  bool selecting;        // middle button held
+  bool hasSelection;
+  Vector2 anchor;        // screen position the selection started at
+  WorldCoords selection; // start <= end
+  bool pasting;          // clipboard follows the cursor until placed
+  Clipboard clipboard;
+} ClipboardState;
+
+// functions
+bool clipboardCopy(Clipboard *clipboard, Map *map, WorldCoords rect);
+
+void clipboardCut(Clipboard *clipboard, Map *map, WorldCoords rect,
+                  UndoRedoManager *manager, Tile tileTypes[],
+                  Edge edgeTypes[], Wall wallTypes[]);
+
+void clipboardPaste(const Clipboard *clipboard, Map *map, int x, int y,
+                    UndoRedoManager *manager, Tile tileTypes[],
+                    Edge edgeTypes[], Wall wallTypes[]);
+
+void clipboardTransform(Clipboard *clipboard, ClipboardTransform transform,
+                        Wall wallTypes[], int maxWallKey,
+                        WallOrientMap *wallOrientationMap);
+
+void clipboardDrawPreview(const Clipboard *clipboard, int x, int y,
+                          Tile tileTypes[], Wall wallTypes[], Camera2D camera,
+                          int screenWidth, int screenHeight);
+
+void clipboardFree(Clipboard *clipboard);
+
+#endif // CLIPBOARD_H
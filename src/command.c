@@ -1,7 +1,22 @@
 // command.c
 #include "command.h"
+#include "autotile.h"
+#include "chunk.h"
+#include "connectivity.h"
 #include "draw.h"
 #include "edge.h"
+#include "fill.h"
+#include "hpa.h"
+#include "keyindex.h"
+#include "layer.h"
+#include "level.h"
+#include "lod.h"
+#include "mesh.h"
+#include "pathfind.h"
+#include "profile.h"
+#include "stats.h"
+#include "tilestyle.h"
+#include "trace.h"
 #include "wall.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,7 +24,8 @@
 
 void parseCommand(Tile tileTypes[], Edge edgeTypes[], Wall wallTypes[],
                   sqlite3 *db, DrawingState *drawState,
-                  CommandState *commandState, Map *map) {
+                  CommandState *commandState, Map *map,
+                  UndoRedoManager *manager) {
 
   if (strncmp(commandState->commandBuffer, ":tile ", 6) == 0) {
     if (drawState->drawType != DRAW_TILE) {
@@ -51,27 +67,283 @@ void parseCommand(Tile tileTypes[], Edge edgeTypes[], Wall wallTypes[],
     }
   } else if (strncmp(commandState->commandBuffer, ":load ", 6) == 0) {
     char *table = &commandState->commandBuffer[6];
-    loadMap(db, table, map);
+    traceBegin("cmd_load");
+    tileStyleLoad(db, table);
+    levelLoad(db, table, map);
+    layerLoad(db, table, map);
+    // The history belongs to the map that was open
+    freeUndoHistory(manager);
+    drawState->activeLayer = 0;
     computeMapEdges(tileTypes, edgeTypes, map);
     computeMapWalls(wallTypes, map);
+    keyIndexBuild(map);
+    traceEnd("cmd_load");
     printf("Map loaded: %s\n", table);
   } else if (strncmp(commandState->commandBuffer, ":save ", 6) == 0) {
     char *table = &commandState->commandBuffer[6];
-    saveMap(db, table, map);
+    traceBegin("cmd_save");
+    levelSave(db, table, map);
+    layerSave(db, table);
+    tileStyleSave(db, table);
+    traceEnd("cmd_save");
     printf("Map saved: %s\n", table);
+  } else if (strncmp(commandState->commandBuffer, ":profile ", 9) == 0) {
+    char path[200] = "profile.csv";
+    int frames = 0;
+    int matched =
+        sscanf(&commandState->commandBuffer[9], "%d %199s", &frames, path);
+    if (matched >= 1 && frames > 0) {
+      int written = profileDumpCsv(path, frames);
+      if (written >= 0) {
+        printf("Profile of %d frames written to %s\n", written, path);
+      }
+    } else {
+      printf("Invalid frame count\n");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":trace", 6) == 0 &&
+             (commandState->commandBuffer[6] == '\0' ||
+              commandState->commandBuffer[6] == ' ')) {
+    char *path = commandState->commandBuffer[6] == ' '
+                     ? &commandState->commandBuffer[7]
+                     : tracer.path;
+    traceWriteJson(path);
+  } else if (strncmp(commandState->commandBuffer, ":fps ", 5) == 0) {
+    char *endptr;
+    long fps = strtol(&commandState->commandBuffer[5], &endptr, 10);
+    if (*endptr == '\0' && fps >= 0) {
+      SetTargetFPS((int)fps);
+      printf("Frame cap set to %ld\n", fps);
+    } else {
+      printf("Invalid frame cap\n");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":renderer ", 10) == 0) {
+    char *renderer = &commandState->commandBuffer[10];
+    if (strcmp(renderer, "mesh") == 0 && meshRenderer.owner != NULL) {
+      meshRenderer.enabled = true;
+      printf("Using vertex buffer renderer\n");
+    } else if (strcmp(renderer, "sprite") == 0) {
+      meshRenderer.enabled = false;
+      printf("Using sprite renderer\n");
+    } else {
+      printf("Renderer unavailable: %s\n", renderer);
+    }
+  } else if (strncmp(commandState->commandBuffer, ":brush ", 7) == 0) {
+    int size = 0;
+    char shape[16] = "square";
+    int matched =
+        sscanf(&commandState->commandBuffer[7], "%d %15s", &size, shape);
+    bool circle = strcmp(shape, "circle") == 0;
+    if (matched >= 1 && size >= 1 && size <= BRUSH_MAX_SIZE &&
+        (circle || strcmp(shape, "square") == 0)) {
+      setBrush(drawState, size, circle ? BRUSH_CIRCLE : BRUSH_SQUARE);
+      printf("Brush set to %d (%s)\n", size, shape);
+    } else {
+      printf("Invalid brush\n");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":fill ", 6) == 0) {
+    char *endptr;
+    long connectivity = strtol(&commandState->commandBuffer[6], &endptr, 10);
+    if (*endptr == '\0' && (connectivity == 4 || connectivity == 8)) {
+      drawState->fillConnectivity = (int)connectivity;
+      printf("Fill connectivity set to %ld\n", connectivity);
+    } else {
+      printf("Invalid fill connectivity\n");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":replace ", 9) == 0) {
+    char type[8] = "";
+    int oldKey = 0;
+    int newKey = 0;
+    int matched = sscanf(&commandState->commandBuffer[9], "%7s %d %d", type,
+                         &oldKey, &newKey);
+    bool tile = strcmp(type, "tile") == 0;
+    bool wall = strcmp(type, "wall") == 0;
+    if (matched != 3 || (!tile && !wall)) {
+      printf("Usage: :replace tile|wall <old> <new>\n");
+    } else if (tile && (oldKey < 0 || oldKey > map->maxTileKey ||
+                        newKey < 0 || newKey > map->maxTileKey ||
+                        tileTypes[newKey].tileKey != newKey)) {
+      printf("Tile key out of range\n");
+    } else if (wall && (oldKey < 0 || oldKey > map->maxWallKey ||
+                        newKey < 0 || newKey > map->maxWallKey ||
+                        wallTypes[newKey].wallKey != newKey)) {
+      printf("Wall key out of range\n");
+    } else if (layerStack.layers[0].info.locked) {
+      printf("Layer \"%s\" is locked\n", layerStack.layers[0].info.name);
+    } else {
+      int replaced =
+          replaceKey(map, manager, tile ? DRAW_TILE : DRAW_WALL, oldKey,
+                     newKey, tileTypes, edgeTypes, wallTypes);
+      printf("Replaced %d cells\n", replaced);
+    }
+  } else if (strncmp(commandState->commandBuffer, ":autotile ", 10) == 0) {
+    char *setting = &commandState->commandBuffer[10];
+    if (strcmp(setting, "on") == 0 && wallAutotiler.groupKeys != NULL) {
+      wallAutotiler.enabled = true;
+      printf("Wall autotiling on\n");
+    } else if (strcmp(setting, "off") == 0) {
+      wallAutotiler.enabled = false;
+      printf("Wall autotiling off\n");
+    } else {
+      printf("Autotiling unavailable: %s\n", setting);
+    }
+  } else if (strncmp(commandState->commandBuffer, ":style ", 7) == 0) {
+    char mode[16] = "";
+    unsigned int seed = tileStyles.seed;
+    int matched =
+        sscanf(&commandState->commandBuffer[7], "%15s %u", mode, &seed);
+    char *end;
+    long style = strtol(mode, &end, 10);
+    if (matched >= 1 && strcmp(mode, "hashed") == 0) {
+      tileStyles.hashed = true;
+      tileStyles.seed = seed;
+      markMapDirty(map);
+      printf("Tile styles hashed with seed %u\n", tileStyles.seed);
+    } else if (strcmp(mode, "random") == 0) {
+      tileStyles.hashed = false;
+      printf("Tile styles random\n");
+    } else if (strcmp(mode, "auto") == 0) {
+      tileStyles.override = TILE_STYLE_NO_OVERRIDE;
+      printf("Tile style override cleared\n");
+    } else if (end != mode && *end == '\0' && style >= 0 &&
+               style < TILE_STYLE_HASHED_BYTE) {
+      tileStyles.override = (int)style;
+      printf("Tile style override set to %ld\n", style);
+    } else {
+      printf("Usage: :style hashed [seed]|random|auto|<n>\n");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":level ", 7) == 0) {
+    char *end;
+    long z = strtol(&commandState->commandBuffer[7], &end, 10);
+    if (end == &commandState->commandBuffer[7] || *end != '\0' ||
+        !levelSwitch(map, manager, (int)z, tileTypes, edgeTypes, wallTypes)) {
+      printf("Level out of range\n");
+    }
+  } else if (strcmp(commandState->commandBuffer, ":layers") == 0) {
+    for (int i = 0; i < layerStack.layerCount; i++) {
+      LayerInfo *info = &layerStack.layers[i].info;
+      printf("%c %d %s%s%s\n", i == drawState->activeLayer ? '*' : ' ', i,
+             info->name, info->visible ? "" : " (hidden)",
+             info->locked ? " (locked)" : "");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":layer ", 7) == 0) {
+    char action[16] = "";
+    char name[LAYER_NAME_LENGTH] = "";
+    int matched = sscanf(&commandState->commandBuffer[7], "%15s %31s", action,
+                         name);
+    int layer = layerFind(matched == 2 ? name : action);
+    if (matched == 2 && strcmp(action, "add") == 0) {
+      layer = layerAdd(name);
+      if (layer < 0) {
+        printf("Cannot add layer %s\n", name);
+      } else {
+        drawState->activeLayer = layer;
+        printf("Added layer %d: %s\n", layer, name);
+      }
+    } else if (layer < 0) {
+      printf("Unknown layer\n");
+    } else if (matched == 1) {
+      drawState->activeLayer = layer;
+      printf("Active layer set to %s\n", action);
+    } else if (strcmp(action, "show") == 0 || strcmp(action, "hide") == 0) {
+      layerSetVisible(map, layer, action[0] == 's');
+    } else if (strcmp(action, "lock") == 0 || strcmp(action, "unlock") == 0) {
+      layerStack.layers[layer].info.locked = action[0] == 'l';
+    } else {
+      printf("Usage: :layer [add|show|hide|lock|unlock] <name>\n");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":stats", 6) == 0 &&
+             (commandState->commandBuffer[6] == '\0' ||
+              commandState->commandBuffer[6] == ' ')) {
+    WorldCoords rect = {0, 0, GRID_SIZE - 1, GRID_SIZE - 1};
+    int matched = sscanf(&commandState->commandBuffer[6], "%d %d %d %d",
+                         &rect.startX, &rect.startY, &rect.endX, &rect.endY);
+    if ((matched == EOF || matched == 4) && rect.startX <= rect.endX &&
+        rect.startY <= rect.endY) {
+      statsUpdate(map, tileTypes);
+      int walkable = statsCount(map, STATS_WALKABLE, rect);
+      printf("Cells %d,%d to %d,%d: %d walkable\n", rect.startX, rect.startY,
+             rect.endX, rect.endY, walkable);
+      for (int key = 0; key <= map->maxTileKey; key++) {
+        int count = statsCount(map, key, rect);
+        if (count > 0) {
+          printf("Tile %d: %d\n", key, count);
+        }
+      }
+    } else {
+      printf("Usage: :stats [x0 y0 x1 y1]\n");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":path ", 6) == 0) {
+    int startX, startY, goalX, goalY;
+    if (sscanf(&commandState->commandBuffer[6], "%d %d %d %d", &startX,
+               &startY, &goalX, &goalY) == 4) {
+      PathfindResult result = {0};
+      if (pathfindQuery(map, tileTypes, startX, startY, goalX, goalY,
+                        &result)) {
+        printf("Path cost %.1f, %d steps, %d nodes expanded\n", result.cost,
+               result.steps, result.expanded);
+      } else {
+        printf("No path from %d,%d to %d,%d\n", startX, startY, goalX,
+               goalY);
+      }
+      pathfindResultFree(&result);
+    } else {
+      printf("Usage: :path <x0> <y0> <x1> <y1>\n");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":pathfinder ", 12) == 0) {
+    char *setting = &commandState->commandBuffer[12];
+    if (strcmp(setting, "jps") == 0) {
+      pathfindSetHierarchical(false);
+      printf("Paths use jump point search\n");
+    } else if (strcmp(setting, "hpa") == 0) {
+      pathfindSetHierarchical(true);
+      printf("Paths use the chunk abstraction\n");
+    } else {
+      printf("Usage: :pathfinder <jps|hpa>\n");
+    }
+  } else if (strncmp(commandState->commandBuffer, ":hpa export ", 12) == 0) {
+    char *path = &commandState->commandBuffer[12];
+    int nodes = hpaExport(map, tileTypes, path);
+    if (nodes >= 0) {
+      printf("Path abstraction of %d nodes written to %s\n", nodes, path);
+    }
+  } else if (strcmp(commandState->commandBuffer, ":regions") == 0) {
+    connectivityUpdate(map, tileTypes);
+    int sizes[CONNECT_LIST_MAX];
+    int listed = connectivityLargest(sizes, CONNECT_LIST_MAX);
+    printf("%d walkable regions of %d cells, %d cut off from the largest\n",
+           connectivity.componentCount, connectivity.walkableCells,
+           connectivity.cutOffCells);
+    for (int i = 0; i < listed; i++) {
+      printf("Region %d: %d cells\n", i + 1, sizes[i]);
+    }
+  } else if (strncmp(commandState->commandBuffer, ":lod ", 5) == 0) {
+    float simpleZoom = 0.0f;
+    float colorZoom = 0.0f;
+    int matched = sscanf(&commandState->commandBuffer[5], "%f %f",
+                         &simpleZoom, &colorZoom);
+    if (matched == 2 && simpleZoom >= 0.0f && colorZoom >= 0.0f) {
+      lod.simpleZoom = simpleZoom;
+      lod.colorZoom = colorZoom;
+      printf("LOD thresholds set to %.2f (simple), %.2f (colour)\n",
+             lod.simpleZoom, lod.colorZoom);
+    } else {
+      printf("Invalid LOD thresholds\n");
+    }
   } else {
     printf("Command not recognized\n");
   }
 }
 
-void handleCommandMode(CommandState *commandState, int screenHeight,
-                       int screenWidth, Tile tileTypes[], Edge edgeTypes[],
-                       Wall wallTypes[], sqlite3 *db, DrawingState *drawState,
-                       Map *map) {
+void handleCommandMode(CommandState *commandState, const InputFrame *input,
+                       int screenHeight, int screenWidth, Tile tileTypes[],
+                       Edge edgeTypes[], Wall wallTypes[], sqlite3 *db,
+                       DrawingState *drawState, Map *map,
+                       UndoRedoManager *manager) {
 
   // Command mode entry
-  if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) {
-    if (IsKeyPressed(KEY_SEMICOLON)) {
+  if (inputKeyDown(input, KEY_LEFT_SHIFT) ||
+      inputKeyDown(input, KEY_RIGHT_SHIFT)) {
+    if (inputKeyPressed(input, KEY_SEMICOLON)) {
       printf("Entering command mode\n");
       commandState->inCommandMode = true;
       commandState->commandIndex = 0;
@@ -81,29 +353,28 @@ void handleCommandMode(CommandState *commandState, int screenHeight,
 
   if (commandState->inCommandMode) {
     // Handle character input
-    int key = GetCharPressed();
-    while (key > 0) { // Process all queued characters
+    for (int i = 0; i < input->charCount; i++) { // Process queued characters
+      int key = input->chars[i];
       if (key >= 32 && key <= 126 && commandState->commandIndex < 255) {
         commandState->commandBuffer[commandState->commandIndex] = (char)key;
         (commandState->commandIndex)++;
         commandState->commandBuffer[commandState->commandIndex] = '\0';
       }
-      key = GetCharPressed(); // Get next character in queue
     }
 
     // Handle backspace
-    if (IsKeyPressed(KEY_BACKSPACE) && commandState->commandIndex > 0) {
+    if (inputKeyPressed(input, KEY_BACKSPACE) && commandState->commandIndex > 0) {
       (commandState->commandIndex)--;
       commandState->commandBuffer[commandState->commandIndex] = '\0';
     }
 
     // Handle command execution or exit
-    if (IsKeyPressed(KEY_ENTER)) {
+    if (inputKeyPressed(input, KEY_ENTER)) {
       printf("Command entered: %s\n", commandState->commandBuffer);
       parseCommand(tileTypes, edgeTypes, wallTypes, db, drawState, commandState,
-                   map);
+                   map, manager);
       commandState->inCommandMode = false;
-    } else if (IsKeyPressed(KEY_ESCAPE)) {
+    } else if (inputKeyPressed(input, KEY_ESCAPE)) {
       commandState->inCommandMode = false;
     }
 
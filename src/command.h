@@ -4,6 +4,8 @@
 
 #include "database.h"
 #include "draw.h"
+#include "input.h"
+#include "undo.h"
 #include <sqlite3.h>
 
 typedef struct {
@@ -14,11 +16,13 @@ typedef struct {
 
 void parseCommand(Tile tileTypes[], Edge edgeTypes[], Wall wallTypes[],
                   sqlite3 *db, DrawingState *drawState,
-                  CommandState *commandState, Map *map);
+                  CommandState *commandState, Map *map,
+                  UndoRedoManager *manager);
 
-void handleCommandMode(CommandState *commandState, int screenHeight,
-                       int screenWidth, Tile tileTypes[], Edge edgeTypes[],
-                       Wall wallTypes[], sqlite3 *db, DrawingState *drawState,
-                       Map *map);
+void handleCommandMode(CommandState *commandState, const InputFrame *input,
+                       int screenHeight, int screenWidth, Tile tileTypes[],
+                       Edge edgeTypes[], Wall wallTypes[], sqlite3 *db,
+                       DrawingState *drawState, Map *map,
+                       UndoRedoManager *manager);
 
 #endif // COMMAND_H
@@ -0,0 +1,984 @@
+// connectivity.c
+#include "connectivity.h"
+#include "chunk.h"
+#include "grid.h"
+#include "lod.h"
+#include "profile.h"
+#include "trace.h"
+#include "walkmap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+Connectivity connectivity = {.mainRoot = -1, .freeNode = -1};
+// Changed chunks as they were before connectivityUpdate labelled them again
+static ConnectChunk previousChunks[CONNECT_BATCH_MAX];
+// Chunks a restitch reaches beyond the changed ones
+static int restitchQueue[CHUNK_COUNT * CHUNK_COUNT];
+static int searchQueue[CONNECT_SEARCH_MAX][2]; // chunk index and label
+// Left, right, upper and lower neighbour of a chunk
+static const int sideSteps[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+// Helper functions
+static int findLocal(unsigned char parent[], int cell) {
+  while (parent[cell] != cell) {
+    parent[cell] = parent[parent[cell]];
+    cell = parent[cell];
+  }
+  return cell;
+}
+
+static void uniteLocal(unsigned char parent[], int a, int b) {
+  a = findLocal(parent, a);
+  b = findLocal(parent, b);
+  if (a < b) {
+    parent[b] = (unsigned char)a;
+  } else if (b < a) {
+    parent[a] = (unsigned char)b;
+  }
+}
+
+// Labels the chunk's walkable cells by the components they form inside it,
+// numbered in cell order. Returns true when the labels changed.
+static bool labelChunk(int cx, int cy) {
+  ConnectChunk *chunk = &connectivity.chunks[cx][cy];
+  unsigned char parent[CHUNK_SIZE * CHUNK_SIZE];
+  bool open[CHUNK_SIZE * CHUNK_SIZE];
+  for (int x = 0; x < CHUNK_SIZE; x++) {
+    for (int y = 0; y < CHUNK_SIZE; y++) {
+      int cell = x * CHUNK_SIZE + y;
+      parent[cell] = (unsigned char)cell;
+      open[cell] = walkMapGet(cx * CHUNK_SIZE + x, cy * CHUNK_SIZE + y);
+      if (!open[cell]) {
+        continue;
+      }
+      if (x > 0 && open[cell - CHUNK_SIZE]) {
+        uniteLocal(parent, cell, cell - CHUNK_SIZE);
+      }
+      if (y > 0 && open[cell - 1]) {
+        uniteLocal(parent, cell, cell - 1);
+      }
+    }
+  }
+
+  // A root is the first cell of its component, so it is labelled first
+  unsigned char labels[CHUNK_SIZE * CHUNK_SIZE];
+  unsigned short sizes[CONNECT_LOCAL_MAX] = {0};
+  int labelCount = 0;
+  for (int cell = 0; cell < CHUNK_SIZE * CHUNK_SIZE; cell++) {
+    if (!open[cell]) {
+      labels[cell] = CONNECT_NONE;
+      continue;
+    }
+    int root = findLocal(parent, cell);
+    labels[cell] = root == cell ? (unsigned char)labelCount++ : labels[root];
+    sizes[labels[cell]]++;
+  }
+
+  bool changed = labelCount != chunk->labelCount ||
+                 memcmp(labels, chunk->labels, sizeof(labels)) != 0;
+  memcpy(chunk->labels, labels, sizeof(labels));
+  memcpy(chunk->sizes, sizes, sizeof(sizes));
+  chunk->labelCount = labelCount;
+  return changed;
+}
+
+// Chunk with index cx * CHUNK_COUNT + cy
+static ConnectChunk *chunkAt(int index) {
+  return &connectivity.chunks[index / CHUNK_COUNT][index % CHUNK_COUNT];
+}
+
+static int findRoot(int component) {
+  int *parents = connectivity.parents;
+  while (parents[component] != component) {
+    parents[component] = parents[parents[component]];
+    component = parents[component];
+  }
+  return component;
+}
+
+// Keeps mainRoot on the largest component and otherBound at least the size
+// of every other one after root's component grew
+static void noteRoot(int root) {
+  int largest = connectivity.mainRoot;
+  int size = connectivity.sizes[root];
+  if (root == largest) {
+    return;
+  }
+  if (largest < 0 || size > connectivity.sizes[largest]) {
+    if (largest >= 0 &&
+        connectivity.sizes[largest] > connectivity.otherBound) {
+      connectivity.otherBound = connectivity.sizes[largest];
+    }
+    connectivity.mainRoot = root;
+  } else if (size > connectivity.otherBound) {
+    connectivity.otherBound = size;
+  }
+}
+
+// Union by size; the smaller component hangs under the larger
+static void unite(int a, int b) {
+  a = findRoot(a);
+  b = findRoot(b);
+  if (a == b) {
+    return;
+  }
+  if (connectivity.sizes[a] < connectivity.sizes[b]) {
+    int swap = a;
+    a = b;
+    b = swap;
+  }
+  connectivity.parents[b] = a;
+  connectivity.sizes[a] += connectivity.sizes[b];
+  connectivity.componentCount--;
+  if (connectivity.mainRoot == b) {
+    connectivity.mainRoot = a;
+  }
+  noteRoot(a);
+}
+
+// Joins the local components of two chunks along their shared border.
+// Cells a and b step through each side of it.
+static void uniteBorder(const ConnectChunk *first, const ConnectChunk *second,
+                        int firstCell, int secondCell, int step) {
+  int lastA = CONNECT_NONE;
+  int lastB = CONNECT_NONE;
+  for (int i = 0; i < CHUNK_SIZE; i++) {
+    int a = first->labels[firstCell + i * step];
+    int b = second->labels[secondCell + i * step];
+    if (a == CONNECT_NONE || b == CONNECT_NONE || (a == lastA && b == lastB)) {
+      continue;
+    }
+    unite(first->nodes[a], second->nodes[b]);
+    lastA = a;
+    lastB = b;
+  }
+}
+
+// Joins a chunk's labels to those of its four neighbours. With shared set,
+// the left and upper neighbours reached by the same restitch are left to
+// join from their side.
+static void uniteChunk(int cx, int cy, bool shared) {
+  ConnectChunk *chunk = &connectivity.chunks[cx][cy];
+  if (cx > 0 && !(shared && connectivity.chunks[cx - 1][cy].visited ==
+                                connectivity.serial)) {
+    uniteBorder(&connectivity.chunks[cx - 1][cy], chunk,
+                (CHUNK_SIZE - 1) * CHUNK_SIZE, 0, 1);
+  }
+  if (cx + 1 < CHUNK_COUNT) {
+    uniteBorder(chunk, &connectivity.chunks[cx + 1][cy],
+                (CHUNK_SIZE - 1) * CHUNK_SIZE, 0, 1);
+  }
+  if (cy > 0 && !(shared && connectivity.chunks[cx][cy - 1].visited ==
+                                connectivity.serial)) {
+    uniteBorder(&connectivity.chunks[cx][cy - 1], chunk, CHUNK_SIZE - 1, 0,
+                CHUNK_SIZE);
+  }
+  if (cy + 1 < CHUNK_COUNT) {
+    uniteBorder(chunk, &connectivity.chunks[cx][cy + 1], CHUNK_SIZE - 1, 0,
+                CHUNK_SIZE);
+  }
+}
+
+static bool reserveComponents(int count) {
+  if (count <= connectivity.capacity) {
+    return true;
+  }
+  int capacity = connectivity.capacity > 0 ? connectivity.capacity : 1024;
+  while (capacity < count) {
+    capacity *= 2;
+  }
+  int *parents =
+      (int *)realloc(connectivity.parents, (size_t)capacity * sizeof(int));
+  if (parents == NULL) {
+    printf("Memory allocation failed\n");
+    return false;
+  }
+  connectivity.parents = parents;
+  int *sizes =
+      (int *)realloc(connectivity.sizes, (size_t)capacity * sizeof(int));
+  if (sizes == NULL) {
+    printf("Memory allocation failed\n");
+    return false;
+  }
+  connectivity.sizes = sizes;
+  unsigned char *marks =
+      (unsigned char *)realloc(connectivity.marks, (size_t)capacity);
+  if (marks == NULL) {
+    printf("Memory allocation failed\n");
+    return false;
+  }
+  memset(marks + connectivity.capacity, 0,
+         (size_t)(capacity - connectivity.capacity));
+  connectivity.marks = marks;
+  connectivity.capacity = capacity;
+  return true;
+}
+
+// Hands out a node for a component of its own. Room must be reserved.
+static int allocNode(int size) {
+  int node = connectivity.freeNode;
+  if (node >= 0) {
+    connectivity.freeNode = connectivity.parents[node];
+  } else {
+    node = connectivity.nodeCount++;
+  }
+  connectivity.parents[node] = node;
+  connectivity.sizes[node] = size;
+  connectivity.componentCount++;
+  return node;
+}
+
+static void releaseNode(int node) {
+  connectivity.parents[node] = connectivity.freeNode;
+  connectivity.freeNode = node;
+}
+
+// Counts the components again from their roots and finds the largest
+static void rescan(void) {
+  connectivity.componentCount = 0;
+  connectivity.walkableCells = 0;
+  connectivity.mainRoot = -1;
+  connectivity.otherBound = 0;
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      ConnectChunk *chunk = &connectivity.chunks[cx][cy];
+      for (int label = 0; label < chunk->labelCount; label++) {
+        int node = chunk->nodes[label];
+        if (connectivity.parents[node] != node) {
+          continue;
+        }
+        connectivity.componentCount++;
+        connectivity.walkableCells += connectivity.sizes[node];
+        noteRoot(node);
+      }
+    }
+  }
+}
+
+// Unites every chunk's local components across the chunk borders
+static bool stitch(void) {
+  int total = 0;
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      total += connectivity.chunks[cx][cy].labelCount;
+    }
+  }
+  if (!reserveComponents(total)) {
+    return false;
+  }
+
+  connectivity.nodeCount = 0;
+  connectivity.orphanCount = 0;
+  connectivity.freeNode = -1;
+  connectivity.mainRoot = -1;
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      ConnectChunk *chunk = &connectivity.chunks[cx][cy];
+      for (int label = 0; label < chunk->labelCount; label++) {
+        chunk->nodes[label] = allocNode(chunk->sizes[label]);
+      }
+    }
+  }
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      ConnectChunk *chunk = &connectivity.chunks[cx][cy];
+      if (chunk->labelCount == 0) {
+        continue;
+      }
+      if (cx + 1 < CHUNK_COUNT) {
+        uniteBorder(chunk, &connectivity.chunks[cx + 1][cy],
+                    (CHUNK_SIZE - 1) * CHUNK_SIZE, 0, 1);
+      }
+      if (cy + 1 < CHUNK_COUNT) {
+        uniteBorder(chunk, &connectivity.chunks[cx][cy + 1], CHUNK_SIZE - 1,
+                    0, CHUNK_SIZE);
+      }
+    }
+  }
+  rescan();
+  return true;
+}
+
+// Cell i along a chunk's side and the cell it touches in the neighbour on
+// that side
+static void sideCells(int side, int i, int *own, int *other) {
+  int last = CHUNK_SIZE - 1;
+  int cells[4][2] = {{i, last * CHUNK_SIZE + i},
+                     {last * CHUNK_SIZE + i, i},
+                     {i * CHUNK_SIZE, i * CHUNK_SIZE + last},
+                     {i * CHUNK_SIZE + last, i * CHUNK_SIZE}};
+  *own = cells[side][0];
+  *other = cells[side][1];
+}
+
+// True when no path through the chunk can have been cut: every edge cell
+// that was walkable still is, and edge cells that shared a label still do.
+// Pairs each old edge label with its new label, and each new edge label
+// with one of its old labels; labels off the edges are left at
+// CONNECT_NONE. opened is set when an edge cell became walkable.
+static bool edgesJoined(const ConnectChunk *before, const ConnectChunk *after,
+                        unsigned char oldToNew[], unsigned char newToOld[],
+                        bool *opened) {
+  memset(oldToNew, CONNECT_NONE, CONNECT_LOCAL_MAX);
+  memset(newToOld, CONNECT_NONE, CONNECT_LOCAL_MAX);
+  *opened = false;
+  for (int side = 0; side < 4; side++) {
+    for (int i = 0; i < CHUNK_SIZE; i++) {
+      int cell, other;
+      sideCells(side, i, &cell, &other);
+      int a = before->labels[cell];
+      int b = after->labels[cell];
+      if (b == CONNECT_NONE) {
+        if (a != CONNECT_NONE) {
+          return false;
+        }
+        continue;
+      }
+      if (a == CONNECT_NONE) {
+        *opened = true;
+        continue;
+      }
+      if (oldToNew[a] == CONNECT_NONE) {
+        oldToNew[a] = (unsigned char)b;
+      } else if (oldToNew[a] != b) {
+        return false;
+      }
+      if (newToOld[b] == CONNECT_NONE) {
+        newToOld[b] = (unsigned char)a;
+      }
+    }
+  }
+  return true;
+}
+
+// Moves a chunk whose edges stayed joined onto its new labels. Edge labels
+// keep the node of one old label they took in and join the nodes of the
+// others, which stay behind without a label; labels off the edges are
+// components of their own.
+static void joinEdges(ConnectChunk *chunk, const ConnectChunk *before,
+                      const unsigned char oldToNew[],
+                      const unsigned char newToOld[]) {
+  for (int label = 0; label < before->labelCount; label++) {
+    int node = before->nodes[label];
+    if (oldToNew[label] != CONNECT_NONE) {
+      connectivity.sizes[findRoot(node)] -= before->sizes[label];
+      continue;
+    }
+    if (connectivity.mainRoot == node) {
+      connectivity.mainRoot = -1;
+    }
+    connectivity.componentCount--;
+    releaseNode(node);
+  }
+  for (int label = 0; label < chunk->labelCount; label++) {
+    int old = newToOld[label];
+    if (old == CONNECT_NONE) {
+      chunk->nodes[label] = allocNode(chunk->sizes[label]);
+      noteRoot(chunk->nodes[label]);
+      continue;
+    }
+    chunk->nodes[label] = before->nodes[old];
+    int root = findRoot(chunk->nodes[label]);
+    connectivity.sizes[root] += chunk->sizes[label];
+    noteRoot(root);
+  }
+  for (int label = 0; label < before->labelCount; label++) {
+    int joined = oldToNew[label];
+    if (joined == CONNECT_NONE || newToOld[joined] == label) {
+      continue;
+    }
+    int node = before->nodes[label];
+    unite(node, chunk->nodes[joined]);
+    connectivity.orphanCount++;
+    // Roots always belong to a label
+    if (findRoot(node) == node) {
+      chunk->nodes[joined] = node;
+    }
+  }
+}
+
+// Sets a label's bit in one of the chunk's search sets. Returns false when
+// it was already set; bits left by an earlier search read as clear.
+static bool setSearchBit(ConnectChunk *chunk, int set, int label) {
+  if (chunk->searched != connectivity.serial) {
+    memset(chunk->searchBits, 0, sizeof(chunk->searchBits));
+    chunk->searched = connectivity.serial;
+  }
+  uint64_t bit = (uint64_t)1 << (label % 64);
+  uint64_t *word = &chunk->searchBits[set][label / 64];
+  if (*word & bit) {
+    return false;
+  }
+  *word |= bit;
+  return true;
+}
+
+static bool searchBit(const ConnectChunk *chunk, int set, int label) {
+  return chunk->searched == connectivity.serial &&
+         (chunk->searchBits[set][label / 64] >> (label % 64) & 1);
+}
+
+static bool inList(const int changed[], const int list[], int count,
+                   int index) {
+  for (int i = 0; i < count; i++) {
+    if (changed[list[i]] == index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Searches the labels as they are now for the pieces of the component with
+// the given root that lie outside the listed chunks, starting from their
+// labels on the chunks' borders. *budget counts down the labels visited.
+// Returns the node of one such label when all pieces meet, -1 when the
+// component lay inside the chunks and -2 when it may be cut.
+static int searchPieces(int root, const int changed[], const int list[],
+                        int count, int *budget) {
+  connectivity.serial++;
+  int wanted = 0;
+  int tail = 0;
+  for (int i = 0; i < count; i++) {
+    int cx = changed[list[i]] / CHUNK_COUNT;
+    int cy = changed[list[i]] % CHUNK_COUNT;
+    for (int side = 0; side < 4; side++) {
+      int nx = cx + sideSteps[side][0];
+      int ny = cy + sideSteps[side][1];
+      if (nx < 0 || nx >= CHUNK_COUNT || ny < 0 || ny >= CHUNK_COUNT ||
+          inList(changed, list, count, nx * CHUNK_COUNT + ny)) {
+        continue;
+      }
+      ConnectChunk *neighbour = &connectivity.chunks[nx][ny];
+      for (int j = 0; j < CHUNK_SIZE; j++) {
+        int own, other;
+        sideCells(side, j, &own, &other);
+        int label = neighbour->labels[other];
+        if (label == CONNECT_NONE ||
+            findRoot(neighbour->nodes[label]) != root ||
+            !setSearchBit(neighbour, 1, label)) {
+          continue;
+        }
+        wanted++;
+        if (tail == 0) {
+          setSearchBit(neighbour, 0, label);
+          searchQueue[tail][0] = nx * CHUNK_COUNT + ny;
+          searchQueue[tail++][1] = label;
+        }
+      }
+    }
+  }
+  if (wanted == 0) {
+    return -1;
+  }
+
+  int found = 1;
+  for (int head = 0; head < tail && found < wanted; head++) {
+    if (--*budget < 0) {
+      return -2;
+    }
+    int cx = searchQueue[head][0] / CHUNK_COUNT;
+    int cy = searchQueue[head][0] % CHUNK_COUNT;
+    const ConnectChunk *chunk = &connectivity.chunks[cx][cy];
+    for (int side = 0; side < 4; side++) {
+      int nx = cx + sideSteps[side][0];
+      int ny = cy + sideSteps[side][1];
+      if (nx < 0 || nx >= CHUNK_COUNT || ny < 0 || ny >= CHUNK_COUNT) {
+        continue;
+      }
+      ConnectChunk *neighbour = &connectivity.chunks[nx][ny];
+      for (int j = 0; j < CHUNK_SIZE; j++) {
+        int own, other;
+        sideCells(side, j, &own, &other);
+        int label = neighbour->labels[other];
+        if (chunk->labels[own] != searchQueue[head][1] ||
+            label == CONNECT_NONE || !setSearchBit(neighbour, 0, label)) {
+          continue;
+        }
+        if (tail == CONNECT_SEARCH_MAX) {
+          return -2;
+        }
+        found += searchBit(neighbour, 1, label);
+        searchQueue[tail][0] = nx * CHUNK_COUNT + ny;
+        searchQueue[tail++][1] = label;
+      }
+    }
+  }
+  if (found < wanted) {
+    return -2;
+  }
+  const ConnectChunk *first = chunkAt(searchQueue[0][0]);
+  return first->nodes[searchQueue[0][1]];
+}
+
+// Moves the listed chunks onto their new labels when a search shows that
+// no component they touched was cut. Components that lay inside the chunks
+// are dropped; the others keep their nodes in the chunks, without labels,
+// and take a root outside them. Returns false, changing nothing, when a
+// component may be cut.
+static bool splice(const int changed[], const ConnectChunk before[],
+                   const int list[], int count) {
+  int roots[CONNECT_CHECK_MAX];
+  int anchors[CONNECT_CHECK_MAX];
+  int checked = 0;
+  int budget = CONNECT_SEARCH_MAX;
+  for (int i = 0; i < count; i++) {
+    const ConnectChunk *old = &before[list[i]];
+    for (int label = 0; label < old->labelCount; label++) {
+      int root = findRoot(old->nodes[label]);
+      int known = 0;
+      while (known < checked && roots[known] != root) {
+        known++;
+      }
+      if (known < checked) {
+        continue;
+      }
+      if (checked == CONNECT_CHECK_MAX) {
+        return false;
+      }
+      anchors[checked] = searchPieces(root, changed, list, count, &budget);
+      if (anchors[checked] == -2) {
+        return false;
+      }
+      roots[checked++] = root;
+    }
+  }
+
+  // The old labels' cells leave their components, and components without
+  // pieces left are dropped with their nodes
+  bool drop[CONNECT_BATCH_MAX][CONNECT_LOCAL_MAX];
+  for (int i = 0; i < count; i++) {
+    const ConnectChunk *old = &before[list[i]];
+    for (int label = 0; label < old->labelCount; label++) {
+      int root = findRoot(old->nodes[label]);
+      connectivity.sizes[root] -= old->sizes[label];
+      int known = 0;
+      while (roots[known] != root) {
+        known++;
+      }
+      drop[i][label] = anchors[known] == -1;
+    }
+  }
+  for (int i = 0; i < checked; i++) {
+    int anchor = anchors[i];
+    int root = roots[i];
+    if (anchor == -1) {
+      connectivity.componentCount--;
+      if (connectivity.mainRoot == root) {
+        connectivity.mainRoot = -1;
+      }
+      continue;
+    }
+    // Roots always belong to a label
+    connectivity.parents[anchor] = anchor;
+    connectivity.parents[root] = anchor;
+    connectivity.sizes[anchor] = connectivity.sizes[root];
+    if (connectivity.mainRoot == root) {
+      connectivity.mainRoot = anchor;
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    const ConnectChunk *old = &before[list[i]];
+    for (int label = 0; label < old->labelCount; label++) {
+      if (drop[i][label]) {
+        releaseNode(old->nodes[label]);
+      } else {
+        connectivity.orphanCount++;
+      }
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    ConnectChunk *chunk = chunkAt(changed[list[i]]);
+    for (int label = 0; label < chunk->labelCount; label++) {
+      chunk->nodes[label] = allocNode(chunk->sizes[label]);
+      noteRoot(chunk->nodes[label]);
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    uniteChunk(changed[list[i]] / CHUNK_COUNT, changed[list[i]] % CHUNK_COUNT,
+               false);
+  }
+  return true;
+}
+
+// Queues the neighbours of a chunk that hold a label of a component being
+// taken apart. Points every label's node in them at its root, so the marks
+// can be read before any node is reset.
+static void reachNeighbours(int index, int *tail) {
+  for (int side = 0; side < 4; side++) {
+    int nx = index / CHUNK_COUNT + sideSteps[side][0];
+    int ny = index % CHUNK_COUNT + sideSteps[side][1];
+    if (nx < 0 || nx >= CHUNK_COUNT || ny < 0 || ny >= CHUNK_COUNT) {
+      continue;
+    }
+    ConnectChunk *chunk = &connectivity.chunks[nx][ny];
+    if (chunk->visited == connectivity.serial) {
+      continue;
+    }
+    bool reached = false;
+    for (int label = 0; label < chunk->labelCount; label++) {
+      int node = chunk->nodes[label];
+      connectivity.parents[node] = findRoot(node);
+      reached |= connectivity.marks[connectivity.parents[node]];
+    }
+    if (reached) {
+      chunk->visited = connectivity.serial;
+      restitchQueue[(*tail)++] = nx * CHUNK_COUNT + ny;
+    }
+  }
+}
+
+// Takes apart the components that held the old labels of the given changed
+// chunks, then joins the labels of every chunk those components covered
+// across its borders again. Chunks the components never reached are left
+// alone. Returns false, changing nothing, when the components hold more
+// than CONNECT_RESTITCH_MAX cells, as stitching the whole map is cheaper.
+static bool restitch(const int changed[], const ConnectChunk before[],
+                     const int list[], int count) {
+  int cells = 0;
+  for (int i = 0; i < count; i++) {
+    const ConnectChunk *old = &before[list[i]];
+    for (int label = 0; label < old->labelCount; label++) {
+      int root = findRoot(old->nodes[label]);
+      if (!connectivity.marks[root]) {
+        connectivity.marks[root] = 1;
+        cells += connectivity.sizes[root];
+      }
+    }
+  }
+  if (cells > CONNECT_RESTITCH_MAX) {
+    for (int i = 0; i < count; i++) {
+      const ConnectChunk *old = &before[list[i]];
+      for (int label = 0; label < old->labelCount; label++) {
+        connectivity.marks[findRoot(old->nodes[label])] = 0;
+      }
+    }
+    return false;
+  }
+
+  connectivity.serial++;
+  for (int i = 0; i < count; i++) {
+    const ConnectChunk *old = &before[list[i]];
+    for (int label = 0; label < old->labelCount; label++) {
+      int root = findRoot(old->nodes[label]);
+      if (connectivity.marks[root] != 1) {
+        continue;
+      }
+      connectivity.marks[root] = 2; // counted
+      connectivity.componentCount--;
+      if (connectivity.mainRoot == root) {
+        connectivity.mainRoot = -1;
+      }
+    }
+    chunkAt(changed[list[i]])->visited = connectivity.serial;
+  }
+
+  // The marked components reach every chunk they cover through neighbours
+  // they also cover
+  int tail = 0;
+  for (int i = 0; i < count; i++) {
+    reachNeighbours(changed[list[i]], &tail);
+  }
+  for (int head = 0; head < tail; head++) {
+    reachNeighbours(restitchQueue[head], &tail);
+  }
+
+  // Reset the marked components' labels, then clear the marks
+  for (int i = 0; i < tail; i++) {
+    ConnectChunk *chunk = chunkAt(restitchQueue[i]);
+    for (int label = 0; label < chunk->labelCount; label++) {
+      int node = chunk->nodes[label];
+      if (connectivity.marks[connectivity.parents[node]]) {
+        connectivity.parents[node] = node;
+        connectivity.sizes[node] = chunk->sizes[label];
+        connectivity.componentCount++;
+        noteRoot(node);
+      }
+    }
+  }
+  for (int i = 0; i < tail; i++) {
+    ConnectChunk *chunk = chunkAt(restitchQueue[i]);
+    for (int label = 0; label < chunk->labelCount; label++) {
+      connectivity.marks[chunk->nodes[label]] = 0;
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    const ConnectChunk *old = &before[list[i]];
+    for (int label = 0; label < old->labelCount; label++) {
+      connectivity.marks[old->nodes[label]] = 0;
+      releaseNode(old->nodes[label]);
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    ConnectChunk *chunk = chunkAt(changed[list[i]]);
+    for (int label = 0; label < chunk->labelCount; label++) {
+      chunk->nodes[label] = allocNode(chunk->sizes[label]);
+      noteRoot(chunk->nodes[label]);
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    uniteChunk(changed[list[i]] / CHUNK_COUNT, changed[list[i]] % CHUNK_COUNT,
+               true);
+  }
+  for (int i = 0; i < tail; i++) {
+    uniteChunk(restitchQueue[i] / CHUNK_COUNT, restitchQueue[i] % CHUNK_COUNT,
+               true);
+  }
+  return true;
+}
+
+static int walkableIn(const ConnectChunk *chunk) {
+  int cells = 0;
+  for (int label = 0; label < chunk->labelCount; label++) {
+    cells += chunk->sizes[label];
+  }
+  return cells;
+}
+
+// Stitches the changed chunks into the components left by the last update.
+// before holds each changed chunk as it was, with the nodes of its labels.
+static bool stitchChanged(const int changed[], const ConnectChunk before[],
+                          int count) {
+  int needed = connectivity.nodeCount;
+  for (int i = 0; i < count; i++) {
+    needed += chunkAt(changed[i])->labelCount;
+  }
+  if (!reserveComponents(needed)) {
+    return false;
+  }
+
+  int list[CONNECT_BATCH_MAX];
+  int split = 0;
+  bool opened[CONNECT_BATCH_MAX];
+  for (int i = 0; i < count; i++) {
+    ConnectChunk *chunk = chunkAt(changed[i]);
+    connectivity.walkableCells += walkableIn(chunk) - walkableIn(&before[i]);
+    unsigned char oldToNew[CONNECT_LOCAL_MAX];
+    unsigned char newToOld[CONNECT_LOCAL_MAX];
+    if (edgesJoined(&before[i], chunk, oldToNew, newToOld, &opened[i])) {
+      joinEdges(chunk, &before[i], oldToNew, newToOld);
+    } else {
+      list[split++] = i;
+      opened[i] = false;
+    }
+  }
+  if (split > 0 && !splice(changed, before, list, split) &&
+      !restitch(changed, before, list, split)) {
+    return stitch();
+  }
+  // Edge cells that became walkable join their neighbours once every
+  // changed chunk has its nodes
+  for (int i = 0; i < count; i++) {
+    if (opened[i]) {
+      uniteChunk(changed[i] / CHUNK_COUNT, changed[i] % CHUNK_COUNT, false);
+    }
+  }
+  // Nodes left without a label are dropped by stitching the whole map
+  if (connectivity.orphanCount * 2 > connectivity.nodeCount) {
+    return stitch();
+  }
+
+  // The main component shrank below what another may hold
+  if (connectivity.walkableCells == 0) {
+    connectivity.mainRoot = -1;
+    connectivity.otherBound = 0;
+  } else if (connectivity.mainRoot < 0 ||
+             connectivity.sizes[connectivity.mainRoot] <
+                 connectivity.otherBound) {
+    rescan();
+  }
+  return true;
+}
+
+static int compareSizes(const void *a, const void *b) {
+  int first = *(const int *)a;
+  int second = *(const int *)b;
+  return (first < second) - (first > second);
+}
+
+// Connectivity functions
+// Labels the changed chunks again and stitches the ones whose labels moved
+// into the components. Past CONNECT_BATCH_MAX changed chunks the whole map
+// is stitched again. Returns true when the components may have changed.
+bool connectivityUpdate(Map *map, Tile tileTypes[]) {
+  ConnectChunk *before = previousChunks;
+  int changed[CONNECT_BATCH_MAX];
+  walkMapUpdate(map, tileTypes);
+  bool rebuild = connectivity.owner != map;
+  if (rebuild) {
+    connectivity.owner = map;
+  }
+
+  traceBegin("connectivityUpdate");
+  int dirty = 0;
+  for (int cx = 0; cx < CHUNK_COUNT && !rebuild; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      dirty += chunkIsDirty(map, cx, cy, CHUNK_DIRTY_CONNECT);
+    }
+  }
+  rebuild |= dirty > CONNECT_BATCH_MAX;
+
+  int count = 0;
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      if (!rebuild && !chunkIsDirty(map, cx, cy, CHUNK_DIRTY_CONNECT)) {
+        continue;
+      }
+      if (!rebuild) {
+        before[count] = connectivity.chunks[cx][cy];
+      }
+      if (labelChunk(cx, cy) && !rebuild) {
+        changed[count++] = cx * CHUNK_COUNT + cy;
+      }
+      clearChunkDirty(map, cx, cy, CHUNK_DIRTY_CONNECT);
+    }
+  }
+  if (rebuild || count > 0) {
+    double start = profileNow();
+    if (!(rebuild ? stitch() : stitchChanged(changed, before, count))) {
+      connectivity.owner = NULL;
+    }
+    int largest = connectivity.mainRoot;
+    connectivity.cutOffCells =
+        largest < 0 ? 0
+                    : connectivity.walkableCells - connectivity.sizes[largest];
+    connectivity.elapsed = profileNow() - start;
+  }
+  traceEnd("connectivityUpdate");
+  return rebuild || count > 0;
+}
+
+// Root of the component holding cell (x, y) as of the last
+// connectivityUpdate, or -1 when the cell is not walkable
+int connectivityComponent(const Map *map, int x, int y) {
+  if (connectivity.owner != map || x < 0 || x >= GRID_SIZE || y < 0 ||
+      y >= GRID_SIZE) {
+    return -1;
+  }
+  const ConnectChunk *chunk =
+      &connectivity.chunks[x / CHUNK_SIZE][y / CHUNK_SIZE];
+  int label = chunk->labels[(x % CHUNK_SIZE) * CHUNK_SIZE + y % CHUNK_SIZE];
+  if (label == CONNECT_NONE) {
+    return -1;
+  }
+  return findRoot(chunk->nodes[label]);
+}
+
+// Writes the cell counts of up to max of the largest components, largest
+// first. Returns how many were written.
+int connectivityLargest(int sizes[], int max) {
+  if (connectivity.owner == NULL || connectivity.componentCount == 0) {
+    return 0;
+  }
+  int *all = (int *)malloc((size_t)connectivity.componentCount * sizeof(int));
+  if (all == NULL) {
+    printf("Memory allocation failed\n");
+    return 0;
+  }
+  int count = 0;
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      const ConnectChunk *chunk = &connectivity.chunks[cx][cy];
+      for (int label = 0; label < chunk->labelCount; label++) {
+        int node = chunk->nodes[label];
+        if (connectivity.parents[node] == node) {
+          all[count++] = connectivity.sizes[node];
+        }
+      }
+    }
+  }
+  qsort(all, (size_t)count, sizeof(int), compareSizes);
+  count = count < max ? count : max;
+  memcpy(sizes, all, (size_t)count * sizeof(int));
+  free(all);
+  return count;
+}
+
+// Tints the walkable cells outside the main component, in world space.
+// Zoomed out to colours, whole chunks holding such cells are tinted.
+void connectivityDraw(Map *map, Tile tileTypes[], Camera2D camera,
+                      int screenWidth, int screenHeight) {
+  if (!connectivity.visible) {
+    return;
+  }
+  connectivityUpdate(map, tileTypes);
+  if (connectivity.owner != map || connectivity.cutOffCells == 0) {
+    return;
+  }
+
+  WorldCoords bounds = GetVisibleGridBounds(camera, screenWidth, screenHeight);
+  bool coarse = lodLevel(camera.zoom) == LOD_COLOR;
+  Color tint = Fade(RED, 0.4f);
+  for (int cx = bounds.startX / CHUNK_SIZE; cx <= bounds.endX / CHUNK_SIZE;
+       cx++) {
+    for (int cy = bounds.startY / CHUNK_SIZE;
+         cy <= bounds.endY / CHUNK_SIZE; cy++) {
+      const ConnectChunk *chunk = &connectivity.chunks[cx][cy];
+      bool cut[CONNECT_LOCAL_MAX];
+      bool anyCut = false;
+      for (int label = 0; label < chunk->labelCount; label++) {
+        cut[label] = findRoot(chunk->nodes[label]) != connectivity.mainRoot;
+        anyCut |= cut[label];
+      }
+      if (!anyCut) {
+        continue;
+      }
+      if (coarse) {
+        DrawRectangle(cx * CHUNK_SIZE * TILE_SIZE, cy * CHUNK_SIZE * TILE_SIZE,
+                      CHUNK_SIZE * TILE_SIZE, CHUNK_SIZE * TILE_SIZE, tint);
+        continue;
+      }
+
+      // One rectangle per run of cut off cells down each column
+      for (int x = 0; x < CHUNK_SIZE; x++) {
+        int runStart = -1;
+        for (int y = 0; y <= CHUNK_SIZE; y++) {
+          bool cutOff = false;
+          if (y < CHUNK_SIZE) {
+            int label = chunk->labels[x * CHUNK_SIZE + y];
+            cutOff = label != CONNECT_NONE && cut[label];
+          }
+          if (cutOff && runStart < 0) {
+            runStart = y;
+          } else if (!cutOff && runStart >= 0) {
+            DrawRectangle((cx * CHUNK_SIZE + x) * TILE_SIZE,
+                          (cy * CHUNK_SIZE + runStart) * TILE_SIZE, TILE_SIZE,
+                          (y - runStart) * TILE_SIZE, tint);
+            runStart = -1;
+          }
+        }
+      }
+    }
+  }
+}
+
+// Component count and cut off cells in the top-right corner of the screen,
+// below the path tool's readout
+void connectivityDrawReadout(int screenWidth) {
+  if (!connectivity.visible || connectivity.owner == NULL) {
+    return;
+  }
+  char text[128];
+  snprintf(text, sizeof(text), "regions: %d, %d cells cut off (%.2f ms)",
+           connectivity.componentCount, connectivity.cutOffCells,
+           connectivity.elapsed);
+
+  int top = CONNECT_FONT_SIZE + 17;
+  int width = MeasureText(text, CONNECT_FONT_SIZE);
+  DrawRectangle(screenWidth - width - 15, top, width + 10,
+                CONNECT_FONT_SIZE + 8, Fade(BLACK, 0.6f));
+  DrawText(text, screenWidth - width - 10, top + 4, CONNECT_FONT_SIZE,
+           RAYWHITE);
+}
+
+void connectivityUnload(void) {
+  free(connectivity.parents);
+  free(connectivity.sizes);
+  free(connectivity.marks);
+  memset(&connectivity, 0, sizeof(Connectivity));
+  connectivity.mainRoot = -1;
+  connectivity.freeNode = -1;
+}
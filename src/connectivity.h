@@ -0,0 +1,83 @@
+// connectivity.h
+#ifndef CONNECTIVITY_H
+#define CONNECTIVITY_H
+
+// includes
+#include "database.h"
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// definitions
+#define CONNECT_NONE 0xff // ConnectChunk.labels of cells that are not walkable
+#define CONNECT_LOCAL_MAX (CHUNK_SIZE * CHUNK_SIZE / 2) // a checkerboard
+#define CONNECT_FONT_SIZE 10
+#define CONNECT_LIST_MAX 8 // component sizes :regions lists
+#define CONNECT_BATCH_MAX 32 // changed chunks stitched in place per update
+// Cells of the components a restitch may take apart before the whole map is
+// stitched instead
+#define CONNECT_RESTITCH_MAX (GRID_SIZE * GRID_SIZE / 4)
+#define CONNECT_SEARCH_MAX 512 // labels searched for the pieces of cut edges
+#define CONNECT_CHECK_MAX 16   // components an update searches for
+
+// structs
+// Walkable cells of one chunk grouped into components joined through the
+// chunk's own cells
+typedef struct {
+  unsigned char labels[CHUNK_SIZE * CHUNK_SIZE]; // x * CHUNK_SIZE + y
+  unsigned short sizes[CONNECT_LOCAL_MAX];       // cells of each label
+  // Connectivity.parents index of each label
+  int nodes[CONNECT_LOCAL_MAX];
+  int labelCount;
+  unsigned int visited;  // Connectivity.serial of the last restitch to reach it
+  unsigned int searched; // Connectivity.serial searchBits belong to
+  // Labels the last search has seen and labels it looks for
+  uint64_t searchBits[2][(CONNECT_LOCAL_MAX + 63) / 64];
+} ConnectChunk;
+
+// Connected components of walkable cells. Moves never cut corners, so two
+// cells are connected exactly when a path of side-adjacent walkable cells
+// joins them. Chunks marked CHUNK_DIRTY_CONNECT are labelled again by
+// connectivityUpdate, and a union-find over every chunk's labels joins the
+// labels that touch across chunk borders. A changed chunk whose edge cells
+// stay joined keeps the nodes of its edge labels. When an edit may have cut
+// a component, a bounded search checks whether its pieces still meet; only
+// components that may be cut are taken apart and joined again.
+typedef struct {
+  const Map *owner;
+  bool visible; // F5 shows the cells cut off from the main component
+  ConnectChunk chunks[CHUNK_COUNT][CHUNK_COUNT];
+  int *parents;         // parent of each node; free nodes chain through it
+  int *sizes;           // cells of the component each root stands for
+  unsigned char *marks; // roots of the components being taken apart
+  int capacity;         // nodes parents, sizes and marks have room for
+  int nodeCount;        // nodes handed out so far, free ones included
+  int orphanCount;      // nodes left in a component without a label
+  int freeNode;         // first free node, -1 when none
+  unsigned int serial;  // bumped by every restitch and search
+  int componentCount;
+  int mainRoot;   // root of the largest component, -1 when none is walkable
+  int otherBound; // no component but the main one holds more cells
+  int walkableCells;
+  int cutOffCells; // walkable cells outside the main component
+  double elapsed;  // milliseconds the last stitch took
+} Connectivity;
+
+// globals
+extern Connectivity connectivity;
+
+// functions
+bool connectivityUpdate(Map *map, Tile tileTypes[]);
+
+int connectivityComponent(const Map *map, int x, int y);
+
+int connectivityLargest(int sizes[], int max);
+
+void connectivityDraw(Map *map, Tile tileTypes[], Camera2D camera,
+                      int screenWidth, int screenHeight);
+
+void connectivityDrawReadout(int screenWidth);
+
+void connectivityUnload(void);
+
+#endif // CONNECTIVITY_H
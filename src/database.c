@@ -1,4 +1,7 @@
 #include "database.h"
+#include "atlas.h"
+#include "chunk.h"
+#include "runindex.h"
 #include <sqlite3.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -74,9 +77,41 @@ Texture2D loadTextureFromBlob(const unsigned char *blobData, int blobSize) {
                .mipmaps = 1};
 
   texture = LoadTextureFromImage(img);
+  atlasAdd(texture, pixelData);
   return texture;
 }
 
+// Adds the opaque pixels of a texture blob to sum (RGB), returns their count
+int sumBlobColor(const unsigned char *blobData, int blobSize, long sum[3]) {
+  if (blobSize != TILE_SIZE * TILE_SIZE * 4) {
+    return 0;
+  }
+
+  int count = 0;
+  for (int i = 0; i < TILE_SIZE * TILE_SIZE; i++) {
+    const unsigned char *pixel = &blobData[i * 4];
+    bool keyed = pixel[0] == transparencyKey.r &&
+                 pixel[1] == transparencyKey.g &&
+                 pixel[2] == transparencyKey.b && pixel[3] == transparencyKey.a;
+    if (!keyed && pixel[3] != 0) {
+      sum[0] += pixel[0];
+      sum[1] += pixel[1];
+      sum[2] += pixel[2];
+      count++;
+    }
+  }
+  return count;
+}
+
+Color averageColor(const long sum[3], int count) {
+  if (count == 0) {
+    return BLANK;
+  }
+  return (Color){(unsigned char)(sum[0] / count),
+                 (unsigned char)(sum[1] / count),
+                 (unsigned char)(sum[2] / count), 255};
+}
+
 sqlite3 *connectDatabase() {
   sqlite3 *db;
   if (sqlite3_open("test.db", &db) != SQLITE_OK) {
@@ -189,6 +224,7 @@ Tile *loadTiles(sqlite3 *db, Map *map) {
 
       // Populate tile with color array
       Texture2D tex[MAX_TILE_VARIANTS] = {0};
+      Color color[MAX_TILE_VARIANTS] = {0};
       int texCount = 0;
       char tileKeyStr[20];
       snprintf(tileKeyStr, sizeof(tileKeyStr), "%d", tileKey);
@@ -202,7 +238,10 @@ Tile *loadTiles(sqlite3 *db, Map *map) {
           int blobSize = sqlite3_column_bytes(texStmt, 0);
 
           Texture2D loadedTex = loadTextureFromBlob(blobData, blobSize);
+          long sum[3] = {0};
+          int count = sumBlobColor(blobData, blobSize, sum);
           tex[texCount] = loadedTex;
+          color[texCount] = averageColor(sum, count);
           texCount++;
         }
       } else {
@@ -219,6 +258,7 @@ Tile *loadTiles(sqlite3 *db, Map *map) {
 
       // Explicitly copy the textures
       memcpy(tileTypes[tileKey].tex, tex, sizeof(Texture2D) * texCount);
+      memcpy(tileTypes[tileKey].color, color, sizeof(Color) * texCount);
       printf("Tile %d created\n", tileKey);
     }
   } else {
@@ -263,6 +303,8 @@ Wall *loadWalls(sqlite3 *db, Map *map) {
       int wallTypeKey = sqlite3_column_int(wallStmt, 3);
 
       WallTexture wallTex[4];
+      long colorSum[3] = {0};
+      int colorCount = 0;
       char wallKeyStr[20];
       snprintf(wallKeyStr, sizeof(wallKeyStr), "%d", wallKey);
       const char *texQuery =
@@ -283,6 +325,7 @@ Wall *loadWalls(sqlite3 *db, Map *map) {
           int primaryWallQuadrantIndicator = sqlite3_column_int(texStmt, 3);
 
           Texture2D loadedTex = loadTextureFromBlob(blobData, blobSize);
+          colorCount += sumBlobColor(blobData, blobSize, colorSum);
 
           wallTex[quadrantKey - 1] = (WallTexture){
               .tex = loadedTex,
@@ -297,6 +340,7 @@ Wall *loadWalls(sqlite3 *db, Map *map) {
 
       wallTypes[wallKey] = (Wall){.wallKey = wallKey,
                                   .wallTex = {{{0}}},
+                                  .color = averageColor(colorSum, colorCount),
                                   .orientationKey = orientationKey,
                                   .wallGroupKey = wallGroupKey,
                                   .wallTypeKey = wallTypeKey};
@@ -328,6 +372,7 @@ void loadMap(sqlite3 *db, char *table, Map *map) {
     memset(map->walls, 0, sizeof(map->walls));
     memset(map->wallCount, 0, sizeof(map->wallCount));
     memset(map->edgeCount, 0, sizeof(map->edgeCount));
+    markMapDirty(map);
 
     while (sqlite3_step(mapStmt) == SQLITE_ROW) {
       int x = sqlite3_column_int(mapStmt, 0);
@@ -399,28 +444,35 @@ void saveMap(sqlite3 *db, char *table, Map *map) {
     // Begin transaction for faster inserts
     sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
 
-    for (int x = 0; x < GRID_SIZE; x++) {
-      for (int y = 0; y < GRID_SIZE; y++) {
-        // Save non-empty cells (tileKey != 0 or potentially wallKey != 0)
-        if (map->grid[x][y][0] != 0 || map->grid[x][y][2] != 0) {
-          int tileKey = map->grid[x][y][0];
-          int tileStyle = map->grid[x][y][1];
-          int wallKey = map->grid[x][y][2];
-          sqlite3_bind_int(insertStmt, 1, x);         // Bind x
-          sqlite3_bind_int(insertStmt, 2, y);         // Bind y
-          sqlite3_bind_int(insertStmt, 3, tileKey);   // Bind tile_key
-          sqlite3_bind_int(insertStmt, 4, tileStyle); // Bind tile_style
-          sqlite3_bind_int(insertStmt, 5, wallKey);   // Bind wall_key
-
-          if (sqlite3_step(insertStmt) != SQLITE_DONE) {
-            printf("Error inserting map data at (%d, %d): %s\n", x, y,
-                   sqlite3_errmsg(db));
+    // Walk the cell runs of each chunk, so empty chunks are skipped whole
+    for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+      for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+        RunIterator it;
+        CellRun run;
+        int x, startY;
+        runIterBegin(&it, map, cx, cy);
+        while (runIterNext(&it, &run, &x, &startY)) {
+          // Save non-empty cells (tileKey != 0 or potentially wallKey != 0)
+          if (run.tileKey == 0 && run.wallKey == 0) {
+            continue;
+          }
+          for (int y = startY; y < startY + run.length; y++) {
+            sqlite3_bind_int(insertStmt, 1, x);             // Bind x
+            sqlite3_bind_int(insertStmt, 2, y);             // Bind y
+            sqlite3_bind_int(insertStmt, 3, run.tileKey);   // Bind tile_key
+            sqlite3_bind_int(insertStmt, 4, run.tileStyle); // Bind tile_style
+            sqlite3_bind_int(insertStmt, 5, run.wallKey);   // Bind wall_key
+
+            if (sqlite3_step(insertStmt) != SQLITE_DONE) {
+              printf("Error inserting map data at (%d, %d): %s\n", x, y,
+                     sqlite3_errmsg(db));
+            }
+            sqlite3_reset(insertStmt); // Reset for next iteration
+
+            // Bindings automatically cleared by reset in recent versions,
+            // but explicit clear is safe.
+            sqlite3_clear_bindings(insertStmt);
           }
-          sqlite3_reset(insertStmt); // Reset for next iteration
-
-          // Bindings automatically cleared by reset in recent versions, but
-          // explicit clear is safe.
-          sqlite3_clear_bindings(insertStmt);
         }
       }
     }
@@ -433,25 +485,233 @@ void saveMap(sqlite3 *db, char *table, Map *map) {
   sqlite3_finalize(insertStmt); // Finalize insert statement if it was prepared
 }
 
+// Reads a map table as rows of x, y, tile key, tile style and wall key.
+// Returns the row count; a missing table has no rows.
+int loadMapRows(sqlite3 *db, const char *table, int (**rows)[5]) {
+  char query[256];
+  snprintf(query, sizeof(query),
+           "SELECT x, y, tile_key, tile_style, wall_key FROM %s;", table);
+
+  *rows = NULL;
+  sqlite3_stmt *stmt;
+  if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK) {
+    return 0;
+  }
+
+  int count = 0;
+  int capacity = 0;
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 1024;
+      int (*grown)[5] = (int (*)[5])realloc(*rows, capacity * sizeof(int[5]));
+      if (grown == NULL) {
+        printf("Memory allocation failed\n");
+        break;
+      }
+      *rows = grown;
+    }
+    for (int i = 0; i < 5; i++) {
+      (*rows)[count][i] = sqlite3_column_int(stmt, i);
+    }
+    count++;
+  }
+  sqlite3_finalize(stmt);
+  return count;
+}
+
+// Replaces a map table with the given rows in one transaction
+void saveMapRows(sqlite3 *db, const char *table, int rows[][5], int rowCount) {
+  char createQuery[256];
+  char insertQuery[256];
+  snprintf(createQuery, sizeof(createQuery),
+           "CREATE TABLE %s("
+           "x INTEGER NOT NULL,"
+           "y INTEGER NOT NULL,"
+           "tile_key INTEGER NOT NULL,"
+           "tile_style INTEGER NOT NULL,"
+           "wall_key INTEGER NOT NULL);",
+           table);
+  snprintf(insertQuery, sizeof(insertQuery),
+           "INSERT INTO %s (x, y, tile_key, tile_style, wall_key) VALUES (?, "
+           "?, ?, ?, ?);",
+           table);
+
+  dropMapTable(db, table);
+  if (sqlite3_exec(db, createQuery, NULL, NULL, NULL) != SQLITE_OK) {
+    printf("Error creating map table %s: %s\n", table, sqlite3_errmsg(db));
+    return;
+  }
+
+  sqlite3_stmt *insertStmt;
+  if (sqlite3_prepare_v2(db, insertQuery, -1, &insertStmt, NULL) !=
+      SQLITE_OK) {
+    printf("Error preparing SQL query: %s\n", sqlite3_errmsg(db));
+    return;
+  }
+  sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+  for (int i = 0; i < rowCount; i++) {
+    for (int j = 0; j < 5; j++) {
+      sqlite3_bind_int(insertStmt, j + 1, rows[i][j]);
+    }
+    if (sqlite3_step(insertStmt) != SQLITE_DONE) {
+      printf("Error inserting map data at (%d, %d): %s\n", rows[i][0],
+             rows[i][1], sqlite3_errmsg(db));
+    }
+    sqlite3_reset(insertStmt);
+  }
+  sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
+  sqlite3_finalize(insertStmt);
+  printf("Map table \"%s\" successfully saved.\n", table);
+}
+
+void dropMapTable(sqlite3 *db, const char *table) {
+  char dropQuery[256];
+  snprintf(dropQuery, sizeof(dropQuery), "DROP TABLE IF EXISTS %s;", table);
+  sqlite3_exec(db, dropQuery, NULL, NULL, NULL);
+}
+
+// Reads a layer table in layer order. Returns the layer count; a missing
+// table has no layers.
+int loadLayerInfo(sqlite3 *db, const char *table, LayerInfo layers[],
+                  int maxCount) {
+  char query[256];
+  snprintf(query, sizeof(query),
+           "SELECT name, visible, locked FROM %s ORDER BY layer_index;",
+           table);
+
+  sqlite3_stmt *stmt;
+  if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK) {
+    return 0;
+  }
+
+  int count = 0;
+  while (count < maxCount && sqlite3_step(stmt) == SQLITE_ROW) {
+    const unsigned char *name = sqlite3_column_text(stmt, 0);
+    snprintf(layers[count].name, LAYER_NAME_LENGTH, "%s",
+             name ? (const char *)name : "");
+    layers[count].visible = sqlite3_column_int(stmt, 1);
+    layers[count].locked = sqlite3_column_int(stmt, 2);
+    count++;
+  }
+  sqlite3_finalize(stmt);
+  return count;
+}
+
+// Replaces a layer table with the given layers in one transaction
+void saveLayerInfo(sqlite3 *db, const char *table, const LayerInfo layers[],
+                   int count) {
+  char createQuery[256];
+  char insertQuery[256];
+  snprintf(createQuery, sizeof(createQuery),
+           "CREATE TABLE %s("
+           "layer_index INTEGER NOT NULL,"
+           "name TEXT NOT NULL,"
+           "visible INTEGER NOT NULL,"
+           "locked INTEGER NOT NULL);",
+           table);
+  snprintf(insertQuery, sizeof(insertQuery),
+           "INSERT INTO %s (layer_index, name, visible, locked) VALUES (?, ?, "
+           "?, ?);",
+           table);
+
+  dropMapTable(db, table);
+  if (sqlite3_exec(db, createQuery, NULL, NULL, NULL) != SQLITE_OK) {
+    printf("Error creating layer table %s: %s\n", table, sqlite3_errmsg(db));
+    return;
+  }
+
+  sqlite3_stmt *insertStmt;
+  if (sqlite3_prepare_v2(db, insertQuery, -1, &insertStmt, NULL) !=
+      SQLITE_OK) {
+    printf("Error preparing SQL query: %s\n", sqlite3_errmsg(db));
+    return;
+  }
+  sqlite3_exec(db, "BEGIN TRANSACTION;", NULL, NULL, NULL);
+  for (int i = 0; i < count; i++) {
+    sqlite3_bind_int(insertStmt, 1, i);
+    sqlite3_bind_text(insertStmt, 2, layers[i].name, -1, SQLITE_STATIC);
+    sqlite3_bind_int(insertStmt, 3, layers[i].visible);
+    sqlite3_bind_int(insertStmt, 4, layers[i].locked);
+    if (sqlite3_step(insertStmt) != SQLITE_DONE) {
+      printf("Error inserting layer %s: %s\n", layers[i].name,
+             sqlite3_errmsg(db));
+    }
+    sqlite3_reset(insertStmt);
+  }
+  sqlite3_exec(db, "COMMIT;", NULL, NULL, NULL);
+  sqlite3_finalize(insertStmt);
+}
+
+// Reads one value from a map's settings table. Returns fallback when the
+// table or the key is missing.
+long long loadMapSetting(sqlite3 *db, const char *table, const char *key,
+                         long long fallback) {
+  char query[256];
+  snprintf(query, sizeof(query), "SELECT value FROM %s WHERE key = ?;",
+           table);
+
+  sqlite3_stmt *stmt;
+  if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK) {
+    return fallback;
+  }
+  sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+  long long value = fallback;
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    value = sqlite3_column_int64(stmt, 0);
+  }
+  sqlite3_finalize(stmt);
+  return value;
+}
+
+// Writes one value to a map's settings table, creating the table if needed
+void saveMapSetting(sqlite3 *db, const char *table, const char *key,
+                    long long value) {
+  char createQuery[256];
+  char insertQuery[256];
+  snprintf(createQuery, sizeof(createQuery),
+           "CREATE TABLE IF NOT EXISTS %s("
+           "key TEXT PRIMARY KEY,"
+           "value INTEGER NOT NULL);",
+           table);
+  snprintf(insertQuery, sizeof(insertQuery),
+           "INSERT OR REPLACE INTO %s (key, value) VALUES (?, ?);", table);
+
+  if (sqlite3_exec(db, createQuery, NULL, NULL, NULL) != SQLITE_OK) {
+    printf("Error creating settings table %s: %s\n", table,
+           sqlite3_errmsg(db));
+    return;
+  }
+
+  sqlite3_stmt *insertStmt;
+  if (sqlite3_prepare_v2(db, insertQuery, -1, &insertStmt, NULL) !=
+      SQLITE_OK) {
+    printf("Error preparing SQL query: %s\n", sqlite3_errmsg(db));
+    return;
+  }
+  sqlite3_bind_text(insertStmt, 1, key, -1, SQLITE_STATIC);
+  sqlite3_bind_int64(insertStmt, 2, value);
+  if (sqlite3_step(insertStmt) != SQLITE_DONE) {
+    printf("Error saving setting %s: %s\n", key, sqlite3_errmsg(db));
+  }
+  sqlite3_finalize(insertStmt);
+}
+
 static void dumpWallOrientMap(const WallOrientMap *map) {
-  fprintf(stderr, "DUMP: capacity=%d size=%d\n", map->capacity, map->size);
-  for (int i = 0; i < map->capacity; ++i) {
-    Entry *e = map->buckets[i];
-    if (!e)
-      continue;
-    fprintf(stderr, "  bucket %d:\n", i);
-    while (e) {
-      fprintf(stderr, "    src=%d orient=%d tgt=%d\n", e->sourceWallKey,
-              e->orientationKey, e->targetWallKey);
-      e = e->next;
+  fprintf(stderr, "DUMP: sources=%d size=%d\n", map->sourceCount, map->size);
+  for (int src = 0; src < map->sourceCount; ++src) {
+    const int *row = &map->targets[src * WALL_ORIENTATION_COUNT];
+    fprintf(stderr, "  src=%d:", src);
+    for (int orient = 0; orient < WALL_ORIENTATION_COUNT; ++orient) {
+      fprintf(stderr, " %d", row[orient]);
     }
+    fprintf(stderr, "\n");
   }
 }
 
 WallOrientMap *loadWallOrientationsMap(sqlite3 *db) {
 
   const char *count_qry =
-      "SELECT COUNT(*) "
+      "SELECT COUNT(*), MAX(w_source.wall_key) "
       "FROM wall AS w_source "
       "JOIN wall AS w_target "
       "ON w_source.wall_group_key = w_target.wall_group_key "
@@ -459,10 +719,12 @@ WallOrientMap *loadWallOrientationsMap(sqlite3 *db) {
 
   sqlite3_stmt *count_stmt;
   int count = -1;
+  int max_source_key = -1;
 
   if (sqlite3_prepare_v2(db, count_qry, -1, &count_stmt, NULL) == SQLITE_OK) {
     if (sqlite3_step(count_stmt) == SQLITE_ROW) {
       count = sqlite3_column_int(count_stmt, 0);
+      max_source_key = sqlite3_column_int(count_stmt, 1);
       DBG("DEBUG: want to load %d entries\n", count);
     } else {
       fprintf(stderr, "Error stepping count query: %s\n", sqlite3_errmsg(db));
@@ -487,74 +749,66 @@ WallOrientMap *loadWallOrientationsMap(sqlite3 *db) {
     return NULL;
   }
 
-  if (count <= 0)
+  if (count <= 0 || max_source_key < 0) {
+    sqlite3_finalize(stmt);
     return NULL;
+  }
   WallOrientMap *map = (WallOrientMap *)malloc(sizeof(WallOrientMap));
-  if (!map)
+  if (!map) {
+    sqlite3_finalize(stmt);
     return NULL;
+  }
 
-  int capacity = (int)(((double)count / 0.75) + 1.0);
-  map->capacity = capacity;
+  // One row per source key; unset pairs resolve to the source key itself
+  map->sourceCount = max_source_key + 1;
   map->size = 0;
-  map->buckets = (Entry **)calloc(capacity, sizeof(Entry *));
-  if (!map->buckets) {
+  map->targets =
+      (int *)malloc(map->sourceCount * WALL_ORIENTATION_COUNT * sizeof(int));
+  if (!map->targets) {
     free(map);
+    sqlite3_finalize(stmt);
     return NULL;
   }
+  for (int src = 0; src < map->sourceCount; ++src) {
+    for (int orient = 0; orient < WALL_ORIENTATION_COUNT; ++orient) {
+      map->targets[src * WALL_ORIENTATION_COUNT + orient] = src;
+    }
+  }
 
   int num_entries = 0;
-  bool error_occurred = false;
   while (sqlite3_step(stmt) == SQLITE_ROW) {
     int source_key = sqlite3_column_int(stmt, 0);
     int orientation_key = sqlite3_column_int(stmt, 1);
     int target_key = sqlite3_column_int(stmt, 2);
-    unsigned int hash_val =
-        ((unsigned int)source_key ^ ((unsigned int)orientation_key << 1)) %
-        capacity;
-
-    DBG("DEBUG row %d: source=%d orient=%d target=%d → bucket %u\n",
-        num_entries, source_key, orientation_key, target_key, hash_val);
-
-    Entry *newEntry = (Entry *)malloc(sizeof(Entry));
-    if (!newEntry) {
-      perror("Failed to allocate memory for new entry");
-      error_occurred = true;
-      break;
-    }
-    newEntry->sourceWallKey = source_key;
-    newEntry->orientationKey = orientation_key;
-    newEntry->targetWallKey = target_key;
 
-    newEntry->next = map->buckets[hash_val];
-    map->buckets[hash_val] = newEntry;
+    DBG("DEBUG row %d: source=%d orient=%d target=%d\n", num_entries,
+        source_key, orientation_key, target_key);
+
+    if (source_key < 0 || orientation_key < 0 ||
+        orientation_key >= WALL_ORIENTATION_COUNT) {
+      fprintf(stderr, "Skipping wall orientation %d of wall %d\n",
+              orientation_key, source_key);
+      continue;
+    }
+    map->targets[source_key * WALL_ORIENTATION_COUNT + orientation_key] =
+        target_key;
     map->size++;
 
     num_entries++;
   }
 
   int step_result = sqlite3_errcode(db);
-  if (error_occurred ||
-      (step_result != SQLITE_DONE && step_result != SQLITE_OK)) {
-    if (!error_occurred) {
-      fprintf(stderr, "Error stepping through load query results: %s\n",
-              sqlite3_errmsg(db));
-    }
-    for (int i = 0; i < map->capacity; ++i) {
-      Entry *current = map->buckets[i];
-      while (current != NULL) {
-        Entry *temp = current;
-        current = current->next;
-        free(temp);
-      }
-    }
-    free(map->buckets);
+  if (step_result != SQLITE_DONE && step_result != SQLITE_OK) {
+    fprintf(stderr, "Error stepping through load query results: %s\n",
+            sqlite3_errmsg(db));
+    free(map->targets);
     free(map);
     sqlite3_finalize(stmt);
     return NULL;
   }
 
-  printf("Loaded %d wall orientation entries into hash map with capacity %d.\n",
-         num_entries, map->capacity);
+  printf("Loaded %d wall orientation entries for %d source keys.\n",
+         num_entries, map->sourceCount);
 
   DBG("Finished stepping through rows, total inserted=%d\n", num_entries);
   dumpWallOrientMap(map);
@@ -4,8 +4,14 @@
 
 #define MAX_TILE_VARIANTS 20
 #define MAX_WALL_VARIANTS 4
+#define WALL_ORIENTATION_COUNT 5 // WALL_STYLE_NONE to WALL_STYLE_CORNER
 #define TILE_SIZE 32
-#define GRID_SIZE 16
+#ifndef GRID_SIZE
+#define GRID_SIZE 16 // override at build time, e.g. -DGRID_SIZE=256
+#endif
+#define CHUNK_SIZE 16 // cells per chunk side for incremental updates
+#define CHUNK_COUNT ((GRID_SIZE + CHUNK_SIZE - 1) / CHUNK_SIZE)
+#define LAYER_NAME_LENGTH 32
 
 #include <raylib.h>
 #include <sqlite3.h>
@@ -19,6 +25,7 @@ typedef struct { // ground tiles
   int tileKey;
   int walkable;
   Texture2D tex[MAX_TILE_VARIANTS];
+  Color color[MAX_TILE_VARIANTS]; // average colour of each variant
   int texCount;
   int edgePriority;
   int edgeIndicator;
@@ -26,6 +33,9 @@ typedef struct { // ground tiles
 
 typedef struct {
   const char *name;
+  // z of the level held in grid; 0 is the ground, other levels are hollow
+  // where there is no tile
+  int level;
   // x, y, 1: tileKey, 2: tileStyle 3: wallKey
   int grid[GRID_SIZE][GRID_SIZE][3];
   // 12 possible types of ground edges
@@ -34,6 +44,8 @@ typedef struct {
   Texture2D walls[GRID_SIZE][GRID_SIZE][3];
   int edgeCount[GRID_SIZE][GRID_SIZE];
   int wallCount[GRID_SIZE][GRID_SIZE];
+  // bit per ChunkDirtyFlag, cleared by the consumer that owns the bit
+  unsigned short chunkDirty[CHUNK_COUNT][CHUNK_COUNT];
   int maxTileKey;
   int maxWallKey;
   int countEdges;
@@ -49,24 +61,28 @@ typedef struct {
 typedef struct {
   int wallKey;
   WallTexture wallTex[4];
+  Color color; // average colour of the quadrant textures
   int wallGroupKey;
   int wallTypeKey;
   int orientationKey;
 } Wall;
 
-typedef struct Entry {
-  int sourceWallKey;
-  int orientationKey;
-  int targetWallKey;
-  struct Entry *next;
-} Entry;
-
+// Wall key of each source key's group per orientation, one row of
+// WALL_ORIENTATION_COUNT targets per source key. Missing pairs map a key to
+// itself.
 typedef struct {
-  int capacity;
-  int size;
-  Entry **buckets;
+  int sourceCount; // rows, one past the largest source key
+  int size;        // pairs loaded from the database
+  int *targets;
 } WallOrientMap;
 
+// Name and flags of one map layer as saved in a map's layer table
+typedef struct {
+  char name[LAYER_NAME_LENGTH];
+  int visible;
+  int locked;
+} LayerInfo;
+
 // Function prototypes
 sqlite3 *connectDatabase(void);
 
@@ -80,6 +96,24 @@ void loadMap(sqlite3 *db, char *table, Map *map);
 
 void saveMap(sqlite3 *db, char *table, Map *map);
 
+int loadMapRows(sqlite3 *db, const char *table, int (**rows)[5]);
+
+void saveMapRows(sqlite3 *db, const char *table, int rows[][5], int rowCount);
+
+void dropMapTable(sqlite3 *db, const char *table);
+
+int loadLayerInfo(sqlite3 *db, const char *table, LayerInfo layers[],
+                  int maxCount);
+
+void saveLayerInfo(sqlite3 *db, const char *table, const LayerInfo layers[],
+                   int count);
+
+long long loadMapSetting(sqlite3 *db, const char *table, const char *key,
+                         long long fallback);
+
+void saveMapSetting(sqlite3 *db, const char *table, const char *key,
+                    long long value);
+
 WallOrientMap *loadWallOrientationsMap(sqlite3 *db);
 
 #endif // DATABASE_H
@@ -1,18 +1,36 @@
 // draw.c
 
 #include "draw.h"
+#include "autotile.h"
+#include "chunk.h"
 #include "database.h"
 #include "edge.h"
 #include "grid.h"
+#include "keyindex.h"
+#include "layer.h"
+#include "level.h"
+#include "lod.h"
 #include "math.h"
+#include "mesh.h"
+#include "profile.h"
+#include "regiontree.h"
+#include "tilestyle.h"
+#include "trace.h"
 #include "wall.h"
 #include <raylib.h>
 #include <sqlite3.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 int abs(int x) { return x < 0 ? -x : x; }
 
+// Submit a sprite and record it for the frame profiler
+static void drawSprite(Texture2D texture, Vector2 pos) {
+  DrawTexture(texture, pos.x, pos.y, WHITE);
+  profileCountDraw(texture);
+}
+
 int getRandTileStyle(int tileKey, Tile *tileTypes) {
   int texCount = tileTypes[tileKey].texCount;
   if (texCount == 0) {
@@ -147,119 +165,371 @@ void calculatePath(WorldCoords coords, Array2DPtr pathData,
   }
 }
 
-// Draw update functions
-void drawPreview(Map *currentMap, DrawingState *drawState, Tile tileTypes[],
-                 Edge edgeTypes[], Wall wallTypes[], WindowState windowState,
-                 Camera2D camera) {
-
-  // Make temp map from drawn tiles and current map
-  Map tempMap = *currentMap;
-
-  // Update temp map with drawn tiles
-  for (int i = 0; i < drawState->drawnTilesCount; i++) {
-    int x = drawState->drawnTiles[i][0];
-    int y = drawState->drawnTiles[i][1];
-
-    // Populate temp map
-    switch (drawState->drawType) {
-
-    case DRAW_TILE:
-      tempMap.grid[x][y][0] = drawState->activeTileKey;
-      tempMap.grid[x][y][1] = drawState->drawnTiles[i][2];
-      break;
-    case DRAW_WALL:
-      if (drawState->drawMode == MODE_PAINTER) {
-        tempMap.grid[x][y][2] = drawState->activeWallKey;
-      } else {
-        tempMap.grid[x][y][2] = drawState->drawnTiles[i][2];
-      }
-      break;
-    }
-  }
+// Preview scratch: what the in-place preview overwrites in one cell
+typedef struct {
+  Texture2D edges[12];
+  Texture2D walls[3];
+  int edgeCount;
+  int wallCount;
+} PreviewCell;
 
-  // Get neighbors to placement
-  int visitedTiles[GRID_SIZE * GRID_SIZE][2];
-  int visitedCount = 0;
+// Writes drawn cell i to the map
+static void setDrawnCell(Map *map, DrawingState *drawState, int i) {
+  int x = drawState->drawnTiles[i][0];
+  int y = drawState->drawnTiles[i][1];
 
   switch (drawState->drawType) {
   case DRAW_TILE:
-    calculateEdgeGrid(drawState, visitedTiles, &visitedCount);
-    computeEdges(visitedTiles, visitedCount, &tempMap, tileTypes, edgeTypes);
+    map->grid[x][y][0] = drawState->activeTileKey;
+    map->grid[x][y][1] = drawState->drawnTiles[i][2];
     break;
   case DRAW_WALL:
-    calculateWallGrid(drawState, visitedTiles, &visitedCount);
-    computeWalls(visitedTiles, visitedCount, &tempMap, wallTypes);
+    map->grid[x][y][2] = drawState->drawnTiles[i][2];
     break;
   }
-
-  drawExistingMap(&tempMap, tileTypes, wallTypes, camera, windowState.width,
-                  windowState.height);
 }
 
-void applyTiles(Map *map, DrawingState *drawState) {
+// Bounding rectangle of the drawn cells; false when nothing is drawn
+static bool getDrawnBounds(DrawingState *drawState, WorldCoords *bounds) {
+  if (drawState->drawnTilesCount == 0) {
+    return false;
+  }
 
-  for (int i = 0; i < drawState->drawnTilesCount; i++) {
+  *bounds = (WorldCoords){drawState->drawnTiles[0][0],
+                          drawState->drawnTiles[0][1],
+                          drawState->drawnTiles[0][0],
+                          drawState->drawnTiles[0][1]};
+  for (int i = 1; i < drawState->drawnTilesCount; i++) {
     int x = drawState->drawnTiles[i][0];
     int y = drawState->drawnTiles[i][1];
-
-    switch (drawState->drawType) {
-    case DRAW_TILE:
-      map->grid[x][y][0] = drawState->activeTileKey;
-      map->grid[x][y][1] = drawState->drawnTiles[i][2];
-      break;
-    case DRAW_WALL:
-      if (drawState->drawMode == MODE_PAINTER) {
-        map->grid[x][y][2] = drawState->activeWallKey;
-      } else {
-        map->grid[x][y][2] = drawState->drawnTiles[i][2];
-      }
-      break;
-    }
+    bounds->startX = x < bounds->startX ? x : bounds->startX;
+    bounds->startY = y < bounds->startY ? y : bounds->startY;
+    bounds->endX = x > bounds->endX ? x : bounds->endX;
+    bounds->endY = y > bounds->endY ? y : bounds->endY;
   }
+  return true;
 }
 
-void drawExistingMap(Map *map, Tile tileTypes[], Wall wallTypes[],
-                     Camera2D camera, int screenWidth, int screenHeight) {
+// Sprite path of drawExistingMap for the cells within bounds
+static void drawMapRegion(Map *map, Tile tileTypes[], Wall wallTypes[],
+                          WorldCoords bounds, LodLevel level) {
+  // The map's own grid is layer 0, which can be hidden
+  if (!layerStack.layers[0].info.visible) {
+    layerDrawRegion(map, tileTypes, bounds);
+    return;
+  }
 
-  // Get the visible bounds of the grid
-  WorldCoords bounds = GetVisibleGridBounds(camera, screenWidth, screenHeight);
+  // Tile key of visible chunks whose cells and their neighbours share one
+  // key and hold no walls, or REGION_MIXED. Such chunks have no edges or
+  // wall quadrants, and hollow ones have nothing to draw.
+  static int bareKeys[CHUNK_COUNT][CHUNK_COUNT];
+  regionTreeUpdate(map);
+  for (int cx = bounds.startX / CHUNK_SIZE; cx <= bounds.endX / CHUNK_SIZE;
+       cx++) {
+    for (int cy = bounds.startY / CHUNK_SIZE;
+         cy <= bounds.endY / CHUNK_SIZE; cy++) {
+      WorldCoords halo = {cx * CHUNK_SIZE - 1, cy * CHUNK_SIZE - 1,
+                          (cx + 1) * CHUNK_SIZE, (cy + 1) * CHUNK_SIZE};
+      bareKeys[cx][cy] = regionUniformKey(map, DRAW_WALL, halo) == 0
+                             ? regionUniformKey(map, DRAW_TILE, halo)
+                             : REGION_MIXED;
+    }
+  }
 
-  // Only draw tiles within the visible bounds
+  bool hollowFloor = map->level != 0;
   for (int x = bounds.startX; x <= bounds.endX; x++) {
     for (int y = bounds.startY; y <= bounds.endY; y++) {
+      int bareKey = bareKeys[x / CHUNK_SIZE][y / CHUNK_SIZE];
+      if (hollowFloor && bareKey == 0) {
+        // Skip to the chunk's last cell
+        y = (y / CHUNK_SIZE + 1) * CHUNK_SIZE - 1;
+        continue;
+      }
+
       int tileKey = map->grid[x][y][0];
-      int tileStyle = map->grid[x][y][1];
+      int tileStyle =
+          resolveTileStyle(tileTypes, tileKey, map->grid[x][y][1], x, y);
       int wallKey = map->grid[x][y][2];
 
-      // Draw the ground tile for each grid cell
+      // Draw the ground tile for each grid cell; off the ground, cells
+      // without a tile are hollow
       Texture2D tileTexture = tileTypes[tileKey].tex[tileStyle];
       Vector2 pos = {x * TILE_SIZE, y * TILE_SIZE};
-      DrawTexture(tileTexture, pos.x, pos.y, WHITE);
+      if (!hollowFloor || tileKey != 0) {
+        drawSprite(tileTexture, pos);
+      }
+
+      if (level == LOD_SIMPLE || bareKey >= 0) {
+        if (wallKey != 0) {
+          drawSprite(wallTypes[wallKey].wallTex[3].tex, pos);
+        }
+        continue;
+      }
 
       // Draw the edge for each grid cell
       int edgeCount = map->edgeCount[x][y];
       for (int i = 0; i < edgeCount; i++) {
         Texture2D edgeTexture = map->edges[x][y][i];
-        DrawTexture(edgeTexture, pos.x, pos.y, WHITE);
+        drawSprite(edgeTexture, pos);
       }
 
       if (wallKey != 0) {
         Texture2D wallTexture = wallTypes[wallKey].wallTex[3].tex;
-        DrawTexture(wallTexture, pos.x, pos.y, WHITE);
+        drawSprite(wallTexture, pos);
       }
 
       int wallCount = map->wallCount[x][y];
       for (int j = 0; j < wallCount; j++) {
         Texture2D quadrantTexture = map->walls[x][y][j];
-        DrawTexture(quadrantTexture, pos.x, pos.y, WHITE);
+        drawSprite(quadrantTexture, pos);
       }
     }
   }
+
+  layerDrawRegion(map, tileTypes, bounds);
+}
+
+// The drawn cells are written to the map in place and restored afterwards;
+// only the visible part of their dirty rectangle is recomputed and drawn over
+// the cached map.
+static void drawPreviewCells(Map *currentMap, DrawingState *drawState,
+                             Tile tileTypes[], Edge edgeTypes[],
+                             Wall wallTypes[], WindowState windowState,
+                             Camera2D camera, LodLevel level) {
+  // Cells whose edges (all neighbours) or wall quadrants (west and north
+  // neighbours) depend on the drawn cells, clipped to the view
+  WorldCoords region;
+  if (!getDrawnBounds(drawState, &region)) {
+    return;
+  }
+  region.startX--;
+  region.startY--;
+  if (drawState->drawType == DRAW_TILE) {
+    region.endX++;
+    region.endY++;
+  }
+  WorldCoords visible =
+      GetVisibleGridBounds(camera, windowState.width, windowState.height);
+  region.startX =
+      region.startX > visible.startX ? region.startX : visible.startX;
+  region.startY =
+      region.startY > visible.startY ? region.startY : visible.startY;
+  region.endX = region.endX < visible.endX ? region.endX : visible.endX;
+  region.endY = region.endY < visible.endY ? region.endY : visible.endY;
+  if (region.startX > region.endX || region.startY > region.endY) {
+    return;
+  }
+
+  // The vertex buffer renderer always draws full detail
+  if (meshCanDraw(currentMap)) {
+    level = LOD_FULL;
+  }
+
+  int regionHeight = region.endY - region.startY + 1;
+  int regionCount = (region.endX - region.startX + 1) * regionHeight;
+  int (*savedGrid)[3] =
+      (int (*)[3])malloc(drawState->drawnTilesCount * sizeof(int[3]));
+  PreviewCell *savedCells =
+      (PreviewCell *)malloc(regionCount * sizeof(PreviewCell));
+  if (savedGrid == NULL || savedCells == NULL) {
+    printf("Memory allocation failed\n");
+    free(savedGrid);
+    free(savedCells);
+    return;
+  }
+
+  // Recomputing marks chunks dirty; the preview must not invalidate the
+  // cached renderers, so the dirty bits are restored with the cells
+  static unsigned short savedDirty[CHUNK_COUNT][CHUNK_COUNT];
+  memcpy(savedDirty, currentMap->chunkDirty, sizeof(savedDirty));
+
+  // Apply the drawn cells; the map's summaries must see them
+  for (int i = 0; i < drawState->drawnTilesCount; i++) {
+    int x = drawState->drawnTiles[i][0];
+    int y = drawState->drawnTiles[i][1];
+    memcpy(savedGrid[i], currentMap->grid[x][y], sizeof(int[3]));
+    setDrawnCell(currentMap, drawState, i);
+    setChunkDirty(currentMap, x / CHUNK_SIZE, y / CHUNK_SIZE,
+                  CHUNK_DIRTY_RUNS | CHUNK_DIRTY_REGION);
+  }
+
+  // Recompute the region one column at a time
+  if (level == LOD_FULL) {
+    profileBeginStage(STAGE_PREVIEW_EDGES);
+    int column[GRID_SIZE][2];
+    for (int x = region.startX; x <= region.endX; x++) {
+      for (int y = region.startY; y <= region.endY; y++) {
+        PreviewCell *saved = &savedCells[(x - region.startX) * regionHeight +
+                                         (y - region.startY)];
+        memcpy(saved->edges, currentMap->edges[x][y], sizeof(saved->edges));
+        memcpy(saved->walls, currentMap->walls[x][y], sizeof(saved->walls));
+        saved->edgeCount = currentMap->edgeCount[x][y];
+        saved->wallCount = currentMap->wallCount[x][y];
+        column[y - region.startY][0] = x;
+        column[y - region.startY][1] = y;
+      }
+      switch (drawState->drawType) {
+      case DRAW_TILE:
+        computeEdges(column, regionHeight, currentMap, tileTypes, edgeTypes);
+        break;
+      case DRAW_WALL:
+        computeWalls(column, regionHeight, currentMap, wallTypes);
+        break;
+      }
+    }
+    profileEndStage(STAGE_PREVIEW_EDGES);
+  }
+
+  profileBeginStage(STAGE_DRAW_MAP);
+  drawMapRegion(currentMap, tileTypes, wallTypes, region, level);
+  profileEndStage(STAGE_DRAW_MAP);
+
+  // Restore the map
+  if (level == LOD_FULL) {
+    for (int x = region.startX; x <= region.endX; x++) {
+      for (int y = region.startY; y <= region.endY; y++) {
+        PreviewCell *saved = &savedCells[(x - region.startX) * regionHeight +
+                                         (y - region.startY)];
+        memcpy(currentMap->edges[x][y], saved->edges, sizeof(saved->edges));
+        memcpy(currentMap->walls[x][y], saved->walls, sizeof(saved->walls));
+        currentMap->edgeCount[x][y] = saved->edgeCount;
+        currentMap->wallCount[x][y] = saved->wallCount;
+      }
+    }
+  }
+  for (int i = 0; i < drawState->drawnTilesCount; i++) {
+    int x = drawState->drawnTiles[i][0];
+    int y = drawState->drawnTiles[i][1];
+    memcpy(currentMap->grid[x][y], savedGrid[i], sizeof(int[3]));
+  }
+  memcpy(currentMap->chunkDirty, savedDirty, sizeof(savedDirty));
+
+  // Summaries refreshed during the preview hold the drawn cells
+  for (int i = 0; i < drawState->drawnTilesCount; i++) {
+    setChunkDirty(currentMap, drawState->drawnTiles[i][0] / CHUNK_SIZE,
+                  drawState->drawnTiles[i][1] / CHUNK_SIZE,
+                  CHUNK_DIRTY_RUNS | CHUNK_DIRTY_REGION);
+  }
+
+  free(savedGrid);
+  free(savedCells);
+}
+
+// Draw update functions
+// Draws the map with the drawn cells applied
+void drawPreview(Map *currentMap, DrawingState *drawState, Tile tileTypes[],
+                 Edge edgeTypes[], Wall wallTypes[], WindowState windowState,
+                 Camera2D camera) {
+
+  drawExistingMap(currentMap, tileTypes, wallTypes, camera, windowState.width,
+                  windowState.height);
+
+  // Zoomed far out: a colour per drawn cell over the map's colour texture
+  LodLevel level = lodLevel(camera.zoom);
+  if (level == LOD_COLOR) {
+    for (int i = 0; i < drawState->drawnTilesCount; i++) {
+      int x = drawState->drawnTiles[i][0];
+      int y = drawState->drawnTiles[i][1];
+      int style = resolveTileStyle(tileTypes, drawState->activeTileKey,
+                                   drawState->drawnTiles[i][2], x, y);
+      Color color = drawState->drawType == DRAW_TILE
+                        ? tileTypes[drawState->activeTileKey].color[style]
+                        : wallTypes[drawState->activeWallKey].color;
+      DrawRectangle(x * TILE_SIZE, y * TILE_SIZE, TILE_SIZE, TILE_SIZE, color);
+    }
+    return;
+  }
+
+  // Named layers have no edges, so their drawn tiles are drawn as they are
+  if (layerEditTarget(drawState) != 0) {
+    for (int i = 0; i < drawState->drawnTilesCount; i++) {
+      int x = drawState->drawnTiles[i][0];
+      int y = drawState->drawnTiles[i][1];
+      int style = resolveTileStyle(tileTypes, drawState->activeTileKey,
+                                   drawState->drawnTiles[i][2], x, y);
+      Vector2 pos = {x * TILE_SIZE, y * TILE_SIZE};
+      drawSprite(tileTypes[drawState->activeTileKey].tex[style], pos);
+    }
+    return;
+  }
+
+  // Walls whose links change are re-resolved for this frame only
+  int drawnCount = drawState->drawnTilesCount;
+  autotileDrawnWalls(currentMap, drawState);
+  drawPreviewCells(currentMap, drawState, tileTypes, edgeTypes, wallTypes,
+                   windowState, camera, level);
+  drawState->drawnTilesCount = drawnCount;
+}
+
+void applyTiles(Map *map, DrawingState *drawState) {
+  traceBegin("applyTiles");
+
+  int layer = layerEditTarget(drawState);
+  if (layer != 0) {
+    for (int i = 0; i < drawState->drawnTilesCount; i++) {
+      layerSetCell(map, layer, drawState->drawnTiles[i][0],
+                   drawState->drawnTiles[i][1], drawState->activeTileKey,
+                   drawState->drawnTiles[i][2]);
+    }
+    traceEnd("applyTiles");
+    return;
+  }
+
+  for (int i = 0; i < drawState->drawnTilesCount; i++) {
+    int x = drawState->drawnTiles[i][0];
+    int y = drawState->drawnTiles[i][1];
+    int plane = drawState->drawType == DRAW_TILE ? 0 : 2;
+    int oldKey = map->grid[x][y][plane];
+    markCellDirty(map, x, y);
+    setDrawnCell(map, drawState, i);
+    keyIndexUpdate(map, drawState->drawType, x, y, oldKey,
+                   map->grid[x][y][plane]);
+  }
+  traceEnd("applyTiles");
+}
+
+void drawExistingMap(Map *map, Tile tileTypes[], Wall wallTypes[],
+                     Camera2D camera, int screenWidth, int screenHeight) {
+
+  profileBeginStage(STAGE_DRAW_MAP);
+
+  // Get the visible bounds of the grid
+  WorldCoords bounds = GetVisibleGridBounds(camera, screenWidth, screenHeight);
+  // A view entirely off the grid leaves inverted bounds
+  int visibleWidth = bounds.endX - bounds.startX + 1;
+  int visibleHeight = bounds.endY - bounds.startY + 1;
+  profileCountCells((visibleWidth > 0 ? visibleWidth : 0) *
+                    (visibleHeight > 0 ? visibleHeight : 0));
+
+  // Zoomed far out: the whole view is a single textured quad
+  LodLevel level = lodLevel(camera.zoom);
+  if (level == LOD_COLOR) {
+    lodDraw(map, tileTypes, wallTypes, bounds);
+    profileEndStage(STAGE_DRAW_MAP);
+    return;
+  }
+
+  // The level below shows through hollow cells
+  levelDrawBelow(map, tileTypes, wallTypes, bounds);
+
+  if (meshCanDraw(map)) {
+    // Cached chunk vertex buffers, one draw call per visible chunk
+    meshDraw(map, tileTypes, wallTypes, bounds);
+  } else {
+    // Only draw tiles within the visible bounds
+    drawMapRegion(map, tileTypes, wallTypes, bounds, level);
+  }
+
+  levelDrawAbove(map, tileTypes, wallTypes, bounds);
+
+  profileEndStage(STAGE_DRAW_MAP);
 }
 
 void updateDrawnTiles(Array2DPtr coordData, DrawingState *drawState,
                       Tile *tileTypes) {
 
+  profileBeginStage(STAGE_UPDATE_DRAWN);
+
   // Update drawn with all new tiles in array
   for (int i = 0; i < coordData.arrayLength; i++) {
     int x = coordData.array[i][0];
@@ -275,7 +545,7 @@ void updateDrawnTiles(Array2DPtr coordData, DrawingState *drawState,
     }
 
     if (!alreadyVisited) {
-      int style = getRandTileStyle(drawState->activeTileKey, tileTypes);
+      int style = pickTileStyle(drawState->activeTileKey, tileTypes);
       drawState->drawnTiles[drawState->drawnTilesCount][0] = x;
       drawState->drawnTiles[drawState->drawnTilesCount][1] = y;
       drawState->drawnTiles[drawState->drawnTilesCount][2] = style;
@@ -309,4 +579,108 @@ void updateDrawnTiles(Array2DPtr coordData, DrawingState *drawState,
 
   // Update the drawnTilesCount to reflect the new size
   drawState->drawnTilesCount = newCount;
+
+  profileEndStage(STAGE_UPDATE_DRAWN);
+}
+
+// Painter stroke functions
+// Precomputes the stamp mask of a size x size brush as one span per row
+void setBrush(DrawingState *drawState, int size, BrushShape shape) {
+  float radius = size / 2.0f;
+  drawState->brushShape = shape;
+  drawState->brushSize = size;
+
+  for (int row = 0; row < size; row++) {
+    int first = size;
+    int last = -1;
+    for (int col = 0; col < size; col++) {
+      float dx = col + 0.5f - radius;
+      float dy = row + 0.5f - radius;
+      if (shape == BRUSH_SQUARE || dx * dx + dy * dy <= radius * radius) {
+        first = col < first ? col : first;
+        last = col;
+      }
+    }
+    drawState->brushSpans[row][0] = first - size / 2;
+    drawState->brushSpans[row][1] = last - size / 2;
+  }
+}
+
+void beginPaintStroke(DrawingState *drawState) {
+  memset(drawState->paintedCells, 0, sizeof(drawState->paintedCells));
+  drawState->hasLastPaint = false;
+}
+
+static void paintCell(DrawingState *drawState, int x, int y,
+                      Tile *tileTypes) {
+  int bit = x * GRID_SIZE + y;
+  if (drawState->paintedCells[bit / 8] & (1 << (bit % 8))) {
+    return;
+  }
+  drawState->paintedCells[bit / 8] |= (unsigned char)(1 << (bit % 8));
+
+  int index = drawState->drawnTilesCount;
+  drawState->drawnTiles[index][0] = x;
+  drawState->drawnTiles[index][1] = y;
+  drawState->drawnTiles[index][2] =
+      drawState->drawType == DRAW_TILE
+          ? pickTileStyle(drawState->activeTileKey, tileTypes)
+          : drawState->activeWallKey;
+  drawState->drawnTilesCount++;
+}
+
+// Applies the brush stamp centred on (x, y), clipped to the grid
+static void paintStamp(DrawingState *drawState, int x, int y,
+                       Tile *tileTypes) {
+  int half = drawState->brushSize / 2;
+  for (int row = 0; row < drawState->brushSize; row++) {
+    int cellY = y + row - half;
+    if (cellY < 0 || cellY >= GRID_SIZE) {
+      continue;
+    }
+    int startX = x + drawState->brushSpans[row][0];
+    int endX = x + drawState->brushSpans[row][1];
+    startX = startX < 0 ? 0 : startX;
+    endX = endX >= GRID_SIZE ? GRID_SIZE - 1 : endX;
+    for (int cellX = startX; cellX <= endX; cellX++) {
+      paintCell(drawState, cellX, cellY, tileTypes);
+    }
+  }
+}
+
+// Stamps the brush at every cell on the line from the previous cursor cell
+// to (x, y), so fast strokes leave no gaps whatever the frame rate
+void paintStroke(DrawingState *drawState, int x, int y, Tile *tileTypes) {
+  profileBeginStage(STAGE_UPDATE_DRAWN);
+
+  int x0 = drawState->hasLastPaint ? drawState->lastPaintX : x;
+  int y0 = drawState->hasLastPaint ? drawState->lastPaintY : y;
+  int dx = abs(x - x0);
+  int dy = -abs(y - y0);
+  int stepX = x0 < x ? 1 : -1;
+  int stepY = y0 < y ? 1 : -1;
+  int error = dx + dy;
+
+  // Bresenham line
+  while (true) {
+    paintStamp(drawState, x0, y0, tileTypes);
+    if (x0 == x && y0 == y) {
+      break;
+    }
+    int error2 = 2 * error;
+    if (error2 >= dy) {
+      error += dy;
+      x0 += stepX;
+    }
+    if (error2 <= dx) {
+      error += dx;
+      y0 += stepY;
+    }
+  }
+
+  drawState->lastPaintX = x;
+  drawState->lastPaintY = y;
+  drawState->hasLastPaint = true;
+
+  profileEndStage(STAGE_UPDATE_DRAWN);
 }
@@ -8,6 +8,9 @@
 #include "window.h"
 #include <raylib.h>
 
+// Definitions
+#define BRUSH_MAX_SIZE 64
+
 // Structures
 typedef struct {
   int arrayLength;
@@ -51,6 +54,11 @@ typedef enum {
 
 typedef enum { PRIORITY_X, PRIORITY_Y } DiagonalPriority;
 
+typedef enum {
+  BRUSH_SQUARE, // size x size cells
+  BRUSH_CIRCLE  // cells whose centres fall inside the inscribed circle
+} BrushShape;
+
 // The drawing state structure that groups all drawing variables
 typedef struct {
   DrawType drawType;         // tile or wall drawing
@@ -70,6 +78,18 @@ typedef struct {
   // Using a 2D array where each entry holds {x, y, style}
   int drawnTiles[GRID_SIZE * GRID_SIZE][3];
   int drawnTilesCount;
+  // Painter stroke: last painted cell and one bit per painted cell
+  int lastPaintX;
+  int lastPaintY;
+  bool hasLastPaint;
+  unsigned char paintedCells[(GRID_SIZE * GRID_SIZE + 7) / 8];
+  // Painter brush: the stamp mask as one span of x offsets per row, with
+  // row r covering y offset r - brushSize / 2
+  BrushShape brushShape;
+  int brushSize;
+  int brushSpans[BRUSH_MAX_SIZE][2];
+  int fillConnectivity; // 4 or 8 neighbours for the fill tool
+  int activeLayer;      // layer tiles are drawn to, 0 for the map's grid
 } DrawingState;
 
 // functions
@@ -92,4 +112,10 @@ void drawExistingMap(Map *map, Tile tileTypes[], Wall wallTypes[],
 void updateDrawnTiles(Array2DPtr coordArrayData, DrawingState *drawState,
                       Tile *tileTypes);
 
+void setBrush(DrawingState *drawState, int size, BrushShape shape);
+
+void beginPaintStroke(DrawingState *drawState);
+
+void paintStroke(DrawingState *drawState, int x, int y, Tile *tileTypes);
+
 #endif // DRAW_H
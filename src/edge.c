@@ -1,8 +1,12 @@
 #include "edge.h"
+#include "chunk.h"
 #include "database.h"
 #include "draw.h"
+#include "regiontree.h"
+#include "trace.h"
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 void processCorner(NeighborInfo *edgeNumbers, NeighborInfo *neighbors,
                    bool *visitedTiles, int index, int adjacent1,
@@ -129,10 +133,12 @@ void getEdgeTextures(Map *map, int x, int y, Tile tileTypes[], Edge edgeTypes[],
 
 void computeEdges(int edgeGrid[][2], int edgeGridCount, Map *map,
                   Tile tileTypes[], Edge edgeTypes[]) {
+  traceBegin("computeEdges");
 
   for (int i = 0; i < edgeGridCount; i++) {
     int x = edgeGrid[i][0];
     int y = edgeGrid[i][1];
+    markCellDirty(map, x, y);
 
     // Initialize to empty texture
     for (int j = 0; j < 12; j++) {
@@ -154,20 +160,88 @@ void computeEdges(int edgeGrid[][2], int edgeGridCount, Map *map,
     }
     map->edgeCount[x][y] = textureCount;
   }
+  traceEnd("computeEdges");
 }
 
-void computeMapEdges(Tile tileTypes[], Edge edgeTypes[], Map *map) {
-  // Compute edges
-  int edgeGrid[GRID_SIZE * GRID_SIZE][2] = {0};
-  int edgeGridCount = 0;
-  for (int x = 0; x < GRID_SIZE; x++) {
-    for (int y = 0; y < GRID_SIZE; y++) {
-      edgeGrid[edgeGridCount][0] = x;
-      edgeGrid[edgeGridCount][1] = y;
-      edgeGridCount++;
+// Clears the edges of a rectangle of cells
+static void clearRegionEdges(Map *map, WorldCoords cells) {
+  for (int x = cells.startX; x <= cells.endX; x++) {
+    memset(map->edges[x][cells.startY], 0,
+           (cells.endY - cells.startY + 1) * sizeof(map->edges[x][0]));
+    memset(&map->edgeCount[x][cells.startY], 0,
+           (cells.endY - cells.startY + 1) * sizeof(int));
+  }
+  for (int cx = cells.startX / CHUNK_SIZE; cx <= cells.endX / CHUNK_SIZE;
+       cx++) {
+    for (int cy = cells.startY / CHUNK_SIZE; cy <= cells.endY / CHUNK_SIZE;
+         cy++) {
+      markCellDirty(map, cx * CHUNK_SIZE, cy * CHUNK_SIZE);
+    }
+  }
+}
+
+// Computes the edges of a square block of span chunks. Edges come from the
+// tile keys of a cell's eight neighbours, so a block whose cells and their
+// neighbours share one key has none and is cleared whole; otherwise the
+// block is split in four down to single chunks.
+static void computeBlockEdges(Tile tileTypes[], Edge edgeTypes[], Map *map,
+                              int cx, int cy, int span) {
+  if (cx >= CHUNK_COUNT || cy >= CHUNK_COUNT) {
+    return;
+  }
+  WorldCoords cells = {cx * CHUNK_SIZE, cy * CHUNK_SIZE,
+                       (cx + span) * CHUNK_SIZE - 1,
+                       (cy + span) * CHUNK_SIZE - 1};
+  cells.endX = cells.endX < GRID_SIZE - 1 ? cells.endX : GRID_SIZE - 1;
+  cells.endY = cells.endY < GRID_SIZE - 1 ? cells.endY : GRID_SIZE - 1;
+  WorldCoords halo = {cells.startX - 1, cells.startY - 1, cells.endX + 1,
+                      cells.endY + 1};
+  if (regionUniformKey(map, DRAW_TILE, halo) >= 0) {
+    clearRegionEdges(map, cells);
+    return;
+  }
+
+  if (span > 1) {
+    int half = span / 2;
+    computeBlockEdges(tileTypes, edgeTypes, map, cx, cy, half);
+    computeBlockEdges(tileTypes, edgeTypes, map, cx + half, cy, half);
+    computeBlockEdges(tileTypes, edgeTypes, map, cx, cy + half, half);
+    computeBlockEdges(tileTypes, edgeTypes, map, cx + half, cy + half, half);
+    return;
+  }
+
+  // A chunk of one key still has no edges inside its border ring
+  bool uniform = regionUniformKey(map, DRAW_TILE, cells) >= 0;
+  int edgeGrid[CHUNK_SIZE * CHUNK_SIZE][2];
+  int count = 0;
+  for (int x = cells.startX; x <= cells.endX; x++) {
+    for (int y = cells.startY; y <= cells.endY; y++) {
+      if (uniform && x > cells.startX && x < cells.endX &&
+          y > cells.startY && y < cells.endY) {
+        memset(map->edges[x][y], 0, sizeof(map->edges[x][y]));
+        map->edgeCount[x][y] = 0;
+        continue;
+      }
+      edgeGrid[count][0] = x;
+      edgeGrid[count][1] = y;
+      count++;
     }
   }
-  computeEdges(edgeGrid, edgeGridCount, map, tileTypes, edgeTypes);
+  markCellDirty(map, cells.startX, cells.startY);
+  computeEdges(edgeGrid, count, map, tileTypes, edgeTypes);
+}
+
+// Computes every cell's edges, skipping uniform regions found in the
+// region tree
+void computeMapEdges(Tile tileTypes[], Edge edgeTypes[], Map *map) {
+  traceBegin("computeMapEdges");
+  regionTreeUpdate(map);
+  int span = 1;
+  while (span < CHUNK_COUNT) {
+    span *= 2;
+  }
+  computeBlockEdges(tileTypes, edgeTypes, map, 0, 0, span);
+  traceEnd("computeMapEdges");
 }
 
 bool visitedCheck(int visitedTiles[][2], int visitedCount, int x, int y) {
@@ -186,8 +260,39 @@ bool visitedCheck(int visitedTiles[][2], int visitedCount, int x, int y) {
   }
 }
 
+// One bit per cell while a dirty neighbourhood is collected
+static unsigned char visitedBits[(GRID_SIZE * GRID_SIZE + 7) / 8];
+
+// Sets or clears the bits of every cell on the visited list
+void setVisitedBits(int visitedTiles[][2], int visitedCount, bool value) {
+  for (int i = 0; i < visitedCount; i++) {
+    int bit = visitedTiles[i][0] * GRID_SIZE + visitedTiles[i][1];
+    if (value) {
+      visitedBits[bit / 8] |= (unsigned char)(1 << (bit % 8));
+    } else {
+      visitedBits[bit / 8] &= (unsigned char)~(1 << (bit % 8));
+    }
+  }
+}
+
+// Appends an in-bounds cell to the visited list unless its bit is set
+void visitCell(int visitedTiles[][2], int *visitedCount, int x, int y) {
+  if (x < 0 || y < 0 || x >= GRID_SIZE || y >= GRID_SIZE) {
+    return;
+  }
+  int bit = x * GRID_SIZE + y;
+  if (visitedBits[bit / 8] & (1 << (bit % 8))) {
+    return;
+  }
+  visitedBits[bit / 8] |= (unsigned char)(1 << (bit % 8));
+  visitedTiles[*visitedCount][0] = x;
+  visitedTiles[*visitedCount][1] = y;
+  (*visitedCount)++;
+}
+
 void calculateEdgeGrid(DrawingState *drawState, int visitedTiles[][2],
                        int *visitedCount) {
+  setVisitedBits(visitedTiles, *visitedCount, true);
 
   for (int i = 0; i < drawState->drawnTilesCount; i++) {
     int x = drawState->drawnTiles[i][0];
@@ -201,25 +306,12 @@ void calculateEdgeGrid(DrawingState *drawState, int visitedTiles[][2],
     };
 
     // populate visited tiles first with placedTiles
-    if (!visitedCheck(visitedTiles, *visitedCount, x, y)) {
-
-      visitedTiles[*visitedCount][0] = x;
-      visitedTiles[*visitedCount][1] = y;
-      (*visitedCount)++;
-    }
+    visitCell(visitedTiles, visitedCount, x, y);
 
     for (int j = 0; j < 8; j++) {
-      int nx = directions[j][0];
-      int ny = directions[j][1];
-
-      bool visited = visitedCheck(visitedTiles, *visitedCount, nx, ny);
-
-      if (!visited && nx >= 0 && ny >= 0 && ny < GRID_SIZE && nx < GRID_SIZE) {
-
-        visitedTiles[*visitedCount][0] = nx;
-        visitedTiles[*visitedCount][1] = ny;
-        (*visitedCount)++;
-      }
+      visitCell(visitedTiles, visitedCount, directions[j][0], directions[j][1]);
     }
   }
+
+  setVisitedBits(visitedTiles, *visitedCount, false);
 }
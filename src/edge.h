@@ -37,6 +37,10 @@ void computeMapEdges(Tile tileTypes[], Edge edgeTypes[], Map *map);
 
 bool visitedCheck(int visitedTiles[][2], int visitedCount, int x, int y);
 
+void setVisitedBits(int visitedTiles[][2], int visitedCount, bool value);
+
+void visitCell(int visitedTiles[][2], int *visitedCount, int x, int y);
+
 void calculateEdgeGrid(DrawingState *drawState, int visitedTiles[][2],
                        int *visitedCount);
 
@@ -0,0 +1,671 @@
+// editor.c
+#include "editor.h"
+#include "atlas.h"
+#include "autotile.h"
+#include "connectivity.h"
+#include "edge.h"
+#include "fill.h"
+#include "grid.h"
+#include "hpa.h"
+#include "keyindex.h"
+#include "layer.h"
+#include "level.h"
+#include "lod.h"
+#include "math.h"
+#include "mesh.h"
+#include "minimap.h"
+#include "pathfind.h"
+#include "profile.h"
+#include "regiontree.h"
+#include "runindex.h"
+#include "stats.h"
+#include "tilestyle.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Session functions
+void editorInit(Editor *editor, sqlite3 *db, char *mapTable, int width,
+                int height) {
+  editor->db = db;
+
+  // Initialize map
+  traceBegin("loadMap");
+  tileStyleLoad(db, mapTable);
+  levelLoad(db, mapTable, &editor->map);
+  layerLoad(db, mapTable, &editor->map);
+  traceEnd("loadMap");
+
+  // Load textures
+  traceBegin("loadTextures");
+  editor->tileTypes = loadTiles(db, &editor->map);
+  editor->edgeTypes = loadEdges(db, &editor->map);
+  editor->wallTypes = loadWalls(db, &editor->map);
+  traceEnd("loadTextures");
+  traceBegin("computeMap");
+  computeMapEdges(editor->tileTypes, editor->edgeTypes, &editor->map);
+  computeMapWalls(editor->wallTypes, &editor->map);
+  traceEnd("computeMap");
+  keyIndexBuild(&editor->map);
+
+  // Upload the sprite atlas and enable the vertex buffer renderer
+  atlasBuild();
+  meshInit(&editor->map);
+
+  // Load Hash Tables
+  traceBegin("loadWallOrientationsMap");
+  editor->wallOrientationMap = loadWallOrientationsMap(db);
+  traceEnd("loadWallOrientationsMap");
+  autotileInit(editor->wallTypes, editor->map.maxWallKey,
+               editor->wallOrientationMap);
+
+  // Initialize Undo/Redo manager
+  editor->manager = (UndoRedoManager *)malloc(sizeof(UndoRedoManager));
+  editor->manager->head = NULL;
+  editor->manager->current = NULL;
+
+  // Window state
+  editor->windowState.width = width;
+  editor->windowState.height = height;
+
+  // Initialize camera
+  editor->camera.zoom = 1.0f;
+  editor->camera.offset = (Vector2){width / 2.0f, height / 2.0f};
+  editor->camera.target =
+      (Vector2){GRID_SIZE / 2 * TILE_SIZE, GRID_SIZE / 2 * TILE_SIZE};
+  editor->camera.rotation = 0.0f;
+
+  // Initialize camera state
+  editor->cameraState.isPanning = false;
+  editor->cameraState.lastMousePosition = (Vector2){0, 0};
+
+  // Initialize drawing state
+  DrawingState *drawState = &editor->drawState;
+  memset(drawState, 0, sizeof(DrawingState));
+  drawState->drawType = DRAW_TILE;             // Start in tile drawing mode
+  drawState->drawMode = MODE_PAINTER;          // Default mode is painter
+  drawState->pathMode = PATH_DIAGONAL;         // Default path is diagonal
+  drawState->previousPathMode = PATH_DIAGONAL; // Default path is diagonal
+  drawState->activeTileKey = 0;                // Initialize to a default tile
+  drawState->activeWallKey = 0;                // Initialize to a default wall
+  drawState->isDrawing = false;
+  drawState->drawnTilesCount = 0;
+  drawState->initialDragDirection = (Vector2){0, 0}; // Initial drag direction
+  drawState->hasCapturedDragDirection = false;       // Initialize capture flag
+  setBrush(drawState, 1, BRUSH_SQUARE);              // Single cell brush
+  drawState->fillConnectivity = 4;                   // Fill across edges only
+
+  // Initialize command state
+  memset(&editor->commandState, 0, sizeof(CommandState));
+  editor->commandState.commandIndex = 0;
+  editor->commandState.inCommandMode = false;
+
+  // Initialize clipboard state
+  memset(&editor->clipboardState, 0, sizeof(ClipboardState));
+}
+
+// Runs one frame of editing logic. Drawing calls are issued between the
+// caller's BeginDrawing/EndDrawing pair; all input comes from the frame.
+void editorFrame(Editor *editor, const InputFrame *input) {
+  Map *currentMap = &editor->map;
+  Tile *tileTypes = editor->tileTypes;
+  Edge *edgeTypes = editor->edgeTypes;
+  Wall *wallTypes = editor->wallTypes;
+  WallOrientMap *wallOrientationMap = editor->wallOrientationMap;
+  UndoRedoManager *manager = editor->manager;
+  WindowState *windowState = &editor->windowState;
+  Camera2D *camera = &editor->camera;
+  CameraState *cameraState = &editor->cameraState;
+  DrawingState *drawState = &editor->drawState;
+  CommandState *commandState = &editor->commandState;
+  ClipboardState *clipboardState = &editor->clipboardState;
+
+  profileBeginStage(STAGE_INPUT);
+
+  // Toggle profiler overlay
+  if (inputKeyPressed(input, KEY_F3)) {
+    profiler.showOverlay = !profiler.showOverlay;
+  }
+
+  // Toggle the cut off regions overlay
+  if (inputKeyPressed(input, KEY_F5)) {
+    connectivity.visible = !connectivity.visible;
+  }
+
+  // Handle window resizing
+  HandleWindowResize(windowState, camera, input->screenWidth,
+                     input->screenHeight);
+
+  // Camera movement
+  float deltaTime = input->frameTime;
+  if (inputKeyDown(input, KEY_RIGHT))
+    camera->target.x += CAMERA_SPEED * deltaTime;
+  if (inputKeyDown(input, KEY_LEFT))
+    camera->target.x -= CAMERA_SPEED * deltaTime;
+  if (inputKeyDown(input, KEY_DOWN))
+    camera->target.y += CAMERA_SPEED * deltaTime;
+  if (inputKeyDown(input, KEY_UP))
+    camera->target.y -= CAMERA_SPEED * deltaTime;
+
+  if (inputMouseButtonPressed(input, MOUSE_BUTTON_RIGHT)) {
+    cameraState->isPanning = true;
+    cameraState->lastMousePosition = drawState->mousePos;
+  } else if (inputMouseButtonReleased(input, MOUSE_BUTTON_RIGHT)) {
+    cameraState->isPanning = false;
+  }
+
+  // Update camera position while panning
+  if (cameraState->isPanning) {
+    Vector2 mouseDelta = {
+        drawState->mousePos.x - cameraState->lastMousePosition.x,
+        drawState->mousePos.y - cameraState->lastMousePosition.y};
+
+    // Move camera opposite to mouse movement, adjusted for zoom
+    camera->target.x -= mouseDelta.x / camera->zoom;
+    camera->target.y -= mouseDelta.y / camera->zoom;
+
+    cameraState->lastMousePosition = drawState->mousePos;
+  }
+
+  // Presses on the minimap move the camera and presses with the path tool
+  // pick its cells; neither reaches the drawing tools
+  InputFrame toolInput = *input;
+  unsigned char left = 1 << MOUSE_BUTTON_LEFT;
+  if (minimapHandleInput(&toolInput, camera, windowState->width,
+                         windowState->height) ||
+      pathfindHandleInput(&toolInput, currentMap, tileTypes, *camera)) {
+    toolInput.buttonsDown &= (unsigned char)~left;
+    toolInput.buttonsPressed &= (unsigned char)~left;
+    toolInput.buttonsReleased &= (unsigned char)~left;
+    input = &toolInput;
+  }
+
+  // Get mouse position in world coordinates
+  Vector2 screenMousePos = input->mousePos;
+  drawState->mousePos = screenMousePos;
+
+  float wheel = input->wheel;
+  if (wheel != 0) {
+    // Get mouse position before zoom for zoom targeting
+    Vector2 mouseWorldPos = getWorldCoordinates(input->mousePos, *camera);
+
+    // Apply zoom
+    camera->zoom += wheel * 0.1f;
+    if (camera->zoom < 0.2f)
+      camera->zoom = 0.1f;
+
+    // Adjust camera target to zoom towards mouse position
+    Vector2 newMouseWorldPos = getWorldCoordinates(input->mousePos, *camera);
+    camera->target.x += mouseWorldPos.x - newMouseWorldPos.x;
+    camera->target.y += mouseWorldPos.y - newMouseWorldPos.y;
+  }
+
+  // Check for Ctrl-Z (Undo)
+  if (inputKeyDown(input, KEY_LEFT_CONTROL) ||
+      inputKeyDown(input, KEY_RIGHT_CONTROL)) {
+    if (inputKeyPressed(input, KEY_Z)) {
+      undo(manager, currentMap, tileTypes, edgeTypes, wallTypes);
+    }
+
+    // Check for Ctrl-Y (Redo)
+    if (inputKeyPressed(input, KEY_Y)) {
+      redo(manager, currentMap, tileTypes, edgeTypes, wallTypes);
+    }
+
+    // Ctrl-C, Ctrl-X and Ctrl-V for the selection and clipboard
+    if (inputKeyPressed(input, KEY_C) && clipboardState->hasSelection) {
+      clipboardCopy(&clipboardState->clipboard, currentMap,
+                    clipboardState->selection);
+    }
+    if (inputKeyPressed(input, KEY_X) && clipboardState->hasSelection &&
+        !layerStack.layers[0].info.locked) {
+      clipboardCut(&clipboardState->clipboard, currentMap,
+                   clipboardState->selection, manager, tileTypes, edgeTypes,
+                   wallTypes);
+      clipboardState->hasSelection = false;
+    }
+    if (inputKeyPressed(input, KEY_V) &&
+        clipboardState->clipboard.cells != NULL) {
+      clipboardState->pasting = true;
+    }
+
+    // Ctrl-= and Ctrl-- move up and down a level
+    if (inputKeyPressed(input, KEY_EQUAL)) {
+      levelSwitch(currentMap, manager, currentMap->level + 1, tileTypes,
+                  edgeTypes, wallTypes);
+    }
+    if (inputKeyPressed(input, KEY_MINUS)) {
+      levelSwitch(currentMap, manager, currentMap->level - 1, tileTypes,
+                  edgeTypes, wallTypes);
+    }
+  } else if (clipboardState->pasting && !commandState->inCommandMode) {
+    // R rotates, F and V flip the clipboard while pasting; Escape cancels
+    if (inputKeyPressed(input, KEY_R)) {
+      clipboardTransform(&clipboardState->clipboard, CLIPBOARD_ROTATE,
+                         wallTypes, currentMap->maxWallKey,
+                         wallOrientationMap);
+    }
+    if (inputKeyPressed(input, KEY_F)) {
+      clipboardTransform(&clipboardState->clipboard, CLIPBOARD_FLIP_X,
+                         wallTypes, currentMap->maxWallKey,
+                         wallOrientationMap);
+    }
+    if (inputKeyPressed(input, KEY_V)) {
+      clipboardTransform(&clipboardState->clipboard, CLIPBOARD_FLIP_Y,
+                         wallTypes, currentMap->maxWallKey,
+                         wallOrientationMap);
+    }
+    if (inputKeyPressed(input, KEY_ESCAPE)) {
+      clipboardState->pasting = false;
+    }
+  }
+
+  // Middle-drag selects a rectangle for the clipboard
+  if (inputMouseButtonPressed(input, MOUSE_BUTTON_MIDDLE)) {
+    clipboardState->selecting = true;
+    clipboardState->anchor = drawState->mousePos;
+  } else if (inputMouseButtonReleased(input, MOUSE_BUTTON_MIDDLE)) {
+    clipboardState->selecting = false;
+  }
+  if (clipboardState->selecting) {
+    WorldCoords coords = getWorldGridCoords(clipboardState->anchor,
+                                            drawState->mousePos, *camera);
+    clipboardState->selection = (WorldCoords){
+        coords.startX < coords.endX ? coords.startX : coords.endX,
+        coords.startY < coords.endY ? coords.startY : coords.endY,
+        coords.startX > coords.endX ? coords.startX : coords.endX,
+        coords.startY > coords.endY ? coords.startY : coords.endY};
+    clipboardState->hasSelection = true;
+  }
+
+  profileEndStage(STAGE_INPUT);
+
+  BeginMode2D(*camera);
+
+  // Draw existing map
+  if (!drawState->isDrawing) {
+    drawExistingMap(currentMap, tileTypes, wallTypes, *camera,
+                    windowState->width, windowState->height);
+  }
+
+  // Pastes and fills edit the map's grid; drawing edits the active layer
+  int editLayer = clipboardState->pasting || inputKeyDown(input, KEY_LEFT_ALT)
+                      ? 0
+                      : layerEditTarget(drawState);
+
+  if (inputMouseButtonPressed(input, MOUSE_BUTTON_LEFT) &&
+      layerStack.layers[editLayer].info.locked) {
+    printf("Layer \"%s\" is locked\n", layerStack.layers[editLayer].info.name);
+  } else if (inputMouseButtonPressed(input, MOUSE_BUTTON_LEFT) &&
+             clipboardState->pasting) {
+    // Clicking while pasting places the clipboard at the cursor
+    profileBeginStage(STAGE_COMMIT);
+    WorldCoords coords =
+        getWorldGridCoords(drawState->mousePos, drawState->mousePos, *camera);
+    clipboardPaste(&clipboardState->clipboard, currentMap, coords.startX,
+                   coords.startY, manager, tileTypes, edgeTypes, wallTypes);
+    clipboardState->pasting = false;
+    profileEndStage(STAGE_COMMIT);
+  } else if (inputMouseButtonPressed(input, MOUSE_BUTTON_LEFT) &&
+             inputKeyDown(input, KEY_LEFT_ALT)) {
+    // Alt-click fills the clicked region in one step
+    profileBeginStage(STAGE_COMMIT);
+    WorldCoords coords =
+        getWorldGridCoords(drawState->mousePos, drawState->mousePos, *camera);
+    floodFill(currentMap, drawState, manager, coords.startX, coords.startY,
+              tileTypes, edgeTypes, wallTypes);
+    profileEndStage(STAGE_COMMIT);
+  } else if (inputMouseButtonPressed(input, MOUSE_BUTTON_LEFT)) {
+    // Check for starting a drawing action
+    // Decide the drawing mode based on modifier keys
+    if (inputKeyDown(input, KEY_LEFT_SHIFT)) {
+      drawState->drawMode = MODE_BOX;
+    } else if (inputKeyDown(input, KEY_LEFT_CONTROL)) {
+      drawState->drawMode = MODE_PATHING;
+    } else {
+      drawState->drawMode = MODE_PAINTER;
+    }
+    // Store the position where drawing started
+    drawState->startPos = drawState->mousePos;
+    drawState->isDrawing = true;
+    drawState->drawnTilesCount = 0; // Clear previous preview data
+    if (drawState->drawMode == MODE_PAINTER) {
+      beginPaintStroke(drawState);
+    }
+  }
+
+  if (drawState->isDrawing) {
+
+    // Box (Shift) mode drawing
+    switch (drawState->drawMode) {
+    case MODE_BOX: {
+      switch (drawState->drawType) {
+      case DRAW_TILE: {
+
+        WorldCoords coords = getWorldGridCoords(drawState->startPos,
+                                                drawState->mousePos, *camera);
+
+        // Calculate the size of the array based on the bounding box
+        int coordArraySize = getBoundingBoxSize(coords);
+        int coordArray[coordArraySize][2];
+
+        coordsToArray(coords, coordArray);
+
+        Array2DPtr coordData = {.arrayLength = coordArraySize,
+                                .array = coordArray};
+
+        updateDrawnTiles(coordData, drawState, tileTypes);
+
+        drawPreview(currentMap, drawState, tileTypes, edgeTypes, wallTypes,
+                    *windowState, *camera);
+        break;
+      }
+      case DRAW_WALL: {
+        WorldCoords coords = getWorldGridCoords(drawState->startPos,
+                                                drawState->mousePos, *camera);
+
+        // Calculate the size of the array based on the bounding box
+        int coordArraySize = getBoundingPerimeterSize(coords);
+        int coordArray[coordArraySize][2];
+
+        coordsToPerimeterArray(coords, coordArray);
+
+        Array2DPtr coordData = {.arrayLength = coordArraySize,
+                                .array = coordArray};
+
+        updateDrawnTiles(coordData, drawState, tileTypes);
+
+        calculateWallOrientations(drawState, wallOrientationMap);
+
+        drawPreview(currentMap, drawState, tileTypes, edgeTypes, wallTypes,
+                    *windowState, *camera);
+        break;
+      }
+      }
+      break;
+    }
+    case MODE_PATHING: {
+      // Check if we're still within the starting tile (32x32 pixels)
+      float deltaX = drawState->mousePos.x - drawState->startPos.x;
+      float deltaY = drawState->mousePos.y - drawState->startPos.y;
+      bool withinStartingTile =
+          (fabsf(deltaX) < TILE_SIZE && fabsf(deltaY) < TILE_SIZE);
+
+      // If we moved back to starting tile, reset capture to allow
+      // recalculation
+      if (withinStartingTile && drawState->hasCapturedDragDirection) {
+        drawState->hasCapturedDragDirection = false;
+        drawState->initialDragDirection = (Vector2){0, 0};
+      }
+
+      // Capture initial drag direction if we haven't yet and we're outside
+      // starting tile
+      if (!drawState->hasCapturedDragDirection && !withinStartingTile) {
+        float dragDistance = sqrt(deltaX * deltaX + deltaY * deltaY);
+
+        // Only capture direction after mouse moves outside the starting tile
+        if (dragDistance >
+            5.0f) { // Small buffer to avoid jitter at tile edge
+          drawState->initialDragDirection = (Vector2){deltaX, deltaY};
+          drawState->hasCapturedDragDirection = true;
+        }
+      }
+      switch (drawState->drawType) {
+      case DRAW_TILE: {
+
+        WorldCoords coords = getWorldGridCoords(drawState->startPos,
+                                                drawState->mousePos, *camera);
+
+        int coordArraySize = (abs(coords.endX - coords.startX) +
+                              (abs(coords.endY - coords.startY)) + 1);
+
+        int coordArray[coordArraySize][2];
+
+        Array2DPtr pathData = {.arrayLength = coordArraySize,
+                               .array = coordArray};
+
+        calculatePath(coords, pathData, drawState);
+
+        updateDrawnTiles(pathData, drawState, tileTypes);
+
+        drawPreview(currentMap, drawState, tileTypes, edgeTypes, wallTypes,
+                    *windowState, *camera);
+
+        break;
+      }
+      case DRAW_WALL: {
+
+        WorldCoords coords = getWorldGridCoords(drawState->startPos,
+                                                drawState->mousePos, *camera);
+
+        int coordArraySize = (abs(coords.endX - coords.startX) +
+                              (abs(coords.endY - coords.startY)) + 1);
+
+        int coordArray[coordArraySize][2];
+
+        Array2DPtr pathData = {.arrayLength = coordArraySize,
+                               .array = coordArray};
+
+        calculatePath(coords, pathData, drawState);
+
+        updateDrawnTiles(pathData, drawState, tileTypes);
+
+        calculateWallOrientations(drawState, wallOrientationMap);
+
+        drawPreview(currentMap, drawState, tileTypes, edgeTypes, wallTypes,
+                    *windowState, *camera);
+
+        break;
+      }
+      }
+      break;
+    }
+    case MODE_PAINTER: {
+      WorldCoords coords =
+          getWorldGridCoords(drawState->mousePos, drawState->mousePos, *camera);
+
+      // Fill the segment from the previous frame's cell to this one
+      paintStroke(drawState, coords.endX, coords.endY, tileTypes);
+
+      drawPreview(currentMap, drawState, tileTypes, edgeTypes, wallTypes,
+                  *windowState, *camera);
+      break;
+    }
+    }
+  } else if (clipboardState->pasting) {
+    WorldCoords coords =
+        getWorldGridCoords(drawState->mousePos, drawState->mousePos, *camera);
+    clipboardDrawPreview(&clipboardState->clipboard, coords.startX,
+                         coords.startY, tileTypes, wallTypes, *camera,
+                         windowState->width, windowState->height);
+  } else {
+
+    // Fallback: Draw a simple cursor preview if no drawing mode is active
+    WorldCoords coords =
+        getWorldGridCoords(drawState->mousePos, drawState->mousePos, *camera);
+
+    switch (drawState->drawType) {
+      Vector2 previewPos;
+      Texture2D previewTex;
+    case DRAW_TILE:
+      previewPos =
+          (Vector2){coords.startX * TILE_SIZE, coords.startY * TILE_SIZE};
+      previewTex = tileTypes[drawState->activeTileKey].tex[0];
+      DrawTexture(previewTex, previewPos.x, previewPos.y, WHITE);
+
+      // Outline the brush footprint
+      int half = drawState->brushSize / 2;
+      DrawRectangleLines(previewPos.x - half * TILE_SIZE,
+                         previewPos.y - half * TILE_SIZE,
+                         drawState->brushSize * TILE_SIZE,
+                         drawState->brushSize * TILE_SIZE, RED);
+      break;
+
+    case DRAW_WALL: {
+      Texture2D previewTex[4] = {
+          wallTypes[drawState->activeWallKey].wallTex[0].tex,
+          wallTypes[drawState->activeWallKey].wallTex[1].tex,
+          wallTypes[drawState->activeWallKey].wallTex[2].tex,
+          wallTypes[drawState->activeWallKey].wallTex[3].tex};
+      Vector2 previewPos[4] = {
+          {(coords.startX - 1) * TILE_SIZE, (coords.startY - 1) * TILE_SIZE},
+          {(coords.startX) * TILE_SIZE, (coords.startY - 1) * TILE_SIZE},
+          {(coords.startX - 1) * TILE_SIZE, (coords.startY) * TILE_SIZE},
+          {(coords.startX) * TILE_SIZE, (coords.startY) * TILE_SIZE},
+      };
+      for (int i = 0; i < 4; i++) {
+        DrawTexture(previewTex[i], previewPos[i].x, previewPos[i].y, WHITE);
+      }
+      DrawRectangleLines(previewPos[3].x - TILE_SIZE,
+                         previewPos[3].y - TILE_SIZE, TILE_SIZE * 2,
+                         TILE_SIZE * 2, RED);
+      break;
+    }
+    };
+  }
+
+  // Only strokes that started drawing are committed; locked layers, pastes
+  // and fills start none
+  if (inputMouseButtonReleased(input, MOUSE_BUTTON_LEFT) &&
+      drawState->isDrawing) {
+    profileBeginStage(STAGE_COMMIT);
+
+    // Get neighbors to placement; static as it is too large for the stack
+    // on big grids
+    static int visitedTiles[GRID_SIZE * GRID_SIZE][2];
+    int visitedCount = 0;
+    switch (drawState->drawType) {
+    case DRAW_TILE:
+
+      // Named layers have no edges to recompute
+      if (drawState->activeLayer != 0) {
+        createTileChangeBatch(manager, currentMap, drawState, visitedTiles, 0);
+        applyTiles(currentMap, drawState);
+        memset(drawState->drawnTiles, 0, sizeof(drawState->drawnTiles));
+        drawState->isDrawing = false;
+        break;
+      }
+
+      calculateEdgeGrid(drawState, visitedTiles, &visitedCount);
+
+      // Add drawn tiles to undo/redo stack
+      createTileChangeBatch(manager, currentMap, drawState, visitedTiles,
+                            visitedCount);
+
+      // Texture updates
+      applyTiles(currentMap, drawState);
+      computeEdges(visitedTiles, visitedCount, currentMap, tileTypes,
+                   edgeTypes);
+
+      memset(drawState->drawnTiles, 0, sizeof(drawState->drawnTiles));
+
+      drawState->isDrawing = false;
+      break;
+    case DRAW_WALL:
+      if (drawState->drawMode == MODE_BOX) {
+        calculateWallOrientations(drawState, wallOrientationMap);
+      }
+
+      // Walls link to their neighbours, which may need re-resolving too
+      autotileDrawnWalls(currentMap, drawState);
+      calculateWallGrid(drawState, visitedTiles, &visitedCount);
+      createTileChangeBatch(manager, currentMap, drawState, visitedTiles,
+                            visitedCount);
+      applyTiles(currentMap, drawState);
+      computeWalls(visitedTiles, visitedCount, currentMap, wallTypes);
+      memset(drawState->drawnTiles, 0, sizeof(drawState->drawnTiles));
+      drawState->isDrawing = false;
+      break;
+    }
+    drawState->hasCapturedDragDirection = false;
+
+    profileEndStage(STAGE_COMMIT);
+  }
+
+  // Outline the clipboard selection
+  if (clipboardState->hasSelection) {
+    WorldCoords selection = clipboardState->selection;
+    DrawRectangleLines(selection.startX * TILE_SIZE,
+                       selection.startY * TILE_SIZE,
+                       (selection.endX - selection.startX + 1) * TILE_SIZE,
+                       (selection.endY - selection.startY + 1) * TILE_SIZE,
+                       YELLOW);
+  }
+
+  connectivityDraw(currentMap, tileTypes, *camera, windowState->width,
+                   windowState->height);
+  pathfindDraw();
+
+  EndMode2D();
+
+  // Counts of the selection from the summed-area tables
+  if (clipboardState->hasSelection) {
+    statsDrawReadout(currentMap, tileTypes, clipboardState->selection);
+  }
+  pathfindDrawReadout(windowState->width);
+  connectivityDrawReadout(windowState->width);
+
+  minimapDraw(currentMap, tileTypes, wallTypes, *camera, windowState->width,
+              windowState->height);
+
+  // Handle command mode
+  profileBeginStage(STAGE_COMMAND);
+  handleCommandMode(commandState, input, windowState->height,
+                    windowState->width, tileTypes, edgeTypes, wallTypes,
+                    editor->db, drawState, currentMap, manager);
+  profileEndStage(STAGE_COMMAND);
+}
+
+// True while an interaction or work spread over several frames needs frames
+// without further input
+bool editorIsBusy(const Editor *editor) {
+  return editor->drawState.isDrawing || editor->cameraState.isPanning ||
+         minimapPending();
+}
+
+void editorShutdown(Editor *editor) {
+  // free Undo/Redo manager and all batches/changes from session
+  freeUndoHistory(editor->manager);
+
+  WallOrientMap *wallOrientationMap = editor->wallOrientationMap;
+
+  clipboardFree(&editor->clipboardState.clipboard);
+  keyIndexUnload();
+  runIndexUnload();
+  regionTreeUnload();
+  statsUnload();
+  pathfindUnload();
+  hpaUnload();
+  connectivityUnload();
+  autotileUnload();
+  levelUnload();
+  layerUnload();
+  lodUnload();
+  minimapUnload();
+  meshUnload();
+  atlasUnload();
+  if (wallOrientationMap != NULL) {
+    free(wallOrientationMap->targets);
+    free(wallOrientationMap);
+  }
+  free(editor->manager);
+  free(editor->tileTypes);
+  free(editor->edgeTypes);
+}
+
+// FNV-1a over the tile, style and wall keys of every cell
+uint64_t editorMapHash(const Map *map) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (int x = 0; x < GRID_SIZE; x++) {
+    for (int y = 0; y < GRID_SIZE; y++) {
+      for (int k = 0; k < 3; k++) {
+        unsigned int value = (unsigned int)map->grid[x][y][k];
+        for (int b = 0; b < 4; b++) {
+          hash ^= (value >> (b * 8)) & 0xff;
+          hash *= 1099511628211ULL;
+        }
+      }
+    }
+  }
+  return hash;
+}
@@ -0,0 +1,48 @@
+// editor.h
+#ifndef EDITOR_H
+#define EDITOR_H
+
+// includes
+#include "clipboard.h"
+#include "command.h"
+#include "database.h"
+#include "draw.h"
+#include "input.h"
+#include "undo.h"
+#include "wall.h"
+#include "window.h"
+#include <raylib.h>
+#include <sqlite3.h>
+#include <stdint.h>
+
+// structs
+// Editing session shared by the windowed editor and headless replay
+typedef struct {
+  sqlite3 *db;
+  Map map;
+  Tile *tileTypes;
+  Edge *edgeTypes;
+  Wall *wallTypes;
+  WallOrientMap *wallOrientationMap;
+  UndoRedoManager *manager;
+  WindowState windowState;
+  Camera2D camera;
+  CameraState cameraState;
+  DrawingState drawState;
+  CommandState commandState;
+  ClipboardState clipboardState;
+} Editor;
+
+// functions
+void editorInit(Editor *editor, sqlite3 *db, char *mapTable, int width,
+                int height);
+
+void editorFrame(Editor *editor, const InputFrame *input);
+
+bool editorIsBusy(const Editor *editor);
+
+void editorShutdown(Editor *editor);
+
+uint64_t editorMapHash(const Map *map);
+
+#endif // EDITOR_H
@@ -0,0 +1,419 @@
+// fill.c
+#include "fill.h"
+#include "autotile.h"
+#include "chunk.h"
+#include "edge.h"
+#include "keyindex.h"
+#include "tilestyle.h"
+#include "trace.h"
+#include "wall.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Variables
+// One bit per cell of the region being filled
+static unsigned char filledBits[(GRID_SIZE * GRID_SIZE + 7) / 8];
+
+// Cells still to be scanned, one per run of fillable cells found so far
+typedef struct {
+  int (*seeds)[2];
+  int count;
+  int capacity;
+} FillStack;
+
+// Helper functions
+static bool isFilled(int x, int y) {
+  int bit = x * GRID_SIZE + y;
+  return filledBits[bit / 8] & (1 << (bit % 8));
+}
+
+static void setFilled(int x, int y, bool value) {
+  int bit = x * GRID_SIZE + y;
+  if (value) {
+    filledBits[bit / 8] |= (unsigned char)(1 << (bit % 8));
+  } else {
+    filledBits[bit / 8] &= (unsigned char)~(1 << (bit % 8));
+  }
+}
+
+static bool isFillable(Map *map, int plane, int target, int x, int y) {
+  return map->grid[x][y][plane] == target && !isFilled(x, y);
+}
+
+static bool pushSeed(FillStack *stack, int x, int y) {
+  if (stack->count == stack->capacity) {
+    int capacity = stack->capacity ? stack->capacity * 2 : 256;
+    int (*seeds)[2] =
+        (int (*)[2])realloc(stack->seeds, capacity * sizeof(int[2]));
+    if (seeds == NULL) {
+      return false;
+    }
+    stack->seeds = seeds;
+    stack->capacity = capacity;
+  }
+  stack->seeds[stack->count][0] = x;
+  stack->seeds[stack->count][1] = y;
+  stack->count++;
+  return true;
+}
+
+// Pushes one seed per run of fillable cells in column x between startY and
+// endY
+static bool pushColumnRuns(FillStack *stack, Map *map, int plane, int target,
+                           int x, int startY, int endY) {
+  if (x < 0 || x >= GRID_SIZE) {
+    return true;
+  }
+  startY = startY < 0 ? 0 : startY;
+  endY = endY >= GRID_SIZE ? GRID_SIZE - 1 : endY;
+
+  bool inRun = false;
+  for (int y = startY; y <= endY; y++) {
+    bool fillable = isFillable(map, plane, target, x, y);
+    if (fillable && !inRun && !pushSeed(stack, x, y)) {
+      return false;
+    }
+    inRun = fillable;
+  }
+  return true;
+}
+
+static bool pushSpan(TileChangeSpan **spans, int *count, int *capacity,
+                     TileChangeSpan span) {
+  if (*count == *capacity) {
+    int newCapacity = *capacity ? *capacity * 2 : 64;
+    TileChangeSpan *grown = (TileChangeSpan *)realloc(
+        *spans, newCapacity * sizeof(TileChangeSpan));
+    if (grown == NULL) {
+      return false;
+    }
+    *spans = grown;
+    *capacity = newCapacity;
+  }
+  (*spans)[(*count)++] = span;
+  return true;
+}
+
+// Appends the cells whose wall quadrants a wall change in each span touches
+static void visitWallSpans(const TileChangeSpan *spans, int spanCount,
+                           int visitedTiles[][2], int *visitedCount) {
+  for (int i = 0; i < spanCount; i++) {
+    int spanX = spans[i].x;
+    for (int cellY = spans[i].y; cellY < spans[i].y + spans[i].length;
+         cellY++) {
+      visitCell(visitedTiles, visitedCount, spanX, cellY);
+      visitCell(visitedTiles, visitedCount, spanX, cellY - 1);
+      visitCell(visitedTiles, visitedCount, spanX - 1, cellY);
+      visitCell(visitedTiles, visitedCount, spanX - 1, cellY - 1);
+    }
+  }
+}
+
+// Cells a region's neighbourhood can hold: the 3x3 block around each cell,
+// or 4x4 for walls whose re-oriented neighbours change their own quadrants
+static long visitedLimit(int plane, int cellCount) {
+  long limit = (long)cellCount * (plane == 0 ? 9 : 16);
+  return limit < (long)GRID_SIZE * GRID_SIZE ? limit
+                                             : (long)GRID_SIZE * GRID_SIZE;
+}
+
+// Fill functions
+// Replaces the 4- or 8-connected region of the clicked cell's tile (or wall)
+// key with the active key. The region is found one column run at a time
+// from an explicit seed stack, recorded as one span batch, and only the
+// cells along its border have their edges recomputed. Returns the number of
+// cells filled.
+int floodFill(Map *map, DrawingState *drawState, UndoRedoManager *manager,
+              int x, int y, Tile tileTypes[], Edge edgeTypes[],
+              Wall wallTypes[]) {
+  int plane = drawState->drawType == DRAW_TILE ? 0 : 2;
+  int target = map->grid[x][y][plane];
+  int replacement = drawState->drawType == DRAW_TILE ? drawState->activeTileKey
+                                                     : drawState->activeWallKey;
+  if (target == replacement) {
+    printf("Region already has key %d\n", target);
+    return 0;
+  }
+
+  traceBegin("floodFill");
+
+  // Scanline search of the region
+  int reach = drawState->fillConnectivity == 8 ? 1 : 0;
+  FillStack stack = {0};
+  TileChangeSpan *spans = NULL;
+  int spanCount = 0;
+  int spanCapacity = 0;
+  int cellCount = 0;
+  bool ok = pushSeed(&stack, x, y);
+
+  while (ok && stack.count > 0) {
+    stack.count--;
+    int seedX = stack.seeds[stack.count][0];
+    int seedY = stack.seeds[stack.count][1];
+    if (!isFillable(map, plane, target, seedX, seedY)) {
+      continue;
+    }
+
+    // Extend the run up and down the column
+    int startY = seedY;
+    int endY = seedY;
+    while (startY > 0 && isFillable(map, plane, target, seedX, startY - 1)) {
+      startY--;
+    }
+    while (endY < GRID_SIZE - 1 &&
+           isFillable(map, plane, target, seedX, endY + 1)) {
+      endY++;
+    }
+    for (int cellY = startY; cellY <= endY; cellY++) {
+      setFilled(seedX, cellY, true);
+    }
+
+    TileChangeSpan span = {seedX, startY, endY - startY + 1, target,
+                           replacement};
+    cellCount += span.length;
+    ok = pushSpan(&spans, &spanCount, &spanCapacity, span) &&
+         pushColumnRuns(&stack, map, plane, target, seedX - 1, startY - reach,
+                        endY + reach) &&
+         pushColumnRuns(&stack, map, plane, target, seedX + 1, startY - reach,
+                        endY + reach);
+  }
+  free(stack.seeds);
+
+  // Neighbourhood to recompute: edges change only where the region meets
+  // other cells, wall quadrants wherever a wall key changes
+  long visitedCapacity = visitedLimit(plane, cellCount);
+  unsigned char *oldStyles = NULL;
+  unsigned char *newStyles = NULL;
+  int (*visitedTiles)[2] =
+      ok ? (int (*)[2])malloc(visitedCapacity * sizeof(int[2])) : NULL;
+  // Hashed styles follow from the cells, so no new styles are recorded
+  bool storeNewStyles = plane == 0 && !tileStylesImplied();
+  if (ok && plane == 0) {
+    oldStyles = (unsigned char *)malloc(cellCount);
+  }
+  if (ok && storeNewStyles) {
+    newStyles = (unsigned char *)malloc(cellCount);
+  }
+  if (visitedTiles == NULL ||
+      (plane == 0 && (!oldStyles || (storeNewStyles && !newStyles)))) {
+    printf("Memory allocation failed\n");
+    for (int i = 0; i < spanCount; i++) {
+      for (int cellY = spans[i].y; cellY < spans[i].y + spans[i].length;
+           cellY++) {
+        setFilled(spans[i].x, cellY, false);
+      }
+    }
+    free(spans);
+    free(visitedTiles);
+    free(oldStyles);
+    free(newStyles);
+    traceEnd("floodFill");
+    return 0;
+  }
+
+  // Write the region and collect its neighbourhood
+  int visitedCount = 0;
+  int cell = 0;
+  for (int i = 0; i < spanCount; i++) {
+    int spanX = spans[i].x;
+    for (int cellY = spans[i].y; cellY < spans[i].y + spans[i].length;
+         cellY++, cell++) {
+      markCellDirty(map, spanX, cellY);
+      keyIndexUpdate(map, drawState->drawType, spanX, cellY, target,
+                     replacement);
+      if (plane == 0) {
+        int style = pickTileStyle(replacement, tileTypes);
+        oldStyles[cell] = packTileStyle(map->grid[spanX][cellY][1]);
+        if (storeNewStyles) {
+          newStyles[cell] = packTileStyle(style);
+        }
+        map->grid[spanX][cellY][0] = replacement;
+        map->grid[spanX][cellY][1] = style;
+
+        for (int nx = spanX - 1; nx <= spanX + 1; nx++) {
+          for (int ny = cellY - 1; ny <= cellY + 1; ny++) {
+            if (nx >= 0 && ny >= 0 && nx < GRID_SIZE && ny < GRID_SIZE &&
+                !isFilled(nx, ny)) {
+              visitCell(visitedTiles, &visitedCount, spanX, cellY);
+              visitCell(visitedTiles, &visitedCount, nx, ny);
+            }
+          }
+        }
+      } else {
+        map->grid[spanX][cellY][2] = replacement;
+      }
+    }
+  }
+  if (plane == 2) {
+    visitWallSpans(spans, spanCount, visitedTiles, &visitedCount);
+  }
+  setVisitedBits(visitedTiles, visitedCount, false);
+
+  // Clear the region's bits for the next fill
+  for (int i = 0; i < spanCount; i++) {
+    for (int cellY = spans[i].y; cellY < spans[i].y + spans[i].length;
+         cellY++) {
+      setFilled(spans[i].x, cellY, false);
+    }
+  }
+
+  if (plane == 0) {
+    computeEdges(visitedTiles, visitedCount, map, tileTypes, edgeTypes);
+  } else {
+    // Autotiled walls split the runs and re-orient walls around the region
+    if (autotileSpans(map, &spans, &spanCount) > 0) {
+      setVisitedBits(visitedTiles, visitedCount, true);
+      visitWallSpans(spans, spanCount, visitedTiles, &visitedCount);
+      setVisitedBits(visitedTiles, visitedCount, false);
+    }
+    computeWalls(visitedTiles, visitedCount, map, wallTypes);
+  }
+  createSpanChangeBatch(manager, drawState->drawType, spans, spanCount,
+                        oldStyles, newStyles, visitedTiles, visitedCount);
+  free(visitedTiles);
+
+  printf("Filled %d cells in %d runs\n", cellCount, spanCount);
+  traceEnd("floodFill");
+  return cellCount;
+}
+
+// Replace functions
+// Replaces every cell of one tile (or wall) key with another, visiting only
+// the chunks the key index lists for the old key. Recorded as one span
+// batch; returns the number of cells replaced.
+int replaceKey(Map *map, UndoRedoManager *manager, DrawType drawType,
+               int oldKey, int newKey, Tile tileTypes[], Edge edgeTypes[],
+               Wall wallTypes[]) {
+  if (map != keyIndex.owner) {
+    printf("Key index unavailable\n");
+    return 0;
+  }
+  if (oldKey == newKey) {
+    return 0;
+  }
+
+  traceBegin("replaceKey");
+  int plane = drawType == DRAW_TILE ? 0 : 2;
+
+  // Column runs of matching cells in the indexed chunks
+  TileChangeSpan *spans = NULL;
+  int spanCount = 0;
+  int spanCapacity = 0;
+  int cellCount = 0;
+  bool ok = true;
+  for (int cx = 0; cx < CHUNK_COUNT && ok; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT && ok; cy++) {
+      if (!keyIndexChunkHas(drawType, oldKey, cx, cy)) {
+        continue;
+      }
+      int endX = (cx + 1) * CHUNK_SIZE < GRID_SIZE ? (cx + 1) * CHUNK_SIZE
+                                                   : GRID_SIZE;
+      int endY = (cy + 1) * CHUNK_SIZE < GRID_SIZE ? (cy + 1) * CHUNK_SIZE
+                                                   : GRID_SIZE;
+      for (int x = cx * CHUNK_SIZE; x < endX && ok; x++) {
+        int y = cy * CHUNK_SIZE;
+        while (y < endY && ok) {
+          if (map->grid[x][y][plane] != oldKey) {
+            y++;
+            continue;
+          }
+          int startY = y;
+          while (y < endY && map->grid[x][y][plane] == oldKey) {
+            y++;
+          }
+          TileChangeSpan span = {x, startY, y - startY, oldKey, newKey};
+          cellCount += span.length;
+          ok = pushSpan(&spans, &spanCount, &spanCapacity, span);
+        }
+      }
+    }
+  }
+
+  long visitedCapacity = visitedLimit(plane, cellCount);
+  unsigned char *oldStyles = NULL;
+  unsigned char *newStyles = NULL;
+  int (*visitedTiles)[2] =
+      ok ? (int (*)[2])malloc(visitedCapacity * sizeof(int[2])) : NULL;
+  bool storeNewStyles = plane == 0 && !tileStylesImplied();
+  if (ok && plane == 0) {
+    oldStyles = (unsigned char *)malloc(cellCount);
+  }
+  if (ok && storeNewStyles) {
+    newStyles = (unsigned char *)malloc(cellCount);
+  }
+  if (cellCount == 0 || visitedTiles == NULL ||
+      (plane == 0 && (!oldStyles || (storeNewStyles && !newStyles)))) {
+    if (cellCount > 0) {
+      printf("Memory allocation failed\n");
+    }
+    free(spans);
+    free(visitedTiles);
+    free(oldStyles);
+    free(newStyles);
+    traceEnd("replaceKey");
+    return 0;
+  }
+
+  // Neighbourhood to recompute, found before any cell changes: edges only
+  // where replaced cells meet other keys, wall quadrants around every cell
+  int visitedCount = 0;
+  if (plane == 0) {
+    for (int i = 0; i < spanCount; i++) {
+      int spanX = spans[i].x;
+      for (int cellY = spans[i].y; cellY < spans[i].y + spans[i].length;
+           cellY++) {
+        for (int nx = spanX - 1; nx <= spanX + 1; nx++) {
+          for (int ny = cellY - 1; ny <= cellY + 1; ny++) {
+            if (nx >= 0 && ny >= 0 && nx < GRID_SIZE && ny < GRID_SIZE &&
+                map->grid[nx][ny][0] != oldKey) {
+              visitCell(visitedTiles, &visitedCount, spanX, cellY);
+              visitCell(visitedTiles, &visitedCount, nx, ny);
+            }
+          }
+        }
+      }
+    }
+  } else {
+    visitWallSpans(spans, spanCount, visitedTiles, &visitedCount);
+  }
+  setVisitedBits(visitedTiles, visitedCount, false);
+
+  // Write the new key
+  int cell = 0;
+  for (int i = 0; i < spanCount; i++) {
+    int spanX = spans[i].x;
+    for (int cellY = spans[i].y; cellY < spans[i].y + spans[i].length;
+         cellY++, cell++) {
+      markCellDirty(map, spanX, cellY);
+      keyIndexUpdate(map, drawType, spanX, cellY, oldKey, newKey);
+      if (plane == 0) {
+        int style = pickTileStyle(newKey, tileTypes);
+        oldStyles[cell] = packTileStyle(map->grid[spanX][cellY][1]);
+        if (storeNewStyles) {
+          newStyles[cell] = packTileStyle(style);
+        }
+        map->grid[spanX][cellY][0] = newKey;
+        map->grid[spanX][cellY][1] = style;
+      } else {
+        map->grid[spanX][cellY][2] = newKey;
+      }
+    }
+  }
+
+  if (plane == 0) {
+    computeEdges(visitedTiles, visitedCount, map, tileTypes, edgeTypes);
+  } else {
+    if (autotileSpans(map, &spans, &spanCount) > 0) {
+      setVisitedBits(visitedTiles, visitedCount, true);
+      visitWallSpans(spans, spanCount, visitedTiles, &visitedCount);
+      setVisitedBits(visitedTiles, visitedCount, false);
+    }
+    computeWalls(visitedTiles, visitedCount, map, wallTypes);
+  }
+  createSpanChangeBatch(manager, drawType, spans, spanCount, oldStyles,
+                        newStyles, visitedTiles, visitedCount);
+  free(visitedTiles);
+
+  traceEnd("replaceKey");
+  return cellCount;
+}
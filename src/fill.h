@@ -0,0 +1,19 @@
+// fill.h
+#ifndef FILL_H
+#define FILL_H
+
+// includes
+#include "database.h"
+#include "draw.h"
+#include "undo.h"
+
+// functions
+int floodFill(Map *map, DrawingState *drawState, UndoRedoManager *manager,
+              int x, int y, Tile tileTypes[], Edge edgeTypes[],
+              Wall wallTypes[]);
+
+int replaceKey(Map *map, UndoRedoManager *manager, DrawType drawType,
+               int oldKey, int newKey, Tile tileTypes[], Edge edgeTypes[],
+               Wall wallTypes[]);
+
+#endif // FILL_H
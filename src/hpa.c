@@ -0,0 +1,703 @@
+// hpa.c
+#include "hpa.h"
+#include "chunk.h"
+#include "trace.h"
+#include "walkmap.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+HpaGraph hpaGraph = {0};
+
+typedef struct {
+  float f;
+  int id;
+} HpaOpen;
+
+// Binary min-heap on f
+typedef struct {
+  HpaOpen *items;
+  int count;
+  int capacity;
+} HpaHeap;
+
+// Abstract search state kept between queries. Slots are chunk index *
+// HPA_NODE_MAX + node, then the start and the goal; a slot's g and parent
+// are valid only while its opened stamp is the current search.
+typedef struct {
+  float *g;
+  int *parent;
+  unsigned int *opened;
+  unsigned int *closed;
+  unsigned int id;
+  int slotCount;
+  HpaHeap open;
+} HpaSearch;
+
+static HpaSearch search = {0};
+
+// Chunk-local search results, indexed x * CHUNK_SIZE + y within the chunk
+static float localDist[CHUNK_SIZE * CHUNK_SIZE];
+static short localParent[CHUNK_SIZE * CHUNK_SIZE];
+static HpaHeap localHeap = {0};
+
+// Moves open from each cell of the loaded chunk, a bit per localSteps entry
+static const int localSteps[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
+                                     {0, 1},   {1, -1}, {1, 0},  {1, 1}};
+static unsigned char localMoves[CHUNK_SIZE * CHUNK_SIZE];
+static int loadedChunk = -1;
+static unsigned int loadedVersion;
+static bool loadedAllOpen; // every cell of the loaded chunk is walkable
+
+// Chunks to rebuild in the current hpaUpdate
+static bool rebuildChunks[CHUNK_COUNT][CHUNK_COUNT];
+
+// Helper functions
+static bool heapPush(HpaHeap *heap, int id, float f) {
+  if (heap->count == heap->capacity) {
+    int capacity = heap->capacity ? heap->capacity * 2 : 256;
+    HpaOpen *resized =
+        (HpaOpen *)realloc(heap->items, capacity * sizeof(HpaOpen));
+    if (resized == NULL) {
+      printf("Memory allocation failed\n");
+      return false;
+    }
+    heap->items = resized;
+    heap->capacity = capacity;
+  }
+  int i = heap->count++;
+  while (i > 0 && heap->items[(i - 1) / 2].f > f) {
+    heap->items[i] = heap->items[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  heap->items[i] = (HpaOpen){f, id};
+  return true;
+}
+
+static HpaOpen heapPop(HpaHeap *heap) {
+  HpaOpen top = heap->items[0];
+  HpaOpen last = heap->items[--heap->count];
+  int i = 0;
+  for (;;) {
+    int child = i * 2 + 1;
+    if (child >= heap->count) {
+      break;
+    }
+    if (child + 1 < heap->count &&
+        heap->items[child + 1].f < heap->items[child].f) {
+      child++;
+    }
+    if (heap->items[child].f >= last.f) {
+      break;
+    }
+    heap->items[i] = heap->items[child];
+    i = child;
+  }
+  heap->items[i] = last;
+  return top;
+}
+
+static void chunkSize(int cx, int cy, int *width, int *height) {
+  *width = (cx + 1) * CHUNK_SIZE <= GRID_SIZE ? CHUNK_SIZE
+                                              : GRID_SIZE - cx * CHUNK_SIZE;
+  *height = (cy + 1) * CHUNK_SIZE <= GRID_SIZE ? CHUNK_SIZE
+                                               : GRID_SIZE - cy * CHUNK_SIZE;
+}
+
+// Finds the moves open from each cell of chunk (cx, cy) that stay inside
+// it, unless they are already loaded for the current walk map
+static void loadChunk(int cx, int cy) {
+  if (loadedChunk == cx * CHUNK_COUNT + cy &&
+      loadedVersion == walkMap.version) {
+    return;
+  }
+  loadedChunk = cx * CHUNK_COUNT + cy;
+  loadedVersion = walkMap.version;
+
+  int startX = cx * CHUNK_SIZE;
+  int startY = cy * CHUNK_SIZE;
+  int width, height;
+  chunkSize(cx, cy, &width, &height);
+  bool open[CHUNK_SIZE][CHUNK_SIZE] = {0};
+  loadedAllOpen = true;
+  for (int lx = 0; lx < width; lx++) {
+    for (int ly = 0; ly < height; ly++) {
+      open[lx][ly] = walkMapGet(startX + lx, startY + ly);
+      loadedAllOpen = loadedAllOpen && open[lx][ly];
+    }
+  }
+  for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+    for (int ly = 0; ly < CHUNK_SIZE; ly++) {
+      unsigned char moves = 0;
+      for (int s = 0; s < 8 && open[lx][ly]; s++) {
+        int nx = lx + localSteps[s][0];
+        int ny = ly + localSteps[s][1];
+        if (nx >= 0 && nx < CHUNK_SIZE && ny >= 0 && ny < CHUNK_SIZE &&
+            open[nx][ny] && open[nx][ly] && open[lx][ny]) {
+          moves |= 1 << s;
+        }
+      }
+      localMoves[lx * CHUNK_SIZE + ly] = moves;
+    }
+  }
+}
+
+// Shortest paths from (x, y) to the cells of its chunk that stay inside
+// the chunk, into localDist and localParent. Cells out of reach get
+// HPA_NO_PATH; each reached cell's parent leads back towards (x, y). With
+// a chunk given the search stops once its nodes from firstTarget on are
+// reached, and only their costs are final.
+static bool localSearch(int x, int y, const HpaChunk *chunk,
+                        int firstTarget) {
+  int cx = x / CHUNK_SIZE;
+  int cy = y / CHUNK_SIZE;
+  int startX = cx * CHUNK_SIZE;
+  int startY = cy * CHUNK_SIZE;
+  loadChunk(cx, cy);
+  for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; i++) {
+    localDist[i] = HPA_NO_PATH;
+    localParent[i] = -1;
+  }
+
+  int source = (x - startX) * CHUNK_SIZE + (y - startY);
+  int remaining = chunk ? chunk->nodeCount - firstTarget : -1;
+  localDist[source] = 0.0f;
+  localHeap.count = 0;
+  if (!heapPush(&localHeap, source, 0.0f)) {
+    return false;
+  }
+  while (localHeap.count > 0) {
+    HpaOpen node = heapPop(&localHeap);
+    if (node.f > localDist[node.id]) {
+      continue;
+    }
+    if (chunk && chunk->nodeAt[node.id] != HPA_NO_NODE &&
+        chunk->nodeAt[node.id] >= firstTarget && --remaining == 0) {
+      break;
+    }
+    for (int s = 0; s < 8; s++) {
+      if (!(localMoves[node.id] & (1 << s))) {
+        continue;
+      }
+      int dx = localSteps[s][0];
+      int dy = localSteps[s][1];
+      int next = node.id + dx * CHUNK_SIZE + dy;
+      float cost =
+          node.f + (dx != 0 && dy != 0 ? PATHFIND_DIAGONAL_COST : 1.0f);
+      if (localDist[next] < 0.0f || cost < localDist[next]) {
+        localDist[next] = cost;
+        localParent[next] = (short)node.id;
+        if (!heapPush(&localHeap, next, cost)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Offsets along the border between chunk (cx, cy) and its neighbour along
+// x (alongX) or y where entrances cross it: the middle of each open run
+// narrower than HPA_WIDE_RUN and both ends of wider ones. Both chunks
+// derive the same entrances from the walk map.
+static int borderEntrances(int cx, int cy, bool alongX,
+                           int offsets[CHUNK_SIZE]) {
+  int nextX = cx + alongX;
+  int nextY = cy + !alongX;
+  if (cx < 0 || cy < 0 || nextX >= CHUNK_COUNT || nextY >= CHUNK_COUNT) {
+    return 0;
+  }
+  int width, height;
+  chunkSize(cx, cy, &width, &height);
+  int length = alongX ? height : width;
+
+  int count = 0;
+  int runStart = -1;
+  for (int offset = 0; offset <= length; offset++) {
+    bool open = false;
+    if (offset < length && alongX) {
+      int x = nextX * CHUNK_SIZE - 1;
+      int y = cy * CHUNK_SIZE + offset;
+      open = walkMapGet(x, y) && walkMapGet(x + 1, y);
+    } else if (offset < length) {
+      int x = cx * CHUNK_SIZE + offset;
+      int y = nextY * CHUNK_SIZE - 1;
+      open = walkMapGet(x, y) && walkMapGet(x, y + 1);
+    }
+    if (open && runStart < 0) {
+      runStart = offset;
+    } else if (!open && runStart >= 0) {
+      int runLength = offset - runStart;
+      if (runLength < HPA_WIDE_RUN) {
+        offsets[count++] = runStart + runLength / 2;
+      } else {
+        offsets[count++] = runStart;
+        offsets[count++] = offset - 1;
+      }
+      runStart = -1;
+    }
+  }
+  return count;
+}
+
+// Stores the entrances of the border between chunk (cx, cy) and its
+// neighbour along x or y, marking both chunks for rebuilding when they
+// moved
+static void refreshBorder(int cx, int cy, bool alongX) {
+  if (cx < 0 || cy < 0) {
+    return;
+  }
+  int offsets[CHUNK_SIZE];
+  int count = borderEntrances(cx, cy, alongX, offsets);
+  HpaChunk *chunk = &hpaGraph.chunks[cx][cy];
+  int side = alongX ? 0 : 1;
+  bool same = count == chunk->exitCount[side];
+  for (int i = 0; i < count && same; i++) {
+    same = chunk->exits[side][i] == offsets[i];
+  }
+  if (same) {
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    chunk->exits[side][i] = (unsigned char)offsets[i];
+  }
+  chunk->exitCount[side] = (unsigned char)count;
+  rebuildChunks[cx][cy] = true;
+  rebuildChunks[cx + alongX][cy + !alongX] = true;
+}
+
+static void addNode(HpaChunk *chunk, int lx, int ly) {
+  int cell = lx * CHUNK_SIZE + ly;
+  if (chunk->nodeAt[cell] == HPA_NO_NODE) {
+    chunk->nodeAt[cell] = (unsigned char)chunk->nodeCount;
+    chunk->nodeCells[chunk->nodeCount++] = (unsigned short)cell;
+  }
+}
+
+// Finds the entrance cells of chunk (cx, cy) on all four borders and the
+// costs between them
+static void buildChunk(int cx, int cy) {
+  HpaChunk *chunk = &hpaGraph.chunks[cx][cy];
+  hpaGraph.nodeCount -= chunk->nodeCount;
+  chunk->nodeCount = 0;
+  memset(chunk->nodeAt, HPA_NO_NODE, sizeof(chunk->nodeAt));
+
+  int width, height;
+  chunkSize(cx, cy, &width, &height);
+  for (int i = 0; i < chunk->exitCount[0]; i++) {
+    addNode(chunk, width - 1, chunk->exits[0][i]);
+  }
+  for (int i = 0; i < chunk->exitCount[1]; i++) {
+    addNode(chunk, chunk->exits[1][i], height - 1);
+  }
+  if (cx > 0) {
+    const HpaChunk *west = &hpaGraph.chunks[cx - 1][cy];
+    for (int i = 0; i < west->exitCount[0]; i++) {
+      addNode(chunk, 0, west->exits[0][i]);
+    }
+  }
+  if (cy > 0) {
+    const HpaChunk *north = &hpaGraph.chunks[cx][cy - 1];
+    for (int i = 0; i < north->exitCount[1]; i++) {
+      addNode(chunk, north->exits[1][i], 0);
+    }
+  }
+
+  int nodeCount = chunk->nodeCount;
+  if (nodeCount == 0) {
+    free(chunk->dist);
+    chunk->dist = NULL;
+    return;
+  }
+  float *dist = (float *)realloc(chunk->dist,
+                                 nodeCount * nodeCount * sizeof(float));
+  if (dist == NULL) {
+    printf("Memory allocation failed\n");
+    chunk->nodeCount = 0;
+    memset(chunk->nodeAt, HPA_NO_NODE, sizeof(chunk->nodeAt));
+    return;
+  }
+  chunk->dist = dist;
+  // Nothing blocks a straight or diagonal line across an open chunk. Costs
+  // are symmetric, so each search only needs the nodes after its own.
+  loadChunk(cx, cy);
+  for (int i = 0; i < nodeCount; i++) {
+    int cell = chunk->nodeCells[i];
+    dist[i * nodeCount + i] = 0.0f;
+    if (loadedAllOpen) {
+      for (int j = i + 1; j < nodeCount; j++) {
+        int other = chunk->nodeCells[j];
+        dist[i * nodeCount + j] = dist[j * nodeCount + i] = pathfindOctile(
+            cell / CHUNK_SIZE, cell % CHUNK_SIZE, other / CHUNK_SIZE,
+            other % CHUNK_SIZE);
+      }
+      continue;
+    }
+    if (i + 1 < nodeCount) {
+      localSearch(cx * CHUNK_SIZE + cell / CHUNK_SIZE,
+                  cy * CHUNK_SIZE + cell % CHUNK_SIZE, chunk, i + 1);
+    }
+    for (int j = i + 1; j < nodeCount; j++) {
+      dist[i * nodeCount + j] = localDist[chunk->nodeCells[j]];
+      dist[j * nodeCount + i] = dist[i * nodeCount + j];
+    }
+  }
+  hpaGraph.nodeCount += nodeCount;
+}
+
+static bool allocSearch(void) {
+  if (search.g != NULL) {
+    return true;
+  }
+  int slotCount = CHUNK_COUNT * CHUNK_COUNT * HPA_NODE_MAX + 2;
+  search.g = (float *)malloc(slotCount * sizeof(float));
+  search.parent = (int *)malloc(slotCount * sizeof(int));
+  search.opened = (unsigned int *)calloc(slotCount, sizeof(unsigned int));
+  search.closed = (unsigned int *)calloc(slotCount, sizeof(unsigned int));
+  if (search.g == NULL || search.parent == NULL || search.opened == NULL ||
+      search.closed == NULL) {
+    printf("Memory allocation failed\n");
+    free(search.g);
+    free(search.parent);
+    free(search.opened);
+    free(search.closed);
+    memset(&search, 0, sizeof(HpaSearch));
+    return false;
+  }
+  search.slotCount = slotCount;
+  search.id = 0;
+  return true;
+}
+
+static void slotCell(int slot, const int ends[2][2], int *x, int *y) {
+  if (slot >= search.slotCount - 2) {
+    *x = ends[slot - (search.slotCount - 2)][0];
+    *y = ends[slot - (search.slotCount - 2)][1];
+    return;
+  }
+  int chunkIndex = slot / HPA_NODE_MAX;
+  int cx = chunkIndex / CHUNK_COUNT;
+  int cy = chunkIndex % CHUNK_COUNT;
+  int cell = hpaGraph.chunks[cx][cy].nodeCells[slot % HPA_NODE_MAX];
+  *x = cx * CHUNK_SIZE + cell / CHUNK_SIZE;
+  *y = cy * CHUNK_SIZE + cell % CHUNK_SIZE;
+}
+
+static int nodeSlot(int cx, int cy, int node) {
+  return (cx * CHUNK_COUNT + cy) * HPA_NODE_MAX + node;
+}
+
+static bool relax(int slot, int parent, float g, const int ends[2][2]) {
+  if (search.closed[slot] == search.id ||
+      (search.opened[slot] == search.id && g >= search.g[slot])) {
+    return true;
+  }
+  search.opened[slot] = search.id;
+  search.g[slot] = g;
+  search.parent[slot] = parent;
+  int x, y;
+  slotCell(slot, ends, &x, &y);
+  return heapPush(&search.open, slot,
+                  g + pathfindOctile(x, y, ends[1][0], ends[1][1]));
+}
+
+// Appends a cell one step from the last point, extending the last segment
+// when the step keeps its direction
+static bool appendCell(PathfindResult *result, int x, int y) {
+  int count = result->pointCount;
+  if (count >= 2) {
+    int *last = result->points[count - 1];
+    int *before = result->points[count - 2];
+    int stepX = (last[0] > before[0]) - (last[0] < before[0]);
+    int stepY = (last[1] > before[1]) - (last[1] < before[1]);
+    if (x - last[0] == stepX && y - last[1] == stepY) {
+      last[0] = x;
+      last[1] = y;
+      return true;
+    }
+  }
+  if (count == result->pointCapacity) {
+    int capacity = result->pointCapacity ? result->pointCapacity * 2 : 64;
+    int(*resized)[2] =
+        (int(*)[2])realloc(result->points, capacity * sizeof(int[2]));
+    if (resized == NULL) {
+      printf("Memory allocation failed\n");
+      return false;
+    }
+    result->points = resized;
+    result->pointCapacity = capacity;
+  }
+  result->points[count][0] = x;
+  result->points[count][1] = y;
+  result->pointCount++;
+  return true;
+}
+
+// Expands the abstract path ending at the goal slot into cells. Edges
+// inside a chunk are retraced by a local search from their far end.
+static bool refinePath(const int ends[2][2], PathfindResult *result) {
+  int slotCount = 0;
+  for (int slot = search.slotCount - 1; slot >= 0;
+       slot = search.parent[slot]) {
+    slotCount++;
+  }
+  int *slots = (int *)malloc(slotCount * sizeof(int));
+  if (slots == NULL) {
+    printf("Memory allocation failed\n");
+    return false;
+  }
+  int i = slotCount;
+  for (int slot = search.slotCount - 1; slot >= 0;
+       slot = search.parent[slot]) {
+    slots[--i] = slot;
+  }
+
+  bool refined = appendCell(result, ends[0][0], ends[0][1]);
+  for (i = 1; i < slotCount && refined; i++) {
+    int fromX, fromY, toX, toY;
+    slotCell(slots[i - 1], ends, &fromX, &fromY);
+    slotCell(slots[i], ends, &toX, &toY);
+    if (fromX / CHUNK_SIZE != toX / CHUNK_SIZE ||
+        fromY / CHUNK_SIZE != toY / CHUNK_SIZE) {
+      refined = appendCell(result, toX, toY);
+      continue;
+    }
+    refined = localSearch(toX, toY, NULL, 0);
+    int startX = toX / CHUNK_SIZE * CHUNK_SIZE;
+    int startY = toY / CHUNK_SIZE * CHUNK_SIZE;
+    int cell = (fromX - startX) * CHUNK_SIZE + (fromY - startY);
+    int target = (toX - startX) * CHUNK_SIZE + (toY - startY);
+    while (refined && cell != target) {
+      cell = localParent[cell];
+      refined = appendCell(result, startX + cell / CHUNK_SIZE,
+                           startY + cell % CHUNK_SIZE);
+    }
+  }
+  free(slots);
+
+  result->steps = 0;
+  for (i = 1; i < result->pointCount; i++) {
+    int dx = abs(result->points[i][0] - result->points[i - 1][0]);
+    int dy = abs(result->points[i][1] - result->points[i - 1][1]);
+    result->steps += dx > dy ? dx : dy;
+  }
+  return refined;
+}
+
+// HPA functions
+// Rebuilds the chunks marked CHUNK_DIRTY_PATH, and the neighbours whose
+// shared border's entrances moved, building every chunk when the map is
+// new to the graph. Returns true when any chunk was rebuilt.
+bool hpaUpdate(Map *map, Tile tileTypes[]) {
+  walkMapUpdate(map, tileTypes);
+  bool rebuild = hpaGraph.owner != map;
+  if (rebuild) {
+    hpaUnload();
+    for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+      for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+        memset(hpaGraph.chunks[cx][cy].nodeAt, HPA_NO_NODE,
+               sizeof(hpaGraph.chunks[cx][cy].nodeAt));
+      }
+    }
+    hpaGraph.owner = map;
+  }
+
+  traceBegin("hpaUpdate");
+  bool changed = false;
+  memset(rebuildChunks, 0, sizeof(rebuildChunks));
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      if (!rebuild && !chunkIsDirty(map, cx, cy, CHUNK_DIRTY_PATH)) {
+        continue;
+      }
+      clearChunkDirty(map, cx, cy, CHUNK_DIRTY_PATH);
+      rebuildChunks[cx][cy] = true;
+      refreshBorder(cx, cy, true);
+      refreshBorder(cx, cy, false);
+      refreshBorder(cx - 1, cy, true);
+      refreshBorder(cx, cy - 1, false);
+      changed = true;
+    }
+  }
+  for (int cx = 0; changed && cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      if (rebuildChunks[cx][cy]) {
+        buildChunk(cx, cy);
+      }
+    }
+  }
+  traceEnd("hpaUpdate");
+  return changed;
+}
+
+// A* over the chunk entrances, with the start and goal joined to the
+// entrances of their chunks by local searches, then refined to cells. Paths
+// may be slightly longer than the shortest. Returns true when goal is
+// reachable from start.
+bool hpaFind(Map *map, Tile tileTypes[], int startX, int startY, int goalX,
+             int goalY, PathfindResult *result) {
+  hpaUpdate(map, tileTypes);
+  result->pointCount = 0;
+  result->steps = 0;
+  result->cost = 0.0f;
+  result->expanded = 0;
+  result->found = false;
+  if (!walkMapGet(startX, startY) || !walkMapGet(goalX, goalY) ||
+      !allocSearch()) {
+    return false;
+  }
+
+  traceBegin("hpaFind");
+  static float startDist[CHUNK_SIZE * CHUNK_SIZE];
+  static float goalDist[CHUNK_SIZE * CHUNK_SIZE];
+  bool searching = localSearch(goalX, goalY, NULL, 0);
+  memcpy(goalDist, localDist, sizeof(goalDist));
+  searching = searching && localSearch(startX, startY, NULL, 0);
+  memcpy(startDist, localDist, sizeof(startDist));
+
+  // Stamps are cleared only when the search id wraps
+  if (++search.id == 0) {
+    memset(search.opened, 0, search.slotCount * sizeof(unsigned int));
+    memset(search.closed, 0, search.slotCount * sizeof(unsigned int));
+    search.id = 1;
+  }
+  const int ends[2][2] = {{startX, startY}, {goalX, goalY}};
+  int startSlot = search.slotCount - 2;
+  int goalSlot = search.slotCount - 1;
+  int startCx = startX / CHUNK_SIZE;
+  int startCy = startY / CHUNK_SIZE;
+  int goalCx = goalX / CHUNK_SIZE;
+  int goalCy = goalY / CHUNK_SIZE;
+  int goalLocal = (goalX - goalCx * CHUNK_SIZE) * CHUNK_SIZE +
+                  (goalY - goalCy * CHUNK_SIZE);
+  search.open.count = 0;
+  searching = searching && relax(startSlot, -1, 0.0f, ends);
+
+  while (searching && search.open.count > 0) {
+    HpaOpen node = heapPop(&search.open);
+    if (search.closed[node.id] == search.id) {
+      continue;
+    }
+    search.closed[node.id] = search.id;
+    result->expanded++;
+    float g = search.g[node.id];
+    if (node.id == goalSlot) {
+      result->found = refinePath(ends, result);
+      result->cost = g;
+      break;
+    }
+
+    if (node.id == startSlot) {
+      const HpaChunk *chunk = &hpaGraph.chunks[startCx][startCy];
+      for (int i = 0; i < chunk->nodeCount && searching; i++) {
+        float d = startDist[chunk->nodeCells[i]];
+        if (d >= 0.0f) {
+          searching = relax(nodeSlot(startCx, startCy, i), node.id, d, ends);
+        }
+      }
+      if (startCx == goalCx && startCy == goalCy &&
+          startDist[goalLocal] >= 0.0f) {
+        searching = searching &&
+                    relax(goalSlot, node.id, startDist[goalLocal], ends);
+      }
+      continue;
+    }
+
+    int chunkIndex = node.id / HPA_NODE_MAX;
+    int cx = chunkIndex / CHUNK_COUNT;
+    int cy = chunkIndex % CHUNK_COUNT;
+    int i = node.id % HPA_NODE_MAX;
+    const HpaChunk *chunk = &hpaGraph.chunks[cx][cy];
+    for (int j = 0; j < chunk->nodeCount && searching; j++) {
+      float d = chunk->dist[i * chunk->nodeCount + j];
+      if (j != i && d >= 0.0f) {
+        searching = relax(nodeSlot(cx, cy, j), node.id, g + d, ends);
+      }
+    }
+
+    // Entrances on the other side of a border are one step away
+    int x, y;
+    slotCell(node.id, ends, &x, &y);
+    const int steps[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    for (int s = 0; s < 4 && searching; s++) {
+      int nx = x + steps[s][0];
+      int ny = y + steps[s][1];
+      int ncx = nx / CHUNK_SIZE;
+      int ncy = ny / CHUNK_SIZE;
+      if (nx < 0 || nx >= GRID_SIZE || ny < 0 || ny >= GRID_SIZE ||
+          (ncx == cx && ncy == cy)) {
+        continue;
+      }
+      int next = hpaGraph.chunks[ncx][ncy]
+                     .nodeAt[(nx - ncx * CHUNK_SIZE) * CHUNK_SIZE +
+                             (ny - ncy * CHUNK_SIZE)];
+      if (next != HPA_NO_NODE) {
+        searching = relax(nodeSlot(ncx, ncy, next), node.id, g + 1.0f, ends);
+      }
+    }
+
+    if (cx == goalCx && cy == goalCy &&
+        goalDist[chunk->nodeCells[i]] >= 0.0f) {
+      searching = searching && relax(goalSlot, node.id,
+                                     g + goalDist[chunk->nodeCells[i]], ends);
+    }
+  }
+  traceEnd("hpaFind");
+  return result->found;
+}
+
+// Writes the graph for loading at run time, in the host's byte order: the
+// magic, GRID_SIZE and CHUNK_SIZE as 32-bit integers, then for each chunk,
+// x-major, a 16-bit node count, each node's cell as 16-bit x * CHUNK_SIZE +
+// y within the chunk and the node-to-node costs as 32-bit floats. Returns
+// the number of nodes written, or -1 on error.
+int hpaExport(Map *map, Tile tileTypes[], const char *path) {
+  hpaUpdate(map, tileTypes);
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    printf("Error opening HPA output %s\n", path);
+    return -1;
+  }
+
+  int32_t header[3] = {HPA_FILE_MAGIC, GRID_SIZE, CHUNK_SIZE};
+  bool written = fwrite(header, sizeof(header), 1, file) == 1;
+  for (int cx = 0; cx < CHUNK_COUNT && written; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT && written; cy++) {
+      const HpaChunk *chunk = &hpaGraph.chunks[cx][cy];
+      size_t nodeCount = chunk->nodeCount;
+      uint16_t count = (uint16_t)nodeCount;
+      written = fwrite(&count, sizeof(count), 1, file) == 1 &&
+                (nodeCount == 0 ||
+                 (fwrite(chunk->nodeCells, sizeof(unsigned short),
+                         nodeCount, file) == nodeCount &&
+                  fwrite(chunk->dist, sizeof(float), nodeCount * nodeCount,
+                         file) == nodeCount * nodeCount));
+    }
+  }
+  if (fclose(file) != 0 || !written) {
+    printf("Error writing HPA output %s\n", path);
+    return -1;
+  }
+  return hpaGraph.nodeCount;
+}
+
+void hpaUnload(void) {
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      free(hpaGraph.chunks[cx][cy].dist);
+    }
+  }
+  memset(&hpaGraph, 0, sizeof(HpaGraph));
+  free(search.g);
+  free(search.parent);
+  free(search.opened);
+  free(search.closed);
+  free(search.open.items);
+  memset(&search, 0, sizeof(HpaSearch));
+  free(localHeap.items);
+  memset(&localHeap, 0, sizeof(HpaHeap));
+  loadedChunk = -1;
+}
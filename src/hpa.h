@@ -0,0 +1,53 @@
+// hpa.h
+#ifndef HPA_H
+#define HPA_H
+
+// includes
+#include "database.h"
+#include "pathfind.h"
+#include <stdbool.h>
+
+// definitions
+#define HPA_NODE_MAX (4 * CHUNK_SIZE) // entrance cells per chunk
+#define HPA_WIDE_RUN 6    // open border runs this wide get two entrances
+#define HPA_NO_NODE 0xff  // HpaChunk.nodeAt of cells without a node
+#define HPA_NO_PATH -1.0f // HpaChunk.dist between unconnected nodes
+#define HPA_FILE_MAGIC 0x31415048 // "HPA1" read little-endian
+
+// structs
+// Abstract nodes of one chunk: its cells at entrances through its borders,
+// with the cost of the shortest path between each pair that stays inside
+// the chunk
+typedef struct {
+  int nodeCount;
+  unsigned short nodeCells[HPA_NODE_MAX]; // x * CHUNK_SIZE + y in chunk
+  unsigned char nodeAt[CHUNK_SIZE * CHUNK_SIZE]; // node of each cell
+  float *dist; // [nodeCount][nodeCount], HPA_NO_PATH when unconnected
+  unsigned char exits[2][CHUNK_SIZE]; // entrances on the +x and +y borders
+  unsigned char exitCount[2];
+} HpaChunk;
+
+// Abstraction of the walk map for hierarchical path queries. Nodes in
+// neighbouring chunks on adjacent cells are joined at cost 1. Chunks marked
+// CHUNK_DIRTY_PATH, and neighbours whose shared border's entrances moved,
+// are rebuilt by hpaUpdate.
+typedef struct {
+  const Map *owner;
+  HpaChunk chunks[CHUNK_COUNT][CHUNK_COUNT];
+  int nodeCount; // across all chunks
+} HpaGraph;
+
+// globals
+extern HpaGraph hpaGraph;
+
+// functions
+bool hpaUpdate(Map *map, Tile tileTypes[]);
+
+bool hpaFind(Map *map, Tile tileTypes[], int startX, int startY, int goalX,
+             int goalY, PathfindResult *result);
+
+int hpaExport(Map *map, Tile tileTypes[], const char *path);
+
+void hpaUnload(void);
+
+#endif // HPA_H
@@ -0,0 +1,156 @@
+// input.c
+#include "input.h"
+#include "database.h"
+#include <raylib.h>
+#include <stdio.h>
+#include <string.h>
+
+// Variables
+static const char recordingMagic[8] = "MEINPUT1";
+
+// Helper functions
+static bool testBit(const unsigned char *bits, int index) {
+  if (index < 0 || index >= INPUT_KEY_COUNT) {
+    return false;
+  }
+  return (bits[index / 8] >> (index % 8)) & 1;
+}
+
+static void setBit(unsigned char *bits, int index) {
+  bits[index / 8] |= (unsigned char)(1 << (index % 8));
+}
+
+// Input functions
+void pollInput(InputFrame *input) {
+  memset(input, 0, sizeof(InputFrame));
+
+  input->frameTime = GetFrameTime();
+  input->screenWidth = GetScreenWidth();
+  input->screenHeight = GetScreenHeight();
+  input->mousePos = GetMousePosition();
+  input->wheel = GetMouseWheelMove();
+
+  for (int button = 0; button < INPUT_BUTTON_COUNT; button++) {
+    if (IsMouseButtonDown(button))
+      input->buttonsDown |= (unsigned char)(1 << button);
+    if (IsMouseButtonPressed(button))
+      input->buttonsPressed |= (unsigned char)(1 << button);
+    if (IsMouseButtonReleased(button))
+      input->buttonsReleased |= (unsigned char)(1 << button);
+  }
+
+  for (int key = 1; key < INPUT_KEY_COUNT; key++) {
+    if (IsKeyDown(key))
+      setBit(input->keysDown, key);
+    if (IsKeyPressed(key))
+      setBit(input->keysPressed, key);
+  }
+
+  // Drain the character queue
+  int key = GetCharPressed();
+  while (key > 0) {
+    if (input->charCount < INPUT_MAX_CHARS) {
+      input->chars[input->charCount] = key;
+      input->charCount++;
+    }
+    key = GetCharPressed();
+  }
+}
+
+bool inputKeyDown(const InputFrame *input, int key) {
+  return testBit(input->keysDown, key);
+}
+
+bool inputKeyPressed(const InputFrame *input, int key) {
+  return testBit(input->keysPressed, key);
+}
+
+bool inputMouseButtonDown(const InputFrame *input, int button) {
+  return (input->buttonsDown >> button) & 1;
+}
+
+bool inputMouseButtonPressed(const InputFrame *input, int button) {
+  return (input->buttonsPressed >> button) & 1;
+}
+
+bool inputMouseButtonReleased(const InputFrame *input, int button) {
+  return (input->buttonsReleased >> button) & 1;
+}
+
+// True when nothing is held, pressed, typed, scrolled, moved or resized
+bool inputIsIdle(const InputFrame *input, const InputFrame *previous) {
+  if (input->buttonsDown || input->buttonsPressed || input->buttonsReleased ||
+      input->charCount > 0 || input->wheel != 0.0f) {
+    return false;
+  }
+  if (input->mousePos.x != previous->mousePos.x ||
+      input->mousePos.y != previous->mousePos.y ||
+      input->screenWidth != previous->screenWidth ||
+      input->screenHeight != previous->screenHeight) {
+    return false;
+  }
+  for (int i = 0; i < INPUT_KEY_COUNT / 8; i++) {
+    if (input->keysDown[i] || input->keysPressed[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Recording functions
+FILE *inputRecordingCreate(const char *path, InputRecordingHeader *header) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    printf("Error opening recording %s\n", path);
+    return NULL;
+  }
+
+  header->gridSize = GRID_SIZE;
+  header->frameSize = (int)sizeof(InputFrame);
+  if (fwrite(recordingMagic, sizeof(recordingMagic), 1, file) != 1 ||
+      fwrite(header, sizeof(InputRecordingHeader), 1, file) != 1) {
+    printf("Error writing recording header\n");
+    fclose(file);
+    return NULL;
+  }
+
+  printf("Recording input to %s (seed %u)\n", path, header->seed);
+  return file;
+}
+
+FILE *inputRecordingOpen(const char *path, InputRecordingHeader *header) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    printf("Error opening recording %s\n", path);
+    return NULL;
+  }
+
+  char magic[sizeof(recordingMagic)];
+  if (fread(magic, sizeof(magic), 1, file) != 1 ||
+      memcmp(magic, recordingMagic, sizeof(magic)) != 0 ||
+      fread(header, sizeof(InputRecordingHeader), 1, file) != 1) {
+    printf("Error: %s is not an input recording\n", path);
+    fclose(file);
+    return NULL;
+  }
+
+  if (header->gridSize != GRID_SIZE ||
+      header->frameSize != (int)sizeof(InputFrame)) {
+    printf("Error: recording made with GRID_SIZE %d, frame size %d "
+           "(expected %d, %d)\n",
+           header->gridSize, header->frameSize, GRID_SIZE,
+           (int)sizeof(InputFrame));
+    fclose(file);
+    return NULL;
+  }
+
+  return file;
+}
+
+bool inputRecordingWrite(FILE *file, const InputFrame *input) {
+  return fwrite(input, sizeof(InputFrame), 1, file) == 1;
+}
+
+bool inputRecordingRead(FILE *file, InputFrame *input) {
+  return fread(input, sizeof(InputFrame), 1, file) == 1;
+}
@@ -0,0 +1,62 @@
+// input.h
+#ifndef INPUT_H
+#define INPUT_H
+
+// includes
+#include <raylib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// definitions
+#define INPUT_KEY_COUNT 512 // raylib key codes are below 512
+#define INPUT_MAX_CHARS 16  // queued characters kept per frame
+#define INPUT_BUTTON_COUNT 3
+
+// structs
+// Everything the editor reads from raylib during one frame
+typedef struct {
+  float frameTime;
+  int screenWidth;
+  int screenHeight;
+  Vector2 mousePos;
+  float wheel;
+  unsigned char buttonsDown;     // bit per MouseButton
+  unsigned char buttonsPressed;  // bit per MouseButton
+  unsigned char buttonsReleased; // bit per MouseButton
+  unsigned char keysDown[INPUT_KEY_COUNT / 8];
+  unsigned char keysPressed[INPUT_KEY_COUNT / 8];
+  int charCount;
+  int chars[INPUT_MAX_CHARS];
+} InputFrame;
+
+typedef struct {
+  unsigned int seed;  // RNG seed used by getRandTileStyle
+  int gridSize;       // GRID_SIZE of the recording build
+  int frameSize;      // sizeof(InputFrame) of the recording build
+  char mapTable[64];  // map table loaded at startup
+} InputRecordingHeader;
+
+// functions
+void pollInput(InputFrame *input);
+
+bool inputKeyDown(const InputFrame *input, int key);
+
+bool inputKeyPressed(const InputFrame *input, int key);
+
+bool inputMouseButtonDown(const InputFrame *input, int button);
+
+bool inputMouseButtonPressed(const InputFrame *input, int button);
+
+bool inputMouseButtonReleased(const InputFrame *input, int button);
+
+bool inputIsIdle(const InputFrame *input, const InputFrame *previous);
+
+FILE *inputRecordingCreate(const char *path, InputRecordingHeader *header);
+
+FILE *inputRecordingOpen(const char *path, InputRecordingHeader *header);
+
+bool inputRecordingWrite(FILE *file, const InputFrame *input);
+
+bool inputRecordingRead(FILE *file, InputFrame *input);
+
+#endif // INPUT_H
@@ -0,0 +1,97 @@
+// keyindex.c
+#include "keyindex.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Variables
+KeyIndex keyIndex = {0};
+
+// Helper functions
+// Count of key's cells in chunk (cx, cy), or NULL for keys out of range
+static unsigned short *chunkCount(DrawType drawType, int key, int cx,
+                                  int cy) {
+  unsigned short *counts;
+  int keyCount;
+  switch (drawType) {
+  case DRAW_TILE:
+    counts = keyIndex.tileCounts;
+    keyCount = keyIndex.tileKeyCount;
+    break;
+  case DRAW_WALL:
+  default:
+    counts = keyIndex.wallCounts;
+    keyCount = keyIndex.wallKeyCount;
+    break;
+  }
+  if (counts == NULL || key < 0 || key >= keyCount) {
+    return NULL;
+  }
+  return &counts[((size_t)key * CHUNK_COUNT + cx) * CHUNK_COUNT + cy];
+}
+
+// Key index functions
+// Counts every cell of the map, which becomes the index's owner. Call after
+// the tile and wall types are loaded and whenever the whole map is replaced.
+void keyIndexBuild(const Map *map) {
+  keyIndexUnload();
+
+  size_t chunks = (size_t)CHUNK_COUNT * CHUNK_COUNT;
+  keyIndex.tileKeyCount = map->maxTileKey + 1;
+  keyIndex.wallKeyCount = map->maxWallKey + 1;
+  keyIndex.tileCounts = (unsigned short *)calloc(
+      keyIndex.tileKeyCount * chunks, sizeof(unsigned short));
+  keyIndex.wallCounts = (unsigned short *)calloc(
+      keyIndex.wallKeyCount * chunks, sizeof(unsigned short));
+  if (keyIndex.tileCounts == NULL || keyIndex.wallCounts == NULL) {
+    printf("Memory allocation failed\n");
+    keyIndexUnload();
+    return;
+  }
+
+  for (int x = 0; x < GRID_SIZE; x++) {
+    for (int y = 0; y < GRID_SIZE; y++) {
+      int cx = x / CHUNK_SIZE;
+      int cy = y / CHUNK_SIZE;
+      unsigned short *tileCount =
+          chunkCount(DRAW_TILE, map->grid[x][y][0], cx, cy);
+      unsigned short *wallCount =
+          chunkCount(DRAW_WALL, map->grid[x][y][2], cx, cy);
+      if (tileCount != NULL) {
+        (*tileCount)++;
+      }
+      if (wallCount != NULL) {
+        (*wallCount)++;
+      }
+    }
+  }
+  keyIndex.owner = map;
+}
+
+// Moves cell (x, y) from oldKey to newKey. Edits of other maps are ignored.
+void keyIndexUpdate(const Map *map, DrawType drawType, int x, int y,
+                    int oldKey, int newKey) {
+  if (map != keyIndex.owner || oldKey == newKey) {
+    return;
+  }
+  int cx = x / CHUNK_SIZE;
+  int cy = y / CHUNK_SIZE;
+  unsigned short *oldCount = chunkCount(drawType, oldKey, cx, cy);
+  unsigned short *newCount = chunkCount(drawType, newKey, cx, cy);
+  if (oldCount != NULL && *oldCount > 0) {
+    (*oldCount)--;
+  }
+  if (newCount != NULL) {
+    (*newCount)++;
+  }
+}
+
+bool keyIndexChunkHas(DrawType drawType, int key, int cx, int cy) {
+  unsigned short *count = chunkCount(drawType, key, cx, cy);
+  return count != NULL && *count > 0;
+}
+
+void keyIndexUnload(void) {
+  free(keyIndex.tileCounts);
+  free(keyIndex.wallCounts);
+  keyIndex = (KeyIndex){0};
+}
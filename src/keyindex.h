@@ -0,0 +1,33 @@
+// keyindex.h
+#ifndef KEYINDEX_H
+#define KEYINDEX_H
+
+// includes
+#include "database.h"
+#include "draw.h"
+#include <stdbool.h>
+
+// structs
+// Cells of each tile and wall key per chunk, for the owning map only
+typedef struct {
+  const Map *owner;
+  int tileKeyCount; // maxTileKey + 1
+  int wallKeyCount; // maxWallKey + 1
+  unsigned short *tileCounts; // [key][cx][cy]
+  unsigned short *wallCounts; // [key][cx][cy]
+} KeyIndex;
+
+// globals
+extern KeyIndex keyIndex;
+
+// functions
+void keyIndexBuild(const Map *map);
+
+void keyIndexUpdate(const Map *map, DrawType drawType, int x, int y,
+                    int oldKey, int newKey);
+
+bool keyIndexChunkHas(DrawType drawType, int key, int cx, int cy);
+
+void keyIndexUnload(void);
+
+#endif // KEYINDEX_H
@@ -0,0 +1,379 @@
+// layer.c
+#include "layer.h"
+#include "chunk.h"
+#include "profile.h"
+#include "tilestyle.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+LayerStack layerStack = {.layers = {{.info = {"ground", true, false}}},
+                         .layerCount = 1};
+
+// Helper functions
+// Level z of a named layer, or NULL while it is empty
+static LayerGrid *getLayerGrid(int layer, int z) {
+  return layerStack.layers[layer].levels[z - LEVEL_MIN];
+}
+
+static LayerChunk *getOrCreateChunk(int layer, int z, int cx, int cy) {
+  LayerGrid **grid = &layerStack.layers[layer].levels[z - LEVEL_MIN];
+  if (*grid == NULL) {
+    *grid = (LayerGrid *)calloc(1, sizeof(LayerGrid));
+    if (*grid == NULL) {
+      printf("Memory allocation failed\n");
+      return NULL;
+    }
+  }
+  if ((*grid)->chunks[cx][cy] == NULL) {
+    (*grid)->chunks[cx][cy] = (LayerChunk *)calloc(1, sizeof(LayerChunk));
+    if ((*grid)->chunks[cx][cy] == NULL) {
+      printf("Memory allocation failed\n");
+      return NULL;
+    }
+    WorldCoords *bounds = &(*grid)->chunkBounds;
+    if ((*grid)->chunkCount++ == 0) {
+      *bounds = (WorldCoords){cx, cy, cx, cy};
+    } else {
+      bounds->startX = cx < bounds->startX ? cx : bounds->startX;
+      bounds->startY = cy < bounds->startY ? cy : bounds->startY;
+      bounds->endX = cx > bounds->endX ? cx : bounds->endX;
+      bounds->endY = cy > bounds->endY ? cy : bounds->endY;
+    }
+  }
+  return (*grid)->chunks[cx][cy];
+}
+
+// Frees a chunk left without tiles, and its level once no chunk is left.
+// The chunk bounds shrink when the chunk was on their edge.
+static void releaseChunk(int layer, int z, int cx, int cy) {
+  LayerGrid **grid = &layerStack.layers[layer].levels[z - LEVEL_MIN];
+  free((*grid)->chunks[cx][cy]);
+  (*grid)->chunks[cx][cy] = NULL;
+  if (--(*grid)->chunkCount == 0) {
+    free(*grid);
+    *grid = NULL;
+    return;
+  }
+
+  WorldCoords old = (*grid)->chunkBounds;
+  if (cx != old.startX && cx != old.endX && cy != old.startY &&
+      cy != old.endY) {
+    return;
+  }
+  WorldCoords bounds = {old.endX, old.endY, old.startX, old.startY};
+  for (int x = old.startX; x <= old.endX; x++) {
+    for (int y = old.startY; y <= old.endY; y++) {
+      if ((*grid)->chunks[x][y] != NULL) {
+        bounds.startX = x < bounds.startX ? x : bounds.startX;
+        bounds.startY = y < bounds.startY ? y : bounds.startY;
+        bounds.endX = x > bounds.endX ? x : bounds.endX;
+        bounds.endY = y > bounds.endY ? y : bounds.endY;
+      }
+    }
+  }
+  (*grid)->chunkBounds = bounds;
+}
+
+static void freeLayer(Layer *layer) {
+  for (int i = 0; i < LEVEL_COUNT; i++) {
+    LayerGrid *grid = layer->levels[i];
+    if (grid == NULL) {
+      continue;
+    }
+    for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+      for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+        free(grid->chunks[cx][cy]);
+      }
+    }
+    free(grid);
+    layer->levels[i] = NULL;
+  }
+}
+
+// Table holding level z of named layer i of a map
+static void layerTableName(char *name, int size, const char *table, int layer,
+                           int z) {
+  char base[192];
+  snprintf(base, sizeof(base), "%s_layer%d", table, layer);
+  levelTableName(name, size, base, z);
+}
+
+// Layer functions
+// Appends an empty, visible named layer. Returns its index, or -1 when the
+// name is taken or the stack is full.
+int layerAdd(const char *name) {
+  if (layerStack.layerCount >= LAYER_MAX || name[0] == '\0' ||
+      layerFind(name) >= 0) {
+    return -1;
+  }
+  int layer = layerStack.layerCount++;
+  Layer *added = &layerStack.layers[layer];
+  memset(added, 0, sizeof(Layer));
+  snprintf(added->info.name, LAYER_NAME_LENGTH, "%s", name);
+  added->info.visible = true;
+  return layer;
+}
+
+int layerFind(const char *name) {
+  for (int i = 0; i < layerStack.layerCount; i++) {
+    if (strcmp(layerStack.layers[i].info.name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Shows or hides a layer. Only chunks holding the layer's tiles on the
+// active level are recomposited. Layers are cosmetic, so only the caches
+// that show them are marked; walkability and the stats summaries stay valid.
+void layerSetVisible(Map *map, int layer, bool visible) {
+  Layer *target = &layerStack.layers[layer];
+  if (target->info.visible == visible) {
+    return;
+  }
+  target->info.visible = visible;
+
+  LayerGrid *grid = layer == 0 ? NULL : getLayerGrid(layer, map->level);
+  if (layer != 0 && grid == NULL) {
+    return;
+  }
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      if (layer == 0 || grid->chunks[cx][cy] != NULL) {
+        setChunkDirty(map, cx, cy, LAYER_DIRTY_FLAGS);
+      }
+    }
+  }
+}
+
+// Layer an edit with the current drawing state writes to. Named layers hold
+// tiles only, so walls always go to the map's grid.
+int layerEditTarget(const DrawingState *drawState) {
+  return drawState->drawType == DRAW_TILE ? drawState->activeLayer : 0;
+}
+
+// Tile key and style of a named layer's cell on the active level, or NULL
+// where its chunk is empty
+const int *layerGetCell(const Map *map, int layer, int x, int y) {
+  LayerGrid *grid = getLayerGrid(layer, map->level);
+  if (grid == NULL) {
+    return NULL;
+  }
+  LayerChunk *chunk = grid->chunks[x / CHUNK_SIZE][y / CHUNK_SIZE];
+  if (chunk == NULL) {
+    return NULL;
+  }
+  return chunk->cells[x % CHUNK_SIZE][y % CHUNK_SIZE];
+}
+
+void layerSetCell(Map *map, int layer, int x, int y, int tileKey,
+                  int tileStyle) {
+  LayerChunk *chunk;
+  if (tileKey == 0) {
+    // Clearing never allocates
+    LayerGrid *grid = getLayerGrid(layer, map->level);
+    chunk = grid ? grid->chunks[x / CHUNK_SIZE][y / CHUNK_SIZE] : NULL;
+  } else {
+    chunk = getOrCreateChunk(layer, map->level, x / CHUNK_SIZE,
+                             y / CHUNK_SIZE);
+  }
+  if (chunk == NULL) {
+    return;
+  }
+  int *cell = chunk->cells[x % CHUNK_SIZE][y % CHUNK_SIZE];
+  chunk->tileCount += (tileKey != 0) - (cell[0] != 0);
+  cell[0] = tileKey;
+  cell[1] = tileStyle;
+  setChunkDirty(map, x / CHUNK_SIZE, y / CHUNK_SIZE, LAYER_DIRTY_FLAGS);
+  if (chunk->tileCount == 0) {
+    releaseChunk(layer, map->level, x / CHUNK_SIZE, y / CHUNK_SIZE);
+  }
+}
+
+// Topmost visible named layer tile of a cell, or NULL
+const int *layerTopCell(const Map *map, int x, int y) {
+  for (int i = layerStack.layerCount - 1; i > 0; i--) {
+    if (!layerStack.layers[i].info.visible) {
+      continue;
+    }
+    const int *cell = layerGetCell(map, i, x, y);
+    if (cell != NULL && cell[0] != 0) {
+      return cell;
+    }
+  }
+  return NULL;
+}
+
+// True when no visible named layer has tiles in chunk (cx, cy) of the
+// active level
+bool layerChunkEmpty(const Map *map, int cx, int cy) {
+  for (int i = 1; i < layerStack.layerCount; i++) {
+    LayerGrid *grid = getLayerGrid(i, map->level);
+    if (layerStack.layers[i].info.visible && grid != NULL &&
+        grid->chunks[cx][cy] != NULL) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Sprite path of the named layers within bounds, bottom layer first. Only
+// chunks holding tiles are visited, and layers without chunks in view are
+// skipped.
+void layerDrawRegion(const Map *map, Tile tileTypes[], WorldCoords bounds) {
+  for (int i = 1; i < layerStack.layerCount; i++) {
+    LayerGrid *grid = getLayerGrid(i, map->level);
+    if (!layerStack.layers[i].info.visible || grid == NULL) {
+      continue;
+    }
+    WorldCoords used = grid->chunkBounds;
+    int startCx = bounds.startX / CHUNK_SIZE > used.startX
+                      ? bounds.startX / CHUNK_SIZE
+                      : used.startX;
+    int startCy = bounds.startY / CHUNK_SIZE > used.startY
+                      ? bounds.startY / CHUNK_SIZE
+                      : used.startY;
+    int endCx =
+        bounds.endX / CHUNK_SIZE < used.endX ? bounds.endX / CHUNK_SIZE
+                                             : used.endX;
+    int endCy =
+        bounds.endY / CHUNK_SIZE < used.endY ? bounds.endY / CHUNK_SIZE
+                                             : used.endY;
+    for (int cx = startCx; cx <= endCx; cx++) {
+      for (int cy = startCy; cy <= endCy; cy++) {
+        LayerChunk *chunk = grid->chunks[cx][cy];
+        if (chunk == NULL) {
+          continue;
+        }
+        int startX = cx * CHUNK_SIZE;
+        int startY = cy * CHUNK_SIZE;
+        for (int x = startX > bounds.startX ? startX : bounds.startX;
+             x < startX + CHUNK_SIZE && x <= bounds.endX; x++) {
+          for (int y = startY > bounds.startY ? startY : bounds.startY;
+               y < startY + CHUNK_SIZE && y <= bounds.endY; y++) {
+            const int *cell = chunk->cells[x - startX][y - startY];
+            if (cell[0] == 0) {
+              continue;
+            }
+            int style = resolveTileStyle(tileTypes, cell[0], cell[1], x, y);
+            Texture2D texture = tileTypes[cell[0]].tex[style];
+            DrawTexture(texture, x * TILE_SIZE, y * TILE_SIZE, WHITE);
+            profileCountDraw(texture);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Loads the layer table of a map and each named layer's tables, one per
+// level. Maps saved without layers have the ground layer only.
+void layerLoad(sqlite3 *db, const char *table, Map *map) {
+  traceBegin("layerLoad");
+  layerUnload();
+
+  char name[256];
+  snprintf(name, sizeof(name), "%s_layers", table);
+  LayerInfo info[LAYER_MAX];
+  int count = loadLayerInfo(db, name, info, LAYER_MAX);
+  if (count > 0) {
+    layerStack.layers[0].info = info[0];
+    layerStack.layerCount = count;
+  }
+
+  for (int i = 1; i < layerStack.layerCount; i++) {
+    layerStack.layers[i].info = info[i];
+    for (int z = LEVEL_MIN; z <= LEVEL_MAX; z++) {
+      layerTableName(name, sizeof(name), table, i, z);
+      int (*rows)[5];
+      int rowCount = loadMapRows(db, name, &rows);
+      for (int j = 0; j < rowCount; j++) {
+        int x = rows[j][0];
+        int y = rows[j][1];
+        if (x < 0 || x >= GRID_SIZE || y < 0 || y >= GRID_SIZE ||
+            rows[j][2] == 0) {
+          continue;
+        }
+        LayerChunk *chunk =
+            getOrCreateChunk(i, z, x / CHUNK_SIZE, y / CHUNK_SIZE);
+        if (chunk != NULL) {
+          int *cell = chunk->cells[x % CHUNK_SIZE][y % CHUNK_SIZE];
+          chunk->tileCount += cell[0] == 0;
+          cell[0] = rows[j][2];
+          cell[1] = rows[j][3];
+        }
+      }
+      free(rows);
+    }
+  }
+  markMapDirty(map);
+  traceEnd("layerLoad");
+}
+
+// Saves the layer table and every non-empty level of each named layer.
+// Tables of empty levels and of layers beyond the last are dropped.
+void layerSave(sqlite3 *db, const char *table) {
+  traceBegin("layerSave");
+  char name[256];
+  snprintf(name, sizeof(name), "%s_layers", table);
+  LayerInfo info[LAYER_MAX];
+  for (int i = 0; i < layerStack.layerCount; i++) {
+    info[i] = layerStack.layers[i].info;
+  }
+  saveLayerInfo(db, name, info, layerStack.layerCount);
+
+  // One buffer large enough for any level of a layer
+  int (*rows)[5] = (int (*)[5])malloc(GRID_SIZE * GRID_SIZE * sizeof(int[5]));
+  if (rows == NULL) {
+    printf("Memory allocation failed\n");
+    traceEnd("layerSave");
+    return;
+  }
+
+  for (int i = 1; i < LAYER_MAX; i++) {
+    for (int z = LEVEL_MIN; z <= LEVEL_MAX; z++) {
+      layerTableName(name, sizeof(name), table, i, z);
+      LayerGrid *grid = i < layerStack.layerCount ? getLayerGrid(i, z) : NULL;
+      int count = 0;
+      for (int cx = 0; grid != NULL && cx < CHUNK_COUNT; cx++) {
+        for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+          LayerChunk *chunk = grid->chunks[cx][cy];
+          for (int x = 0; chunk != NULL && x < CHUNK_SIZE; x++) {
+            for (int y = 0; y < CHUNK_SIZE; y++) {
+              if (chunk->cells[x][y][0] == 0) {
+                continue;
+              }
+              int *row = rows[count++];
+              row[0] = cx * CHUNK_SIZE + x;
+              row[1] = cy * CHUNK_SIZE + y;
+              row[2] = chunk->cells[x][y][0];
+              row[3] = chunk->cells[x][y][1];
+              row[4] = 0;
+            }
+          }
+        }
+      }
+      if (count == 0) {
+        dropMapTable(db, name);
+      } else {
+        saveMapRows(db, name, rows, count);
+      }
+    }
+  }
+  free(rows);
+  traceEnd("layerSave");
+}
+
+// Frees the named layers, leaving the map's grid as the only, visible layer
+void layerUnload(void) {
+  for (int i = 0; i < LAYER_MAX; i++) {
+    freeLayer(&layerStack.layers[i]);
+  }
+  memset(&layerStack, 0, sizeof(LayerStack));
+  snprintf(layerStack.layers[0].info.name, LAYER_NAME_LENGTH, "ground");
+  layerStack.layers[0].info.visible = true;
+  layerStack.layerCount = 1;
+}
@@ -0,0 +1,79 @@
+// layer.h
+#ifndef LAYER_H
+#define LAYER_H
+
+// includes
+#include "chunk.h"
+#include "database.h"
+#include "draw.h"
+#include "grid.h"
+#include "level.h"
+#include <raylib.h>
+#include <sqlite3.h>
+#include <stdbool.h>
+
+// definitions
+#define LAYER_MAX 16 // the map's own grid and up to 15 named layers
+// Caches that show named layer tiles: the chunk meshes, the LOD colours and
+// the minimap summaries
+#define LAYER_DIRTY_FLAGS                                                      \
+  (CHUNK_DIRTY_MESH | CHUNK_DIRTY_LOD | CHUNK_DIRTY_MINIMAP)
+
+// structs
+// Tile key and style of each cell of one chunk of a named layer, column by
+// column like Map.grid. Key 0 is empty.
+typedef struct {
+  int cells[CHUNK_SIZE][CHUNK_SIZE][2];
+  int tileCount; // cells with a tile; the chunk is freed when none is left
+} LayerChunk;
+
+// One level of a named layer; chunks without a tile are NULL, and a level
+// without any chunk is freed
+typedef struct {
+  LayerChunk *chunks[CHUNK_COUNT][CHUNK_COUNT];
+  int chunkCount;
+  WorldCoords chunkBounds; // chunk coordinates around every chunk
+} LayerGrid;
+
+typedef struct {
+  LayerInfo info;
+  LayerGrid *levels[LEVEL_COUNT]; // indexed by z - LEVEL_MIN, NULL if empty
+} Layer;
+
+// Layer 0 is the map's own grid of tiles, edges and walls. Named layers
+// above it hold tiles only and are drawn over it in order.
+typedef struct {
+  Layer layers[LAYER_MAX];
+  int layerCount;
+} LayerStack;
+
+// globals
+extern LayerStack layerStack;
+
+// functions
+int layerAdd(const char *name);
+
+int layerFind(const char *name);
+
+void layerSetVisible(Map *map, int layer, bool visible);
+
+int layerEditTarget(const DrawingState *drawState);
+
+const int *layerGetCell(const Map *map, int layer, int x, int y);
+
+void layerSetCell(Map *map, int layer, int x, int y, int tileKey,
+                  int tileStyle);
+
+const int *layerTopCell(const Map *map, int x, int y);
+
+bool layerChunkEmpty(const Map *map, int cx, int cy);
+
+void layerDrawRegion(const Map *map, Tile tileTypes[], WorldCoords bounds);
+
+void layerLoad(sqlite3 *db, const char *table, Map *map);
+
+void layerSave(sqlite3 *db, const char *table);
+
+void layerUnload(void);
+
+#endif // LAYER_H
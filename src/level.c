@@ -0,0 +1,356 @@
+// level.c
+#include "level.h"
+#include "chunk.h"
+#include "edge.h"
+#include "keyindex.h"
+#include "profile.h"
+#include "tilestyle.h"
+#include "trace.h"
+#include "wall.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+LevelStack levelStack = {0};
+
+// Helper functions
+static Level *getLevel(int z) { return &levelStack.levels[z - LEVEL_MIN]; }
+
+// Ground cells always have a floor; other levels only where there is a tile
+static bool cellHasFloor(int z, const int cell[3]) {
+  return z == 0 || cell[0] != 0;
+}
+
+// Cells worth storing; all-zero cells are implied
+static bool cellIsFilled(const int cell[3]) {
+  return cell[0] != 0 || cell[1] != 0 || cell[2] != 0;
+}
+
+static void chunkBounds(int cx, int cy, WorldCoords *cells) {
+  cells->startX = cx * CHUNK_SIZE;
+  cells->startY = cy * CHUNK_SIZE;
+  cells->endX = cells->startX + CHUNK_SIZE < GRID_SIZE
+                    ? cells->startX + CHUNK_SIZE - 1
+                    : GRID_SIZE - 1;
+  cells->endY = cells->startY + CHUNK_SIZE < GRID_SIZE
+                    ? cells->startY + CHUNK_SIZE - 1
+                    : GRID_SIZE - 1;
+}
+
+static void clearLevel(Level *level) {
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      free(level->chunks[cx][cy]);
+      level->chunks[cx][cy] = NULL;
+    }
+  }
+  level->chunkCount = 0;
+}
+
+static LevelChunk *getOrCreateChunk(Level *level, int cx, int cy) {
+  if (level->chunks[cx][cy] == NULL) {
+    level->chunks[cx][cy] = (LevelChunk *)calloc(1, sizeof(LevelChunk));
+    if (level->chunks[cx][cy] == NULL) {
+      printf("Memory allocation failed\n");
+      return NULL;
+    }
+    level->chunkCount++;
+  }
+  return level->chunks[cx][cy];
+}
+
+// Copies the map's grid into level z, keeping only chunks with filled cells
+static void storeLevel(const Map *map, int z) {
+  Level *level = getLevel(z);
+  clearLevel(level);
+
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      WorldCoords cells;
+      chunkBounds(cx, cy, &cells);
+      bool filled = false;
+      for (int x = cells.startX; x <= cells.endX && !filled; x++) {
+        for (int y = cells.startY; y <= cells.endY && !filled; y++) {
+          filled = cellIsFilled(map->grid[x][y]);
+        }
+      }
+      if (!filled) {
+        continue;
+      }
+
+      LevelChunk *chunk = getOrCreateChunk(level, cx, cy);
+      if (chunk == NULL) {
+        continue;
+      }
+      int height = cells.endY - cells.startY + 1;
+      for (int x = cells.startX; x <= cells.endX; x++) {
+        memcpy(chunk->cells[x - cells.startX], map->grid[x][cells.startY],
+               height * sizeof(int[3]));
+      }
+    }
+  }
+}
+
+// Moves level z's chunks into the map's grid
+static void restoreLevel(Map *map, int z) {
+  Level *level = getLevel(z);
+  memset(map->grid, 0, sizeof(map->grid));
+
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      LevelChunk *chunk = level->chunks[cx][cy];
+      if (chunk == NULL) {
+        continue;
+      }
+      WorldCoords cells;
+      chunkBounds(cx, cy, &cells);
+      int height = cells.endY - cells.startY + 1;
+      for (int x = cells.startX; x <= cells.endX; x++) {
+        memcpy(map->grid[x][cells.startY], chunk->cells[x - cells.startX],
+               height * sizeof(int[3]));
+      }
+    }
+  }
+  clearLevel(level);
+}
+
+// Filled cells of level z as map table rows, read from the map when it
+// holds that level. The caller frees the rows.
+static int levelRows(const Map *map, int z, int (**rows)[5]) {
+  Level *level = getLevel(z);
+  int capacity = z == map->level ? GRID_SIZE * GRID_SIZE
+                                 : level->chunkCount * CHUNK_SIZE * CHUNK_SIZE;
+  *rows = (int (*)[5])malloc((capacity > 0 ? capacity : 1) * sizeof(int[5]));
+  if (*rows == NULL) {
+    printf("Memory allocation failed\n");
+    return 0;
+  }
+
+  int count = 0;
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      LevelChunk *chunk = level->chunks[cx][cy];
+      if (z != map->level && chunk == NULL) {
+        continue;
+      }
+      WorldCoords cells;
+      chunkBounds(cx, cy, &cells);
+      for (int x = cells.startX; x <= cells.endX; x++) {
+        for (int y = cells.startY; y <= cells.endY; y++) {
+          const int *cell =
+              z == map->level
+                  ? map->grid[x][y]
+                  : chunk->cells[x - cells.startX][y - cells.startY];
+          if (cellIsFilled(cell)) {
+            int *row = (*rows)[count++];
+            row[0] = x;
+            row[1] = y;
+            row[2] = cell[0];
+            row[3] = cell[1];
+            row[4] = cell[2];
+          }
+        }
+      }
+    }
+  }
+  return count;
+}
+
+// Draws the tile and base wall sprite of a stored cell
+static void drawLevelCell(int z, const int cell[3], int x, int y,
+                          Tile tileTypes[], Wall wallTypes[], Color tint) {
+  Vector2 pos = {x * TILE_SIZE, y * TILE_SIZE};
+  if (cellHasFloor(z, cell)) {
+    int style = resolveTileStyle(tileTypes, cell[0], cell[1], x, y);
+    Texture2D texture = tileTypes[cell[0]].tex[style];
+    DrawTexture(texture, pos.x, pos.y, tint);
+    profileCountDraw(texture);
+  }
+  if (cell[2] != 0) {
+    Texture2D texture = wallTypes[cell[2]].wallTex[3].tex;
+    DrawTexture(texture, pos.x, pos.y, tint);
+    profileCountDraw(texture);
+  }
+}
+
+// Level functions
+// Makes level z the one held by the map. The current level and its undo
+// history are stored, and the map's derived data is rebuilt for the new one.
+bool levelSwitch(Map *map, UndoRedoManager *manager, int z, Tile tileTypes[],
+                 Edge edgeTypes[], Wall wallTypes[]) {
+  if (map != levelStack.owner || z < LEVEL_MIN || z > LEVEL_MAX) {
+    return false;
+  }
+  if (z == map->level) {
+    return true;
+  }
+  traceBegin("levelSwitch");
+
+  storeLevel(map, map->level);
+  levelStack.history[map->level - LEVEL_MIN] = *manager;
+  restoreLevel(map, z);
+  *manager = levelStack.history[z - LEVEL_MIN];
+  levelStack.history[z - LEVEL_MIN] = (UndoRedoManager){NULL, NULL};
+  map->level = z;
+
+  computeMapEdges(tileTypes, edgeTypes, map);
+  computeMapWalls(wallTypes, map);
+  keyIndexBuild(map);
+  markMapDirty(map);
+
+  traceEnd("levelSwitch");
+  printf("Level %d\n", z);
+  return true;
+}
+
+// Draws the level below through the map's hollow cells. Chunks with a tile
+// in every cell hide everything below them and are skipped whole.
+void levelDrawBelow(Map *map, Tile tileTypes[], Wall wallTypes[],
+                    WorldCoords bounds) {
+  int z = map->level - 1;
+  if (map != levelStack.owner || map->level == 0 || z < LEVEL_MIN ||
+      getLevel(z)->chunkCount == 0) {
+    return;
+  }
+  Level *level = getLevel(z);
+  Color tint = Fade(WHITE, LEVEL_BELOW_ALPHA);
+
+  for (int cx = bounds.startX / CHUNK_SIZE; cx <= bounds.endX / CHUNK_SIZE;
+       cx++) {
+    for (int cy = bounds.startY / CHUNK_SIZE; cy <= bounds.endY / CHUNK_SIZE;
+         cy++) {
+      LevelChunk *chunk = level->chunks[cx][cy];
+      if (chunk == NULL || !keyIndexChunkHas(DRAW_TILE, 0, cx, cy)) {
+        continue;
+      }
+      WorldCoords cells;
+      chunkBounds(cx, cy, &cells);
+      int startX = cells.startX > bounds.startX ? cells.startX : bounds.startX;
+      int startY = cells.startY > bounds.startY ? cells.startY : bounds.startY;
+      int endX = cells.endX < bounds.endX ? cells.endX : bounds.endX;
+      int endY = cells.endY < bounds.endY ? cells.endY : bounds.endY;
+      for (int x = startX; x <= endX; x++) {
+        for (int y = startY; y <= endY; y++) {
+          if (map->grid[x][y][0] != 0) {
+            continue;
+          }
+          drawLevelCell(z, chunk->cells[x - cells.startX][y - cells.startY],
+                        x, y, tileTypes, wallTypes, tint);
+        }
+      }
+    }
+  }
+}
+
+// Draws the level above faintly over the map
+void levelDrawAbove(Map *map, Tile tileTypes[], Wall wallTypes[],
+                    WorldCoords bounds) {
+  int z = map->level + 1;
+  if (map != levelStack.owner || z > LEVEL_MAX ||
+      getLevel(z)->chunkCount == 0) {
+    return;
+  }
+  Level *level = getLevel(z);
+  Color tint = Fade(WHITE, LEVEL_ABOVE_ALPHA);
+
+  for (int cx = bounds.startX / CHUNK_SIZE; cx <= bounds.endX / CHUNK_SIZE;
+       cx++) {
+    for (int cy = bounds.startY / CHUNK_SIZE; cy <= bounds.endY / CHUNK_SIZE;
+         cy++) {
+      LevelChunk *chunk = level->chunks[cx][cy];
+      if (chunk == NULL) {
+        continue;
+      }
+      WorldCoords cells;
+      chunkBounds(cx, cy, &cells);
+      int startX = cells.startX > bounds.startX ? cells.startX : bounds.startX;
+      int startY = cells.startY > bounds.startY ? cells.startY : bounds.startY;
+      int endX = cells.endX < bounds.endX ? cells.endX : bounds.endX;
+      int endY = cells.endY < bounds.endY ? cells.endY : bounds.endY;
+      for (int x = startX; x <= endX; x++) {
+        for (int y = startY; y <= endY; y++) {
+          drawLevelCell(z, chunk->cells[x - cells.startX][y - cells.startY],
+                        x, y, tileTypes, wallTypes, tint);
+        }
+      }
+    }
+  }
+}
+
+// Loads the ground from the map table into the map and every other level
+// from its own table. The map holds the ground afterwards.
+void levelLoad(sqlite3 *db, char *table, Map *map) {
+  levelUnload();
+  levelStack.owner = map;
+  map->level = 0;
+  loadMap(db, table, map);
+
+  for (int z = LEVEL_MIN; z <= LEVEL_MAX; z++) {
+    if (z == 0) {
+      continue;
+    }
+    char name[256];
+    levelTableName(name, sizeof(name), table, z);
+    int (*rows)[5];
+    int count = loadMapRows(db, name, &rows);
+    Level *level = getLevel(z);
+    for (int i = 0; i < count; i++) {
+      int x = rows[i][0];
+      int y = rows[i][1];
+      if (x < 0 || x >= GRID_SIZE || y < 0 || y >= GRID_SIZE) {
+        continue;
+      }
+      int cx = x / CHUNK_SIZE;
+      int cy = y / CHUNK_SIZE;
+      LevelChunk *chunk = getOrCreateChunk(level, cx, cy);
+      if (chunk != NULL) {
+        memcpy(chunk->cells[x - cx * CHUNK_SIZE][y - cy * CHUNK_SIZE],
+               &rows[i][2], sizeof(int[3]));
+      }
+    }
+    free(rows);
+    if (count > 0) {
+      printf("Level %d: %d cells in %d chunks\n", z, count, level->chunkCount);
+    }
+  }
+}
+
+// Saves every level to its own table; tables of empty levels are dropped
+void levelSave(sqlite3 *db, char *table, Map *map) {
+  for (int z = LEVEL_MIN; z <= LEVEL_MAX; z++) {
+    if (z == 0 && map->level == 0) {
+      saveMap(db, table, map);
+      continue;
+    }
+    char name[256];
+    levelTableName(name, sizeof(name), table, z);
+    int (*rows)[5];
+    int count = levelRows(map, z, &rows);
+    if (count == 0 && z != 0) {
+      dropMapTable(db, name);
+    } else {
+      saveMapRows(db, name, rows, count);
+    }
+    free(rows);
+  }
+}
+
+// Table holding level z of a map; the ground keeps the map's own table
+void levelTableName(char *name, int size, const char *table, int z) {
+  if (z == 0) {
+    snprintf(name, size, "%s", table);
+  } else if (z < 0) {
+    snprintf(name, size, "%s_zm%d", table, -z);
+  } else {
+    snprintf(name, size, "%s_z%d", table, z);
+  }
+}
+
+void levelUnload(void) {
+  for (int i = 0; i < LEVEL_COUNT; i++) {
+    clearLevel(&levelStack.levels[i]);
+    freeUndoHistory(&levelStack.history[i]);
+  }
+  levelStack.owner = NULL;
+}
@@ -0,0 +1,60 @@
+// level.h
+#ifndef LEVEL_H
+#define LEVEL_H
+
+// includes
+#include "database.h"
+#include "grid.h"
+#include "undo.h"
+#include <raylib.h>
+#include <sqlite3.h>
+#include <stdbool.h>
+
+// definitions
+#define LEVEL_MIN -10
+#define LEVEL_MAX 10
+#define LEVEL_COUNT (LEVEL_MAX - LEVEL_MIN + 1)
+#define LEVEL_BELOW_ALPHA 0.55f // level seen through hollow cells
+#define LEVEL_ABOVE_ALPHA 0.3f  // level drawn over the active one
+
+// structs
+// Cells of one chunk of a stored level, column by column like Map.grid
+typedef struct {
+  int cells[CHUNK_SIZE][CHUNK_SIZE][3];
+} LevelChunk;
+
+// A level other than the one held by the map. Chunks without a tile or
+// wall are NULL, so empty levels cost only this table.
+typedef struct {
+  LevelChunk *chunks[CHUNK_COUNT][CHUNK_COUNT];
+  int chunkCount;
+} Level;
+
+typedef struct {
+  Map *owner;
+  Level levels[LEVEL_COUNT];            // indexed by z - LEVEL_MIN
+  UndoRedoManager history[LEVEL_COUNT]; // undo stacks of stored levels
+} LevelStack;
+
+// globals
+extern LevelStack levelStack;
+
+// functions
+bool levelSwitch(Map *map, UndoRedoManager *manager, int z, Tile tileTypes[],
+                 Edge edgeTypes[], Wall wallTypes[]);
+
+void levelDrawBelow(Map *map, Tile tileTypes[], Wall wallTypes[],
+                    WorldCoords bounds);
+
+void levelDrawAbove(Map *map, Tile tileTypes[], Wall wallTypes[],
+                    WorldCoords bounds);
+
+void levelLoad(sqlite3 *db, char *table, Map *map);
+
+void levelSave(sqlite3 *db, char *table, Map *map);
+
+void levelTableName(char *name, int size, const char *table, int z);
+
+void levelUnload(void);
+
+#endif // LEVEL_H
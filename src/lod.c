@@ -0,0 +1,134 @@
+// lod.c
+#include "lod.h"
+#include "chunk.h"
+#include "layer.h"
+#include "profile.h"
+#include "runindex.h"
+#include "tilestyle.h"
+#include "trace.h"
+#include <raylib.h>
+#include <stddef.h>
+
+// Variables
+LodState lod = {.simpleZoom = LOD_SIMPLE_ZOOM, .colorZoom = LOD_COLOR_ZOOM};
+
+// Helper functions
+// Rewrites the texels of one chunk from the map
+static void updateChunk(Map *map, Tile tileTypes[], Wall wallTypes[], int cx,
+                        int cy) {
+  Color pixels[CHUNK_SIZE * CHUNK_SIZE];
+  int startX = cx * CHUNK_SIZE;
+  int startY = cy * CHUNK_SIZE;
+  int width = GRID_SIZE - startX < CHUNK_SIZE ? GRID_SIZE - startX : CHUNK_SIZE;
+  int height =
+      GRID_SIZE - startY < CHUNK_SIZE ? GRID_SIZE - startY : CHUNK_SIZE;
+
+  Color color;
+  bool uniform = lodChunkColor(map, tileTypes, wallTypes, cx, cy, &color);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      pixels[y * width + x] =
+          uniform ? color
+                  : lodCellColor(map, tileTypes, wallTypes, startX + x,
+                                 startY + y);
+    }
+  }
+
+  Rectangle rec = {startX, startY, width, height};
+  UpdateTextureRec(lod.texture, rec, pixels);
+}
+
+// LOD functions
+LodLevel lodLevel(float zoom) {
+  if (zoom < lod.colorZoom) {
+    return LOD_COLOR;
+  } else if (zoom < lod.simpleZoom) {
+    return LOD_SIMPLE;
+  }
+  return LOD_FULL;
+}
+
+// Colour of the topmost visible named layer tile, then the wall colour where
+// there is a wall, otherwise the ground variant's colour; transparent for
+// hollow cells off the ground
+Color lodCellColor(Map *map, Tile tileTypes[], Wall wallTypes[], int x,
+                   int y) {
+  const int *layerCell = layerTopCell(map, x, y);
+  if (layerCell != NULL) {
+    return tileTypes[layerCell[0]]
+        .color[resolveTileStyle(tileTypes, layerCell[0], layerCell[1], x, y)];
+  }
+  if (!layerStack.layers[0].info.visible) {
+    return BLANK;
+  }
+  int wallKey = map->grid[x][y][2];
+  if (wallKey != 0 && wallTypes[wallKey].color.a != 0) {
+    return wallTypes[wallKey].color;
+  }
+  if (map->level != 0 && map->grid[x][y][0] == 0) {
+    return BLANK;
+  }
+  int tileKey = map->grid[x][y][0];
+  return tileTypes[tileKey]
+      .color[resolveTileStyle(tileTypes, tileKey, map->grid[x][y][1], x, y)];
+}
+
+// Sets color and returns true when every cell of chunk (cx, cy) has the
+// same colour: the chunk is a single run whose variant does not depend on
+// the cell, and no named layer covers it
+bool lodChunkColor(Map *map, Tile tileTypes[], Wall wallTypes[], int cx,
+                   int cy, Color *color) {
+  const CellRun *run = runIndexSingleRun(map, cx, cy);
+  if (run == NULL || !layerChunkEmpty(map, cx, cy) ||
+      (run->tileStyle == TILE_STYLE_HASHED &&
+       tileTypes[run->tileKey].texCount > 1)) {
+    return false;
+  }
+  *color = lodCellColor(map, tileTypes, wallTypes, cx * CHUNK_SIZE,
+                        cy * CHUNK_SIZE);
+  return true;
+}
+
+// Creates the colour texture on first use and refreshes dirty chunks
+void lodUpdate(Map *map, Tile tileTypes[], Wall wallTypes[]) {
+  if (!lod.loaded) {
+    Image image = GenImageColor(GRID_SIZE, GRID_SIZE, BLANK);
+    lod.texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureFilter(lod.texture, TEXTURE_FILTER_POINT);
+    lod.loaded = true;
+    markMapDirty(map);
+  }
+
+  traceBegin("lodUpdate");
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      if (chunkIsDirty(map, cx, cy, CHUNK_DIRTY_LOD)) {
+        updateChunk(map, tileTypes, wallTypes, cx, cy);
+        clearChunkDirty(map, cx, cy, CHUNK_DIRTY_LOD);
+      }
+    }
+  }
+  traceEnd("lodUpdate");
+}
+
+// Draws the visible part of the map as a single scaled quad
+void lodDraw(Map *map, Tile tileTypes[], Wall wallTypes[],
+             WorldCoords bounds) {
+  lodUpdate(map, tileTypes, wallTypes);
+
+  float width = bounds.endX - bounds.startX + 1;
+  float height = bounds.endY - bounds.startY + 1;
+  Rectangle source = {bounds.startX, bounds.startY, width, height};
+  Rectangle dest = {bounds.startX * TILE_SIZE, bounds.startY * TILE_SIZE,
+                    width * TILE_SIZE, height * TILE_SIZE};
+  DrawTexturePro(lod.texture, source, dest, (Vector2){0, 0}, 0.0f, WHITE);
+  profileCountDraw(lod.texture);
+}
+
+void lodUnload(void) {
+  if (lod.loaded) {
+    UnloadTexture(lod.texture);
+    lod.loaded = false;
+  }
+}
@@ -0,0 +1,49 @@
+// lod.h
+#ifndef LOD_H
+#define LOD_H
+
+// includes
+#include "database.h"
+#include "grid.h"
+#include <raylib.h>
+#include <stdbool.h>
+
+// definitions
+#define LOD_SIMPLE_ZOOM 0.5f // below: ground and base wall sprites only
+#define LOD_COLOR_ZOOM 0.25f // below: one average colour per cell
+
+// enums
+typedef enum {
+  LOD_FULL,   // ground, edges, walls and wall quadrants
+  LOD_SIMPLE, // ground tile and base wall sprite per cell
+  LOD_COLOR   // colour texture, one pixel per cell, single draw
+} LodLevel;
+
+// structs
+typedef struct {
+  float simpleZoom;  // zoom threshold for LOD_SIMPLE
+  float colorZoom;   // zoom threshold for LOD_COLOR
+  Texture2D texture; // GRID_SIZE x GRID_SIZE, one pixel per cell
+  bool loaded;
+} LodState;
+
+// globals
+extern LodState lod;
+
+// functions
+LodLevel lodLevel(float zoom);
+
+Color lodCellColor(Map *map, Tile tileTypes[], Wall wallTypes[], int x,
+                   int y);
+
+bool lodChunkColor(Map *map, Tile tileTypes[], Wall wallTypes[], int cx,
+                   int cy, Color *color);
+
+void lodUpdate(Map *map, Tile tileTypes[], Wall wallTypes[]);
+
+void lodDraw(Map *map, Tile tileTypes[], Wall wallTypes[],
+             WorldCoords bounds);
+
+void lodUnload(void);
+
+#endif // LOD_H
@@ -1,472 +1,180 @@
 // main.c
-#include "command.h"
 #include "database.h"
-#include "draw.h"
-#include "edge.h"
-#include "grid.h"
-#include "math.h"
-#include "undo.h"
-#include "wall.h"
-#include "window.h"
+#include "editor.h"
+#include "input.h"
+#include "mesh.h"
+#include "profile.h"
+#include "renderbench.h"
+#include "trace.h"
 #include <raylib.h>
 #include <sqlite3.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+// definitions
+#define DEFAULT_TARGET_FPS 60
+#define IDLE_FRAMES 2 // frames drawn after the last input before waiting
+
 // Entry point
-int main() {
+int main(int argc, char *argv[]) {
+
+  // Parse command line options
+  const char *recordPath = NULL;
+  unsigned int seed = (unsigned int)time(NULL);
+  bool useSprites = false;
+  int targetFps = DEFAULT_TARGET_FPS;
+  bool benchRender = false;
+  RenderBenchOptions benchOptions;
+  renderBenchDefaults(&benchOptions);
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--trace") == 0) {
+      const char *path = TRACE_DEFAULT_PATH;
+      if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+        path = argv[++i];
+      }
+      traceInit(path, TRACE_CAPACITY);
+    } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+      recordPath = argv[++i];
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+      targetFps = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--renderer") == 0 && i + 1 < argc) {
+      useSprites = strcmp(argv[++i], "sprite") == 0;
+    } else if (strcmp(argv[i], "--bench-render") == 0) {
+      benchRender = true;
+      if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+        strncpy(benchOptions.path, argv[++i], sizeof(benchOptions.path) - 1);
+      }
+    } else if (strcmp(argv[i], "--bench-generate") == 0) {
+      benchOptions.generateMap = true;
+    } else if (strcmp(argv[i], "--bench-frames") == 0 && i + 1 < argc) {
+      benchOptions.framesPerStep = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--bench-zoom") == 0 && i + 2 < argc) {
+      benchOptions.zoomMax = strtof(argv[++i], NULL);
+      benchOptions.zoomMin = strtof(argv[++i], NULL);
+    } else if (strcmp(argv[i], "--bench-steps") == 0 && i + 1 < argc) {
+      benchOptions.zoomSteps = atoi(argv[++i]);
+    } else {
+      printf("Unknown option: %s\n", argv[i]);
+    }
+  }
+
+  // Seed tile style selection so recorded sessions replay identically
+  srand(seed);
 
   // Initialize database
   sqlite3 *db = connectDatabase();
 
-  // Initialize map
-  Map currentMap = {0};
-  loadMap(db, "map", &currentMap);
-
   // Set window dimensions
   int windowWidth = 800;
   int windowHeight = 600;
 
   // Initialize window
   InitWindow(windowWidth, windowHeight, "Map Editor");
-  SetTargetFPS(60);
+  SetTargetFPS(targetFps);
   SetExitKey(KEY_NULL);
-
-  // Load textures
-  Tile *tileTypes = loadTiles(db, &currentMap);
-  Edge *edgeTypes = loadEdges(db, &currentMap);
-  Wall *wallTypes = loadWalls(db, &currentMap);
-  computeMapEdges(tileTypes, edgeTypes, &currentMap);
-  computeMapWalls(wallTypes, &currentMap);
-
-  // Load Hash Tables
-  WallOrientMap *wallOrientationMap = loadWallOrientationsMap(db);
-
-  // Initialize Undo/Redo manager
-  UndoRedoManager *manager = (UndoRedoManager *)malloc(sizeof(UndoRedoManager));
-  manager->head = NULL;
-  manager->current = NULL;
-
-  // Window state
   SetWindowState(FLAG_WINDOW_RESIZABLE); // Enable window resizing
-  WindowState windowState;
-  windowState.width = windowWidth;
-  windowState.height = windowHeight;
 
-  // Initialize camera
-  Camera2D camera = {0};
-  camera.zoom = 1.0f;
-  camera.offset =
-      (Vector2){windowState.width / 2.0f, windowState.height / 2.0f};
-  camera.target =
-      (Vector2){GRID_SIZE / 2 * TILE_SIZE, GRID_SIZE / 2 * TILE_SIZE};
-  camera.rotation = 0.0f;
-
-  // Initialize camera state
-  CameraState cameraState;
-  cameraState.isPanning = false;
-  cameraState.lastMousePosition = (Vector2){0, 0};
+  // Initialize editor
+  Editor *editor = (Editor *)calloc(1, sizeof(Editor));
+  editorInit(editor, db, "map", windowWidth, windowHeight);
+  if (useSprites) {
+    meshRenderer.enabled = false;
+  }
 
-  // Initialize drawing state
-  DrawingState drawState = {0};
-  drawState.drawType = DRAW_TILE;             // Start in tile drawing mode
-  drawState.drawMode = MODE_PAINTER;          // Default mode is painter
-  drawState.pathMode = PATH_DIAGONAL;         // Default path is diagonal
-  drawState.previousPathMode = PATH_DIAGONAL; // Default path is diagonal
-  drawState.activeTileKey = 0;                // Initialize to a default tile
-  drawState.activeWallKey = 0;                // Initialize to a default wall
-  drawState.isDrawing = false;
-  drawState.drawnTilesCount = 0;
-  drawState.initialDragDirection = (Vector2){0, 0}; // Initialize drag direction
-  drawState.hasCapturedDragDirection = false;       // Initialize capture flag
+  // Rendering throughput benchmark replaces the interactive session
+  if (benchRender) {
+    int status = runRenderBench(editor, &benchOptions);
+    editorShutdown(editor);
+    free(editor);
+    traceShutdown();
+    sqlite3_close(db);
+    CloseWindow();
+    return status == 0 ? 0 : 1;
+  }
 
-  // Initialize command state
-  CommandState commandState = {0};
-  commandState.commandIndex = 0;
-  commandState.inCommandMode = false;
+  // Start input recording
+  FILE *recording = NULL;
+  if (recordPath != NULL) {
+    InputRecordingHeader header = {0};
+    header.seed = seed;
+    strncpy(header.mapTable, "map", sizeof(header.mapTable) - 1);
+    recording = inputRecordingCreate(recordPath, &header);
+  }
 
   // Event loop
+  InputFrame input = {0};
+  InputFrame previousInput = {0};
+  int idleFrames = 0;
+  bool eventWaiting = false;
+  bool waited = false; // the last EndDrawing blocked on window events
   while (!WindowShouldClose()) {
 
-    // Handle window resizing
-    HandleWindowResize(&windowState, &camera);
+    profileBeginFrame();
 
-    // Camera movement
-    float deltaTime = GetFrameTime();
-    if (IsKeyDown(KEY_RIGHT))
-      camera.target.x += CAMERA_SPEED * deltaTime;
-    if (IsKeyDown(KEY_LEFT))
-      camera.target.x -= CAMERA_SPEED * deltaTime;
-    if (IsKeyDown(KEY_DOWN))
-      camera.target.y += CAMERA_SPEED * deltaTime;
-    if (IsKeyDown(KEY_UP))
-      camera.target.y -= CAMERA_SPEED * deltaTime;
+    pollInput(&input);
 
-    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
-      cameraState.isPanning = true;
-      cameraState.lastMousePosition = drawState.mousePos;
-    } else if (IsMouseButtonReleased(MOUSE_BUTTON_RIGHT)) {
-      cameraState.isPanning = false;
+    // The first frame after a wait does not count it as elapsed time,
+    // whether input or another window event ended it
+    if (waited) {
+      input.frameTime = 0.0f;
     }
 
-    // Update camera position while panning
-    if (cameraState.isPanning) {
-      Vector2 mouseDelta = {
-          drawState.mousePos.x - cameraState.lastMousePosition.x,
-          drawState.mousePos.y - cameraState.lastMousePosition.y};
-
-      // Move camera opposite to mouse movement, adjusted for zoom
-      camera.target.x -= mouseDelta.x / camera.zoom;
-      camera.target.y -= mouseDelta.y / camera.zoom;
-
-      cameraState.lastMousePosition = drawState.mousePos;
+    // Block on events once idle
+    if (inputIsIdle(&input, &previousInput) && !editorIsBusy(editor)) {
+      idleFrames++;
+    } else {
+      idleFrames = 0;
     }
-
-    // Get mouse position in world coordinates
-    Vector2 screenMousePos = GetMousePosition();
-    drawState.mousePos = screenMousePos;
-
-    float wheel = GetMouseWheelMove();
-    if (wheel != 0) {
-      // Get mouse position before zoom for zoom targeting
-      Vector2 mouseWorldPos = getWorldCoordinates(GetMousePosition(), camera);
-
-      // Apply zoom
-      camera.zoom += wheel * 0.1f;
-      if (camera.zoom < 0.2f)
-        camera.zoom = 0.1f;
-
-      // Adjust camera target to zoom towards mouse position
-      Vector2 newMouseWorldPos =
-          getWorldCoordinates(GetMousePosition(), camera);
-      camera.target.x += mouseWorldPos.x - newMouseWorldPos.x;
-      camera.target.y += mouseWorldPos.y - newMouseWorldPos.y;
+    if (eventWaiting && idleFrames == 0) {
+      DisableEventWaiting();
+      eventWaiting = false;
+    } else if (!eventWaiting && idleFrames >= IDLE_FRAMES) {
+      EnableEventWaiting();
+      eventWaiting = true;
     }
+    previousInput = input;
 
-    // Check for Ctrl-Z (Undo)
-    if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) {
-      if (IsKeyPressed(KEY_Z)) {
-        undo(manager, &currentMap, tileTypes, edgeTypes, wallTypes);
-      }
-
-      // Check for Ctrl-Y (Redo)
-      if (IsKeyPressed(KEY_Y)) {
-        redo(manager, &currentMap, tileTypes, edgeTypes, wallTypes);
-      }
+    if (recording != NULL && !inputRecordingWrite(recording, &input)) {
+      printf("Error writing recording, stopping\n");
+      fclose(recording);
+      recording = NULL;
     }
 
     BeginDrawing();
     ClearBackground(BLACK);
-    BeginMode2D(camera);
-
-    // Draw existing map
-    if (!drawState.isDrawing) {
-      drawExistingMap(&currentMap, tileTypes, wallTypes, camera,
-                      windowState.width, windowState.height);
-    }
-
-    // Check for starting a drawing action
-    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-      // Decide the drawing mode based on modifier keys
-      if (IsKeyDown(KEY_LEFT_SHIFT)) {
-        drawState.drawMode = MODE_BOX;
-      } else if (IsKeyDown(KEY_LEFT_CONTROL)) {
-        drawState.drawMode = MODE_PATHING;
-      } else {
-        drawState.drawMode = MODE_PAINTER;
-      }
-      // Store the position where drawing started
-      drawState.startPos = drawState.mousePos;
-      drawState.isDrawing = true;
-      drawState.drawnTilesCount = 0; // Clear previous preview data
-    }
-
-    if (drawState.isDrawing) {
-
-      // Box (Shift) mode drawing
-      switch (drawState.drawMode) {
-      case MODE_BOX: {
-        switch (drawState.drawType) {
-        case DRAW_TILE: {
-
-          WorldCoords coords = getWorldGridCoords(drawState.startPos,
-                                                  drawState.mousePos, camera);
-
-          // Calculate the size of the array based on the bounding box
-          int coordArraySize = getBoundingBoxSize(coords);
-          int coordArray[coordArraySize][2];
-
-          coordsToArray(coords, coordArray);
-
-          Array2DPtr coordData = {.arrayLength = coordArraySize,
-                                  .array = coordArray};
-
-          updateDrawnTiles(coordData, &drawState, tileTypes);
-
-          drawPreview(&currentMap, &drawState, tileTypes, edgeTypes, wallTypes,
-                      windowState, camera);
-          break;
-        }
-        case DRAW_WALL: {
-          WorldCoords coords = getWorldGridCoords(drawState.startPos,
-                                                  drawState.mousePos, camera);
-
-          // Calculate the size of the array based on the bounding box
-          int coordArraySize = getBoundingPerimeterSize(coords);
-          int coordArray[coordArraySize][2];
-
-          coordsToPerimeterArray(coords, coordArray);
-
-          Array2DPtr coordData = {.arrayLength = coordArraySize,
-                                  .array = coordArray};
-
-          updateDrawnTiles(coordData, &drawState, tileTypes);
-
-          calculateWallOrientations(&drawState, wallOrientationMap);
-
-          drawPreview(&currentMap, &drawState, tileTypes, edgeTypes, wallTypes,
-                      windowState, camera);
-          break;
-        }
-        }
-        break;
-      }
-      case MODE_PATHING: {
-        // Check if we're still within the starting tile (32x32 pixels)
-        float deltaX = drawState.mousePos.x - drawState.startPos.x;
-        float deltaY = drawState.mousePos.y - drawState.startPos.y;
-        bool withinStartingTile =
-            (fabsf(deltaX) < TILE_SIZE && fabsf(deltaY) < TILE_SIZE);
-
-        // If we moved back to starting tile, reset capture to allow
-        // recalculation
-        if (withinStartingTile && drawState.hasCapturedDragDirection) {
-          drawState.hasCapturedDragDirection = false;
-          drawState.initialDragDirection = (Vector2){0, 0};
-        }
 
-        // Capture initial drag direction if we haven't yet and we're outside
-        // starting tile
-        if (!drawState.hasCapturedDragDirection && !withinStartingTile) {
-          float dragDistance = sqrt(deltaX * deltaX + deltaY * deltaY);
+    editorFrame(editor, &input);
 
-          // Only capture direction after mouse moves outside the starting tile
-          if (dragDistance >
-              5.0f) { // Small buffer to avoid jitter at tile edge
-            drawState.initialDragDirection = (Vector2){deltaX, deltaY};
-            drawState.hasCapturedDragDirection = true;
-          }
-        }
-        switch (drawState.drawType) {
-        case DRAW_TILE: {
+    // Draw profiler overlay
+    profileDrawOverlay(editor->windowState.width, editor->windowState.height);
 
-          WorldCoords coords = getWorldGridCoords(drawState.startPos,
-                                                  drawState.mousePos, camera);
-
-          int coordArraySize = (abs(coords.endX - coords.startX) +
-                                (abs(coords.endY - coords.startY)) + 1);
-
-          int coordArray[coordArraySize][2];
-
-          Array2DPtr pathData = {.arrayLength = coordArraySize,
-                                 .array = coordArray};
-
-          calculatePath(coords, pathData, &drawState);
-
-          updateDrawnTiles(pathData, &drawState, tileTypes);
-
-          drawPreview(&currentMap, &drawState, tileTypes, edgeTypes, wallTypes,
-                      windowState, camera);
-
-          break;
-        }
-        case DRAW_WALL: {
-
-          WorldCoords coords = getWorldGridCoords(drawState.startPos,
-                                                  drawState.mousePos, camera);
-
-          int coordArraySize = (abs(coords.endX - coords.startX) +
-                                (abs(coords.endY - coords.startY)) + 1);
-
-          int coordArray[coordArraySize][2];
-
-          Array2DPtr pathData = {.arrayLength = coordArraySize,
-                                 .array = coordArray};
-
-          calculatePath(coords, pathData, &drawState);
-
-          updateDrawnTiles(pathData, &drawState, tileTypes);
-
-          calculateWallOrientations(&drawState, wallOrientationMap);
-
-          drawPreview(&currentMap, &drawState, tileTypes, edgeTypes, wallTypes,
-                      windowState, camera);
-
-          break;
-        }
-        }
-        break;
-      }
-      case MODE_PAINTER: {
-        WorldCoords coords =
-            getWorldGridCoords(drawState.mousePos, drawState.mousePos, camera);
-        int x = coords.endX;
-        int y = coords.endY;
-
-        int alreadyVisited = 0;
-        for (int j = 0; j < drawState.drawnTilesCount; j++) {
-          if (drawState.drawnTiles[j][0] == x &&
-              drawState.drawnTiles[j][1] == y) {
-            alreadyVisited = 1;
-            break;
-          }
-        }
-
-        switch (drawState.drawType) {
-          int style;
-        case DRAW_TILE:
-
-          if (!alreadyVisited) {
-            style = getRandTileStyle(drawState.activeTileKey, tileTypes);
-            drawState.drawnTiles[drawState.drawnTilesCount][0] = x;
-            drawState.drawnTiles[drawState.drawnTilesCount][1] = y;
-            drawState.drawnTiles[drawState.drawnTilesCount][2] = style;
-            drawState.drawnTilesCount++;
-          }
-
-          drawPreview(&currentMap, &drawState, tileTypes, edgeTypes, wallTypes,
-                      windowState, camera);
-          break;
-
-        case DRAW_WALL:
-
-          if (!alreadyVisited) {
-            drawState.drawnTiles[drawState.drawnTilesCount][0] = x;
-            drawState.drawnTiles[drawState.drawnTilesCount][1] = y;
-            drawState.drawnTilesCount++;
-          }
-
-          drawPreview(&currentMap, &drawState, tileTypes, edgeTypes, wallTypes,
-                      windowState, camera);
+    profileBeginStage(STAGE_PRESENT);
+    EndDrawing();
+    profileEndStage(STAGE_PRESENT);
 
-          break;
-        }
-      }
-      }
+    // With event waiting on, EndDrawing blocked until the next event; that
+    // idle time is not a frame's work
+    waited = eventWaiting;
+    if (waited) {
+      profileDiscardFrame();
     } else {
-
-      // Fallback: Draw a simple cursor preview if no drawing mode is active
-      WorldCoords coords =
-          getWorldGridCoords(drawState.mousePos, drawState.mousePos, camera);
-
-      switch (drawState.drawType) {
-        Vector2 previewPos;
-        Texture2D previewTex;
-      case DRAW_TILE:
-        previewPos =
-            (Vector2){coords.startX * TILE_SIZE, coords.startY * TILE_SIZE};
-        previewTex = tileTypes[drawState.activeTileKey].tex[0];
-        DrawTexture(previewTex, previewPos.x, previewPos.y, WHITE);
-        DrawRectangleLines(previewPos.x, previewPos.y, TILE_SIZE, TILE_SIZE,
-                           RED);
-        break;
-
-      case DRAW_WALL: {
-        Texture2D previewTex[4] = {
-            wallTypes[drawState.activeWallKey].wallTex[0].tex,
-            wallTypes[drawState.activeWallKey].wallTex[1].tex,
-            wallTypes[drawState.activeWallKey].wallTex[2].tex,
-            wallTypes[drawState.activeWallKey].wallTex[3].tex};
-        Vector2 previewPos[4] = {
-            {(coords.startX - 1) * TILE_SIZE, (coords.startY - 1) * TILE_SIZE},
-            {(coords.startX) * TILE_SIZE, (coords.startY - 1) * TILE_SIZE},
-            {(coords.startX - 1) * TILE_SIZE, (coords.startY) * TILE_SIZE},
-            {(coords.startX) * TILE_SIZE, (coords.startY) * TILE_SIZE},
-        };
-        for (int i = 0; i < 4; i++) {
-          DrawTexture(previewTex[i], previewPos[i].x, previewPos[i].y, WHITE);
-        }
-        DrawRectangleLines(previewPos[3].x - TILE_SIZE,
-                           previewPos[3].y - TILE_SIZE, TILE_SIZE * 2,
-                           TILE_SIZE * 2, RED);
-        break;
-      }
-      };
+      profileEndFrame();
     }
-
-    if (IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
-      // Get neighbors to placement
-      int visitedTiles[GRID_SIZE * GRID_SIZE][2];
-      int visitedCount = 0;
-      switch (drawState.drawType) {
-      case DRAW_TILE:
-
-        calculateEdgeGrid(&drawState, visitedTiles, &visitedCount);
-
-        // Add drawn tiles to undo/redo stack
-        createTileChangeBatch(manager, &currentMap, &drawState, visitedTiles,
-                              visitedCount);
-
-        // Texture updates
-        applyTiles(&currentMap, &drawState);
-        computeEdges(visitedTiles, visitedCount, &currentMap, tileTypes,
-                     edgeTypes);
-
-        memset(drawState.drawnTiles, 0, sizeof(drawState.drawnTiles));
-
-        drawState.isDrawing = false;
-        break;
-      case DRAW_WALL:
-        calculateWallGrid(&drawState, visitedTiles, &visitedCount);
-        if (drawState.drawMode == MODE_BOX) {
-          calculateWallOrientations(&drawState, wallOrientationMap);
-        }
-        createTileChangeBatch(manager, &currentMap, &drawState, visitedTiles,
-                              visitedCount);
-        applyTiles(&currentMap, &drawState);
-        computeWalls(visitedTiles, visitedCount, &currentMap, wallTypes);
-        memset(drawState.drawnTiles, 0, sizeof(drawState.drawnTiles));
-        drawState.isDrawing = false;
-        break;
-      }
-      drawState.hasCapturedDragDirection = false;
-    }
-
-    EndMode2D();
-
-    // Handle command mode
-    handleCommandMode(&commandState, windowState.height, windowState.width,
-                      tileTypes, edgeTypes, wallTypes, db, &drawState,
-                      &currentMap);
-
-    EndDrawing();
   }
 
-  // free Undo/Redo manager and all batches/changes from session
-  TileChangeBatch *batch = manager->head;
-  while (batch) {
-    TileChangeBatch *nextBatch = batch->next;
-    free(batch->changes);
-    free(batch);
-    batch = nextBatch;
-  }
-
-  // free wall orientation
-  for (int i = 0; i < wallOrientationMap->capacity; ++i) {
-    Entry *current = wallOrientationMap->buckets[i];
-    while (current != NULL) {
-      Entry *temp = current;
-      current = current->next;
-      free(temp);
-    }
+  if (recording != NULL) {
+    fclose(recording);
+    printf("Map hash: %016llx\n",
+           (unsigned long long)editorMapHash(&editor->map));
   }
 
-  free(wallOrientationMap->buckets);
-  free(wallOrientationMap);
-  free(manager);
-  free(tileTypes);
-  free(edgeTypes);
+  editorShutdown(editor);
+  free(editor);
+  traceShutdown();
   sqlite3_close(db);
   CloseWindow();
   return 0;
@@ -0,0 +1,294 @@
+// mesh.c
+#include "mesh.h"
+#include "atlas.h"
+#include "chunk.h"
+#include "profile.h"
+#include "tilestyle.h"
+#include "trace.h"
+#include <raylib.h>
+#include <raymath.h>
+#include <rlgl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+MeshRenderer meshRenderer = {0};
+
+// Helper functions
+// Appends two triangles covering the cell at (x, y) with an atlas sprite
+static int appendQuad(int vertexCount, int x, int y, Texture2D texture) {
+  AtlasRegion region;
+  if (!atlasRegion(texture, &region)) {
+    return vertexCount;
+  }
+
+  float left = x * TILE_SIZE;
+  float top = y * TILE_SIZE;
+  float right = left + TILE_SIZE;
+  float bottom = top + TILE_SIZE;
+
+  // Same winding as raylib's textured quads: TL, BL, BR and TL, BR, TR
+  float positions[12] = {left, top,    left,  bottom, right, bottom,
+                         left, top,    right, bottom, right, top};
+  float texcoords[12] = {region.u0, region.v0, region.u0, region.v1,
+                         region.u1, region.v1, region.u0, region.v0,
+                         region.u1, region.v1, region.u1, region.v0};
+  memcpy(&meshRenderer.positions[vertexCount * 2], positions,
+         sizeof(positions));
+  memcpy(&meshRenderer.texcoords[vertexCount * 2], texcoords,
+         sizeof(texcoords));
+  return vertexCount + 6;
+}
+
+// Appends the chunk's tiles of every visible named layer, bottom first
+static int appendLayerQuads(int count, const Map *map, Tile tileTypes[],
+                            int cx, int cy) {
+  for (int i = 1; i < layerStack.layerCount; i++) {
+    LayerGrid *grid = layerStack.layers[i].levels[map->level - LEVEL_MIN];
+    if (!layerStack.layers[i].info.visible || grid == NULL ||
+        grid->chunks[cx][cy] == NULL) {
+      continue;
+    }
+    LayerChunk *chunk = grid->chunks[cx][cy];
+    for (int x = 0; x < CHUNK_SIZE; x++) {
+      for (int y = 0; y < CHUNK_SIZE; y++) {
+        const int *cell = chunk->cells[x][y];
+        if (cell[0] != 0) {
+          int cellX = cx * CHUNK_SIZE + x;
+          int cellY = cy * CHUNK_SIZE + y;
+          int style = resolveTileStyle(tileTypes, cell[0], cell[1], cellX,
+                                       cellY);
+          count = appendQuad(count, cellX, cellY,
+                             tileTypes[cell[0]].tex[style]);
+        }
+      }
+    }
+  }
+  return count;
+}
+
+// Fills the scratch buffers for one chunk, layer by layer, compositing the
+// visible named layers over the map's grid. Sprites of different cells never
+// overlap, so this matches drawExistingMap's order.
+static int buildChunkVertices(Map *map, Tile tileTypes[], Wall wallTypes[],
+                              int cx, int cy) {
+  int startX = cx * CHUNK_SIZE;
+  int startY = cy * CHUNK_SIZE;
+  int endX = startX + CHUNK_SIZE < GRID_SIZE ? startX + CHUNK_SIZE : GRID_SIZE;
+  int endY = startY + CHUNK_SIZE < GRID_SIZE ? startY + CHUNK_SIZE : GRID_SIZE;
+  int count = 0;
+  bool hollowFloor = map->level != 0;
+
+  // The map's own grid is layer 0, which can be hidden
+  if (!layerStack.layers[0].info.visible) {
+    return appendLayerQuads(count, map, tileTypes, cx, cy);
+  }
+
+  // Ground tiles; off the ground, cells without a tile are hollow
+  for (int x = startX; x < endX; x++) {
+    for (int y = startY; y < endY; y++) {
+      int tileKey = map->grid[x][y][0];
+      if (hollowFloor && tileKey == 0) {
+        continue;
+      }
+      int style =
+          resolveTileStyle(tileTypes, tileKey, map->grid[x][y][1], x, y);
+      count = appendQuad(count, x, y, tileTypes[tileKey].tex[style]);
+    }
+  }
+
+  // Ground edges
+  for (int x = startX; x < endX; x++) {
+    for (int y = startY; y < endY; y++) {
+      for (int i = 0; i < map->edgeCount[x][y]; i++) {
+        count = appendQuad(count, x, y, map->edges[x][y][i]);
+      }
+    }
+  }
+
+  // Base wall sprites and wall quadrants
+  for (int x = startX; x < endX; x++) {
+    for (int y = startY; y < endY; y++) {
+      int wallKey = map->grid[x][y][2];
+      if (wallKey != 0) {
+        count = appendQuad(count, x, y, wallTypes[wallKey].wallTex[3].tex);
+      }
+      for (int j = 0; j < map->wallCount[x][y]; j++) {
+        count = appendQuad(count, x, y, map->walls[x][y][j]);
+      }
+    }
+  }
+
+  return appendLayerQuads(count, map, tileTypes, cx, cy);
+}
+
+static void unloadChunk(ChunkMesh *mesh) {
+  if (mesh->vao != 0) {
+    rlUnloadVertexBuffer(mesh->vboPosition);
+    rlUnloadVertexBuffer(mesh->vboTexcoord);
+    rlUnloadVertexArray(mesh->vao);
+  }
+  memset(mesh, 0, sizeof(ChunkMesh));
+}
+
+// Uploads the scratch buffers, reusing the chunk's buffers when they fit
+static void uploadChunk(ChunkMesh *mesh, int vertexCount) {
+  int bytes = vertexCount * 2 * (int)sizeof(float);
+
+  if (mesh->vao != 0 && vertexCount <= mesh->capacity) {
+    rlUpdateVertexBuffer(mesh->vboPosition, meshRenderer.positions, bytes, 0);
+    rlUpdateVertexBuffer(mesh->vboTexcoord, meshRenderer.texcoords, bytes, 0);
+    mesh->vertexCount = vertexCount;
+    return;
+  }
+
+  int lastFrame = mesh->lastFrame;
+  unloadChunk(mesh);
+  mesh->lastFrame = lastFrame;
+  if (vertexCount == 0) {
+    return;
+  }
+
+  int *locs = rlGetShaderLocsDefault();
+  mesh->vao = rlLoadVertexArray();
+  rlEnableVertexArray(mesh->vao);
+  mesh->vboPosition = rlLoadVertexBuffer(meshRenderer.positions, bytes, true);
+  rlSetVertexAttribute(locs[RL_SHADER_LOC_VERTEX_POSITION], 2, RL_FLOAT, false,
+                       0, 0);
+  rlEnableVertexAttribute(locs[RL_SHADER_LOC_VERTEX_POSITION]);
+  mesh->vboTexcoord = rlLoadVertexBuffer(meshRenderer.texcoords, bytes, true);
+  rlSetVertexAttribute(locs[RL_SHADER_LOC_VERTEX_TEXCOORD01], 2, RL_FLOAT,
+                       false, 0, 0);
+  rlEnableVertexAttribute(locs[RL_SHADER_LOC_VERTEX_TEXCOORD01]);
+  rlDisableVertexArray();
+
+  mesh->vertexCount = vertexCount;
+  mesh->capacity = vertexCount;
+}
+
+// Mesh functions
+// Enables the renderer for one map once the atlas is uploaded. Returns false
+// where vertex arrays are unavailable (OpenGL 1.1) or the atlas left sprites
+// out, leaving sprites in use.
+bool meshInit(const Map *owner) {
+  meshUnload();
+
+  if (atlas.missing > 0) {
+    printf("%d sprites missing from the atlas, using sprite renderer\n",
+           atlas.missing);
+    return false;
+  }
+  unsigned int probe = rlLoadVertexArray();
+  if (probe == 0 || !atlas.loaded) {
+    printf("Vertex arrays unavailable, using sprite renderer\n");
+    return false;
+  }
+  rlUnloadVertexArray(probe);
+
+  meshRenderer.positions =
+      (float *)malloc(MESH_CHUNK_VERTICES * 2 * sizeof(float));
+  meshRenderer.texcoords =
+      (float *)malloc(MESH_CHUNK_VERTICES * 2 * sizeof(float));
+  if (meshRenderer.positions == NULL || meshRenderer.texcoords == NULL) {
+    printf("Memory allocation failed\n");
+    meshUnload();
+    return false;
+  }
+
+  meshRenderer.owner = owner;
+  meshRenderer.enabled = true;
+  return true;
+}
+
+// Buffers are cached for the owning map only; other maps (the preview copy)
+// are drawn with sprites.
+bool meshCanDraw(const Map *map) {
+  return meshRenderer.enabled && map == meshRenderer.owner;
+}
+
+// Draws the visible chunks, rebuilding those whose cells changed
+void meshDraw(Map *map, Tile tileTypes[], Wall wallTypes[],
+              WorldCoords bounds) {
+  meshRenderer.frame++;
+
+  // Flush raylib's batch so sprites drawn earlier stay underneath
+  rlDrawRenderBatchActive();
+
+  int startCX = bounds.startX / CHUNK_SIZE;
+  int startCY = bounds.startY / CHUNK_SIZE;
+  int endCX = bounds.endX / CHUNK_SIZE;
+  int endCY = bounds.endY / CHUNK_SIZE;
+
+  // Rebuild dirty visible chunks
+  for (int cx = startCX; cx <= endCX; cx++) {
+    for (int cy = startCY; cy <= endCY; cy++) {
+      ChunkMesh *mesh = &meshRenderer.chunks[cx][cy];
+      bool fresh = mesh->lastFrame == 0;
+      if (fresh || chunkIsDirty(map, cx, cy, CHUNK_DIRTY_MESH)) {
+        traceBegin("meshBuildChunk");
+        int vertexCount = buildChunkVertices(map, tileTypes, wallTypes, cx, cy);
+        uploadChunk(mesh, vertexCount);
+        clearChunkDirty(map, cx, cy, CHUNK_DIRTY_MESH);
+        traceEnd("meshBuildChunk");
+      }
+      mesh->lastFrame = meshRenderer.frame;
+    }
+  }
+
+  // Draw with the default shader and the camera's transform
+  int *locs = rlGetShaderLocsDefault();
+  float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  int textureSlot = 0;
+  Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+
+  rlEnableShader(rlGetShaderIdDefault());
+  rlSetUniformMatrix(locs[RL_SHADER_LOC_MATRIX_MVP], mvp);
+  rlSetUniform(locs[RL_SHADER_LOC_COLOR_DIFFUSE], white,
+               RL_SHADER_UNIFORM_VEC4, 1);
+  rlSetUniform(locs[RL_SHADER_LOC_MAP_DIFFUSE], &textureSlot,
+               RL_SHADER_UNIFORM_SAMPLER2D, 1);
+  rlSetVertexAttributeDefault(locs[RL_SHADER_LOC_VERTEX_COLOR], white,
+                              RL_SHADER_ATTRIB_VEC4, 4);
+  rlActiveTextureSlot(0);
+  rlEnableTexture(atlas.texture.id);
+
+  for (int cx = startCX; cx <= endCX; cx++) {
+    for (int cy = startCY; cy <= endCY; cy++) {
+      ChunkMesh *mesh = &meshRenderer.chunks[cx][cy];
+      if (mesh->vertexCount > 0 && rlEnableVertexArray(mesh->vao)) {
+        rlDrawVertexArray(0, mesh->vertexCount);
+        profileCountDraw(atlas.texture);
+      }
+    }
+  }
+
+  rlDisableVertexArray();
+  rlDisableTexture();
+  rlDisableShader();
+
+  // Release buffers of chunks that have been off screen for a while
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      ChunkMesh *mesh = &meshRenderer.chunks[cx][cy];
+      if (mesh->lastFrame != 0 &&
+          meshRenderer.frame - mesh->lastFrame > MESH_EVICT_FRAMES) {
+        unloadChunk(mesh);
+      }
+    }
+  }
+}
+
+void meshUnload(void) {
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      unloadChunk(&meshRenderer.chunks[cx][cy]);
+    }
+  }
+  free(meshRenderer.positions);
+  free(meshRenderer.texcoords);
+  meshRenderer.positions = NULL;
+  meshRenderer.texcoords = NULL;
+  meshRenderer.owner = NULL;
+  meshRenderer.enabled = false;
+}
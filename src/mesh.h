@@ -0,0 +1,50 @@
+// mesh.h
+#ifndef MESH_H
+#define MESH_H
+
+// includes
+#include "database.h"
+#include "grid.h"
+#include "layer.h"
+#include <stdbool.h>
+
+// definitions
+// ground, 12 edges, base wall, 3 quadrants and one per named layer
+#define MESH_QUADS_PER_CELL (17 + LAYER_MAX - 1)
+#define MESH_CHUNK_VERTICES                                                    \
+  (CHUNK_SIZE * CHUNK_SIZE * MESH_QUADS_PER_CELL * 6)
+#define MESH_EVICT_FRAMES 600 // unload chunk buffers unseen for this long
+
+// structs
+typedef struct {
+  unsigned int vao;
+  unsigned int vboPosition;
+  unsigned int vboTexcoord;
+  int vertexCount;
+  int capacity;  // vertices the buffers can hold
+  int lastFrame; // last frame the chunk was drawn
+} ChunkMesh;
+
+typedef struct {
+  ChunkMesh chunks[CHUNK_COUNT][CHUNK_COUNT];
+  const Map *owner; // map the cached buffers were built from
+  float *positions; // scratch vertex data for one chunk
+  float *texcoords;
+  int frame;
+  bool enabled;
+} MeshRenderer;
+
+// globals
+extern MeshRenderer meshRenderer;
+
+// functions
+bool meshInit(const Map *owner);
+
+bool meshCanDraw(const Map *map);
+
+void meshDraw(Map *map, Tile tileTypes[], Wall wallTypes[],
+              WorldCoords bounds);
+
+void meshUnload(void);
+
+#endif // MESH_H
@@ -0,0 +1,171 @@
+// minimap.c
+#include "minimap.h"
+#include "chunk.h"
+#include "grid.h"
+#include "lod.h"
+#include "profile.h"
+#include "trace.h"
+
+// Variables
+MinimapState minimap = {.visible = true};
+
+// Helper functions
+static Rectangle panelRect(int screenWidth, int screenHeight) {
+  return (Rectangle){
+      screenWidth - MINIMAP_SIZE - MINIMAP_MARGIN,
+      screenHeight - MINIMAP_SIZE - MINIMAP_MARGIN - MINIMAP_COMMAND_BAR,
+      MINIMAP_SIZE, MINIMAP_SIZE};
+}
+
+// Averages each block of cells of one chunk into its texels
+static void updateChunk(Map *map, Tile tileTypes[], Wall wallTypes[], int cx,
+                        int cy) {
+  Color pixels[CHUNK_SIZE * CHUNK_SIZE];
+  int size = minimap.chunkPixels;
+  int block = minimap.cellsPerTexel;
+
+  Color color;
+  if (lodChunkColor(map, tileTypes, wallTypes, cx, cy, &color)) {
+    for (int i = 0; i < size * size; i++) {
+      pixels[i] = color;
+    }
+    Rectangle rec = {cx * size, cy * size, size, size};
+    UpdateTextureRec(minimap.texture, rec, pixels);
+    return;
+  }
+
+  for (int py = 0; py < size; py++) {
+    for (int px = 0; px < size; px++) {
+      int startX = cx * CHUNK_SIZE + px * block;
+      int startY = cy * CHUNK_SIZE + py * block;
+      int sum[4] = {0, 0, 0, 0};
+      int count = 0;
+      for (int x = startX; x < startX + block && x < GRID_SIZE; x++) {
+        for (int y = startY; y < startY + block && y < GRID_SIZE; y++) {
+          Color color = lodCellColor(map, tileTypes, wallTypes, x, y);
+          sum[0] += color.r;
+          sum[1] += color.g;
+          sum[2] += color.b;
+          sum[3] += color.a;
+          count++;
+        }
+      }
+      pixels[py * size + px] =
+          count == 0 ? BLANK
+                     : (Color){sum[0] / count, sum[1] / count,
+                               sum[2] / count, sum[3] / count};
+    }
+  }
+
+  Rectangle rec = {cx * size, cy * size, size, size};
+  UpdateTextureRec(minimap.texture, rec, pixels);
+}
+
+// Minimap functions
+// Rebuilds the summaries of changed chunks, at most MINIMAP_CHUNK_BUDGET a
+// frame, continuing from where the previous frame stopped
+void minimapUpdate(Map *map, Tile tileTypes[], Wall wallTypes[]) {
+  if (!minimap.loaded) {
+    // Largest power of two texels per chunk that keeps the texture in budget
+    minimap.chunkPixels = 1;
+    while (minimap.chunkPixels < CHUNK_SIZE &&
+           minimap.chunkPixels * 2 * CHUNK_COUNT <= MINIMAP_TEXTURE_MAX) {
+      minimap.chunkPixels *= 2;
+    }
+    minimap.cellsPerTexel = CHUNK_SIZE / minimap.chunkPixels;
+
+    int side = CHUNK_COUNT * minimap.chunkPixels;
+    Image image = GenImageColor(side, side, BLANK);
+    minimap.texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureFilter(minimap.texture, TEXTURE_FILTER_POINT);
+    minimap.cursor = 0;
+    minimap.loaded = true;
+    markMapDirty(map);
+  }
+
+  traceBegin("minimapUpdate");
+  int chunkCount = CHUNK_COUNT * CHUNK_COUNT;
+  int start = minimap.cursor;
+  int rebuilt = 0;
+  int i = 0;
+  for (; i < chunkCount && rebuilt < MINIMAP_CHUNK_BUDGET; i++) {
+    int chunk = (start + i) % chunkCount;
+    int cx = chunk / CHUNK_COUNT;
+    int cy = chunk % CHUNK_COUNT;
+    if (chunkIsDirty(map, cx, cy, CHUNK_DIRTY_MINIMAP)) {
+      updateChunk(map, tileTypes, wallTypes, cx, cy);
+      clearChunkDirty(map, cx, cy, CHUNK_DIRTY_MINIMAP);
+      rebuilt++;
+      minimap.cursor = (chunk + 1) % chunkCount;
+    }
+  }
+  minimap.pending = i < chunkCount;
+  traceEnd("minimapUpdate");
+}
+
+// True while changed chunks wait for a later update. The summaries are only
+// rebuilt while the panel is shown, so a hidden panel never holds frames.
+bool minimapPending(void) { return minimap.visible && minimap.pending; }
+
+// Left presses on the panel centre the camera on the pressed cell, and
+// dragging keeps it there. Returns true while the left button belongs to
+// the minimap.
+bool minimapHandleInput(const InputFrame *input, Camera2D *camera,
+                        int screenWidth, int screenHeight) {
+  if (inputKeyPressed(input, KEY_F2)) {
+    minimap.visible = !minimap.visible;
+  }
+
+  Rectangle panel = panelRect(screenWidth, screenHeight);
+  if (minimap.visible && inputMouseButtonPressed(input, MOUSE_BUTTON_LEFT) &&
+      CheckCollisionPointRec(input->mousePos, panel)) {
+    minimap.dragging = true;
+  }
+  if (!minimap.dragging) {
+    return false;
+  }
+
+  float worldSize = GRID_SIZE * TILE_SIZE;
+  float u = (input->mousePos.x - panel.x) / panel.width;
+  float v = (input->mousePos.y - panel.y) / panel.height;
+  camera->target.x = (u < 0.0f ? 0.0f : u > 1.0f ? 1.0f : u) * worldSize;
+  camera->target.y = (v < 0.0f ? 0.0f : v > 1.0f ? 1.0f : v) * worldSize;
+
+  if (!inputMouseButtonDown(input, MOUSE_BUTTON_LEFT)) {
+    minimap.dragging = false;
+  }
+  return true;
+}
+
+// Draws the panel with the camera's view outlined
+void minimapDraw(Map *map, Tile tileTypes[], Wall wallTypes[],
+                 Camera2D camera, int screenWidth, int screenHeight) {
+  if (!minimap.visible) {
+    return;
+  }
+  minimapUpdate(map, tileTypes, wallTypes);
+
+  Rectangle panel = panelRect(screenWidth, screenHeight);
+  float texels = (float)GRID_SIZE / minimap.cellsPerTexel;
+  Rectangle source = {0, 0, texels, texels};
+  DrawRectangleRec(panel, BLACK);
+  DrawTexturePro(minimap.texture, source, panel, (Vector2){0, 0}, 0.0f,
+                 WHITE);
+  profileCountDraw(minimap.texture);
+
+  WorldCoords view = GetVisibleGridBounds(camera, screenWidth, screenHeight);
+  float scale = panel.width / GRID_SIZE;
+  DrawRectangleLines(panel.x + view.startX * scale,
+                     panel.y + view.startY * scale,
+                     (view.endX - view.startX + 1) * scale + 1,
+                     (view.endY - view.startY + 1) * scale + 1, RED);
+  DrawRectangleLines(panel.x, panel.y, panel.width, panel.height, LIGHTGRAY);
+}
+
+void minimapUnload(void) {
+  if (minimap.loaded) {
+    UnloadTexture(minimap.texture);
+    minimap.loaded = false;
+  }
+}
@@ -0,0 +1,48 @@
+// minimap.h
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+// includes
+#include "database.h"
+#include "input.h"
+#include <raylib.h>
+#include <stdbool.h>
+
+// definitions
+#define MINIMAP_SIZE 192          // panel side in screen pixels
+#define MINIMAP_MARGIN 10         // gap to the window edges
+#define MINIMAP_COMMAND_BAR 30    // space kept free for the command bar
+#define MINIMAP_TEXTURE_MAX 512   // largest summary texture side
+#define MINIMAP_CHUNK_BUDGET 1024 // chunk summaries rebuilt per frame
+
+// structs
+// One texel per block of cells, each chunk covering chunkPixels x
+// chunkPixels texels
+typedef struct {
+  Texture2D texture;
+  int chunkPixels;   // texels per chunk side, a power of two
+  int cellsPerTexel; // cells per texel side
+  int cursor;        // next chunk to check for changes
+  bool pending;      // the last update stopped on its budget
+  bool loaded;
+  bool visible;
+  bool dragging; // a left press on the panel is moving the camera
+} MinimapState;
+
+// globals
+extern MinimapState minimap;
+
+// functions
+void minimapUpdate(Map *map, Tile tileTypes[], Wall wallTypes[]);
+
+bool minimapPending(void);
+
+bool minimapHandleInput(const InputFrame *input, Camera2D *camera,
+                        int screenWidth, int screenHeight);
+
+void minimapDraw(Map *map, Tile tileTypes[], Wall wallTypes[],
+                 Camera2D camera, int screenWidth, int screenHeight);
+
+void minimapUnload(void);
+
+#endif // MINIMAP_H
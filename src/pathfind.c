@@ -0,0 +1,497 @@
+// pathfind.c
+#include "pathfind.h"
+#include "grid.h"
+#include "hpa.h"
+#include "profile.h"
+#include "trace.h"
+#include "walkmap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+PathfindTool pathfindTool = {0};
+
+typedef struct {
+  float f; // cost so far plus the estimate to the goal
+  int cell;
+} OpenNode;
+
+// Search state kept between queries. Cells are x * GRID_SIZE + y; a cell's
+// g and parent are valid only while its opened stamp is the current search.
+typedef struct {
+  float *g;
+  int *parent;
+  unsigned int *opened;
+  unsigned int *closed;
+  unsigned int id;
+  OpenNode *open; // binary min-heap on f
+  int openCount;
+  int openCapacity;
+} PathfindSearch;
+
+static PathfindSearch search = {0};
+
+// Helper functions
+// Index of the lowest and highest set bit of a non-zero word
+static int lowestBit(uint64_t word) { return __builtin_ctzll(word); }
+
+static int highestBit(uint64_t word) { return 63 - __builtin_clzll(word); }
+
+static int sign(int value) { return (value > 0) - (value < 0); }
+
+static bool allocSearch(void) {
+  if (search.g != NULL) {
+    return true;
+  }
+  size_t cells = (size_t)GRID_SIZE * GRID_SIZE;
+  search.g = (float *)malloc(cells * sizeof(float));
+  search.parent = (int *)malloc(cells * sizeof(int));
+  search.opened = (unsigned int *)calloc(cells, sizeof(unsigned int));
+  search.closed = (unsigned int *)calloc(cells, sizeof(unsigned int));
+  if (search.g == NULL || search.parent == NULL || search.opened == NULL ||
+      search.closed == NULL) {
+    printf("Memory allocation failed\n");
+    free(search.g);
+    free(search.parent);
+    free(search.opened);
+    free(search.closed);
+    search.g = NULL;
+    search.parent = NULL;
+    search.opened = NULL;
+    search.closed = NULL;
+    return false;
+  }
+  search.id = 0;
+  return true;
+}
+
+static bool pushOpen(int cell, float f) {
+  if (search.openCount == search.openCapacity) {
+    int capacity = search.openCapacity ? search.openCapacity * 2 : 1024;
+    OpenNode *resized =
+        (OpenNode *)realloc(search.open, capacity * sizeof(OpenNode));
+    if (resized == NULL) {
+      printf("Memory allocation failed\n");
+      return false;
+    }
+    search.open = resized;
+    search.openCapacity = capacity;
+  }
+  int i = search.openCount++;
+  while (i > 0 && search.open[(i - 1) / 2].f > f) {
+    search.open[i] = search.open[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  search.open[i] = (OpenNode){f, cell};
+  return true;
+}
+
+static OpenNode popOpen(void) {
+  OpenNode top = search.open[0];
+  OpenNode last = search.open[--search.openCount];
+  int i = 0;
+  for (;;) {
+    int child = i * 2 + 1;
+    if (child >= search.openCount) {
+      break;
+    }
+    if (child + 1 < search.openCount &&
+        search.open[child + 1].f < search.open[child].f) {
+      child++;
+    }
+    if (search.open[child].f >= last.f) {
+      break;
+    }
+    search.open[i] = search.open[child];
+    i = child;
+  }
+  search.open[i] = last;
+  return top;
+}
+
+// Scans one line of a walk map bitmap from pos in direction dir for the
+// cell ending a straight jump: target, or a cell with a forced neighbour,
+// one open on an adjacent line whose cell one step back is closed. Returns
+// its position, or -1 when a closed cell or the map's edge comes first.
+static int scanLine(uint64_t (*lines)[WALK_WORDS], int line, int pos,
+                    int dir, int target) {
+  if (pos < 0 || pos >= GRID_SIZE) {
+    return -1;
+  }
+  const uint64_t *cur = lines[line];
+  const uint64_t *sides[2] = {line > 0 ? lines[line - 1] : NULL,
+                              line < GRID_SIZE - 1 ? lines[line + 1] : NULL};
+  int word = pos / 64;
+  uint64_t mask = dir > 0 ? ~0ULL << (pos % 64) : ~0ULL >> (63 - pos % 64);
+  while (word >= 0 && word < WALK_WORDS) {
+    uint64_t stops = ~cur[word];
+    for (int s = 0; s < 2; s++) {
+      const uint64_t *side = sides[s];
+      if (side == NULL) {
+        continue;
+      }
+      // Bit i set when the side cell one step back from i is open
+      uint64_t behind =
+          dir > 0 ? side[word] << 1 | (word > 0 ? side[word - 1] >> 63 : 0)
+                  : side[word] >> 1 |
+                        (word + 1 < WALK_WORDS ? side[word + 1] << 63 : 0);
+      stops |= side[word] & ~behind;
+    }
+    if (target >= 0 && target / 64 == word) {
+      stops |= 1ULL << (target % 64);
+    }
+    stops &= mask;
+    if (stops != 0) {
+      int bit = dir > 0 ? lowestBit(stops) : highestBit(stops);
+      return (cur[word] >> bit) & 1 ? word * 64 + bit : -1;
+    }
+    word += dir;
+    mask = ~0ULL;
+  }
+  return -1;
+}
+
+// Follows direction (dx, dy) from (x, y) to the next jump point. Returns
+// false when a closed cell or the map's edge comes first.
+static bool jump(int x, int y, int dx, int dy, int goalX, int goalY,
+                 int *jumpX, int *jumpY) {
+  if (dy == 0) {
+    *jumpX = scanLine(walkMap.rows, y, x + dx, dx, y == goalY ? goalX : -1);
+    *jumpY = y;
+    return *jumpX >= 0;
+  }
+  if (dx == 0) {
+    *jumpX = x;
+    *jumpY = scanLine(walkMap.cols, x, y + dy, dy, x == goalX ? goalY : -1);
+    return *jumpY >= 0;
+  }
+
+  // A diagonal stops where a straight jump along either component would
+  for (;;) {
+    x += dx;
+    y += dy;
+    if (!walkMapGet(x, y)) {
+      return false;
+    }
+    if ((x == goalX && y == goalY) ||
+        scanLine(walkMap.rows, y, x + dx, dx, y == goalY ? goalX : -1) >= 0 ||
+        scanLine(walkMap.cols, x, y + dy, dy, x == goalX ? goalY : -1) >= 0) {
+      *jumpX = x;
+      *jumpY = y;
+      return true;
+    }
+    if (!walkMapGet(x + dx, y) || !walkMapGet(x, y + dy)) {
+      return false;
+    }
+  }
+}
+
+// Directions worth jumping in from (x, y) when it was reached moving
+// (dx, dy), or every open direction from the start. Diagonal moves never
+// cut the corner of a closed cell.
+static int pruneDirections(int x, int y, int dx, int dy, int dirs[8][2]) {
+  int count = 0;
+  if (dx == 0 && dy == 0) {
+    for (int ddx = -1; ddx <= 1; ddx++) {
+      for (int ddy = -1; ddy <= 1; ddy++) {
+        if ((ddx != 0 || ddy != 0) && walkMapGet(x + ddx, y) &&
+            walkMapGet(x, y + ddy) && walkMapGet(x + ddx, y + ddy)) {
+          dirs[count][0] = ddx;
+          dirs[count++][1] = ddy;
+        }
+      }
+    }
+  } else if (dx != 0 && dy != 0) {
+    bool alongX = walkMapGet(x + dx, y);
+    bool alongY = walkMapGet(x, y + dy);
+    if (alongY) {
+      dirs[count][0] = 0;
+      dirs[count++][1] = dy;
+    }
+    if (alongX) {
+      dirs[count][0] = dx;
+      dirs[count++][1] = 0;
+    }
+    if (alongX && alongY) {
+      dirs[count][0] = dx;
+      dirs[count++][1] = dy;
+    }
+  } else {
+    // Straight moves turn to either side where the side is open
+    int sideX = dy != 0;
+    int sideY = dx != 0;
+    bool ahead = walkMapGet(x + dx, y + dy);
+    for (int side = -1; side <= 1; side += 2) {
+      if (!walkMapGet(x + side * sideX, y + side * sideY)) {
+        continue;
+      }
+      dirs[count][0] = side * sideX;
+      dirs[count++][1] = side * sideY;
+      if (ahead) {
+        dirs[count][0] = dx + side * sideX;
+        dirs[count++][1] = dy + side * sideY;
+      }
+    }
+    if (ahead) {
+      dirs[count][0] = dx;
+      dirs[count++][1] = dy;
+    }
+  }
+  return count;
+}
+
+// Stores the jump points from the start to goal, following parents back
+static bool tracePath(int goal, PathfindResult *result) {
+  int count = 0;
+  for (int cell = goal; cell >= 0; cell = search.parent[cell]) {
+    count++;
+  }
+  if (count > result->pointCapacity) {
+    int(*resized)[2] =
+        (int(*)[2])realloc(result->points, count * sizeof(int[2]));
+    if (resized == NULL) {
+      printf("Memory allocation failed\n");
+      return false;
+    }
+    result->points = resized;
+    result->pointCapacity = count;
+  }
+
+  result->pointCount = count;
+  int i = count;
+  for (int cell = goal; cell >= 0; cell = search.parent[cell]) {
+    i--;
+    result->points[i][0] = cell / GRID_SIZE;
+    result->points[i][1] = cell % GRID_SIZE;
+  }
+  result->steps = 0;
+  for (i = 1; i < count; i++) {
+    int dx = abs(result->points[i][0] - result->points[i - 1][0]);
+    int dy = abs(result->points[i][1] - result->points[i - 1][1]);
+    result->steps += dx > dy ? dx : dy;
+  }
+  return true;
+}
+
+static void runTool(Map *map, Tile tileTypes[]) {
+  double start = profileNow();
+  pathfindQuery(map, tileTypes, pathfindTool.startX, pathfindTool.startY,
+                pathfindTool.goalX, pathfindTool.goalY, &pathfindTool.result);
+  pathfindTool.elapsed = profileNow() - start;
+  pathfindTool.walkVersion = walkMap.version;
+  pathfindTool.stale = false;
+}
+
+// Pathfind functions
+// Cost of the cheapest unobstructed route between two cells
+float pathfindOctile(int x0, int y0, int x1, int y1) {
+  int dx = abs(x1 - x0);
+  int dy = abs(y1 - y0);
+  int diagonal = dx < dy ? dx : dy;
+  return (float)(dx + dy - 2 * diagonal) + diagonal * PATHFIND_DIAGONAL_COST;
+}
+
+// A* with jump point search over the walk map, moving in eight directions.
+// Only jump points enter the open list, and straight jumps skip a word of
+// cells at a time. Returns true when goal is reachable from start.
+bool pathfindFind(Map *map, Tile tileTypes[], int startX, int startY,
+                  int goalX, int goalY, PathfindResult *result) {
+  walkMapUpdate(map, tileTypes);
+  result->pointCount = 0;
+  result->steps = 0;
+  result->cost = 0.0f;
+  result->expanded = 0;
+  result->found = false;
+  if (!walkMapGet(startX, startY) || !walkMapGet(goalX, goalY) ||
+      !allocSearch()) {
+    return false;
+  }
+
+  traceBegin("pathfindFind");
+  // Stamps are cleared only when the search id wraps
+  if (++search.id == 0) {
+    size_t cells = (size_t)GRID_SIZE * GRID_SIZE;
+    memset(search.opened, 0, cells * sizeof(unsigned int));
+    memset(search.closed, 0, cells * sizeof(unsigned int));
+    search.id = 1;
+  }
+  int start = startX * GRID_SIZE + startY;
+  int goal = goalX * GRID_SIZE + goalY;
+  search.openCount = 0;
+  search.g[start] = 0.0f;
+  search.parent[start] = -1;
+  search.opened[start] = search.id;
+  bool searching =
+      pushOpen(start, pathfindOctile(startX, startY, goalX, goalY));
+
+  while (searching && search.openCount > 0) {
+    OpenNode node = popOpen();
+    if (search.closed[node.cell] == search.id) {
+      continue;
+    }
+    search.closed[node.cell] = search.id;
+    result->expanded++;
+    if (node.cell == goal) {
+      result->found = tracePath(goal, result);
+      result->cost = search.g[goal];
+      break;
+    }
+
+    int x = node.cell / GRID_SIZE;
+    int y = node.cell % GRID_SIZE;
+    int dx = 0;
+    int dy = 0;
+    int parent = search.parent[node.cell];
+    if (parent >= 0) {
+      dx = sign(x - parent / GRID_SIZE);
+      dy = sign(y - parent % GRID_SIZE);
+    }
+    int dirs[8][2];
+    int dirCount = pruneDirections(x, y, dx, dy, dirs);
+    for (int i = 0; i < dirCount && searching; i++) {
+      int jumpX, jumpY;
+      if (!jump(x, y, dirs[i][0], dirs[i][1], goalX, goalY, &jumpX,
+                &jumpY)) {
+        continue;
+      }
+      int next = jumpX * GRID_SIZE + jumpY;
+      if (search.closed[next] == search.id) {
+        continue;
+      }
+      float g = search.g[node.cell] + pathfindOctile(x, y, jumpX, jumpY);
+      if (search.opened[next] != search.id || g < search.g[next]) {
+        search.opened[next] = search.id;
+        search.g[next] = g;
+        search.parent[next] = node.cell;
+        searching =
+            pushOpen(next, g + pathfindOctile(jumpX, jumpY, goalX, goalY));
+      }
+    }
+  }
+  traceEnd("pathfindFind");
+  return result->found;
+}
+
+// Finds a path with the search the tool is set to
+bool pathfindQuery(Map *map, Tile tileTypes[], int startX, int startY,
+                   int goalX, int goalY, PathfindResult *result) {
+  if (pathfindTool.hierarchical) {
+    return hpaFind(map, tileTypes, startX, startY, goalX, goalY, result);
+  }
+  return pathfindFind(map, tileTypes, startX, startY, goalX, goalY, result);
+}
+
+void pathfindSetHierarchical(bool hierarchical) {
+  pathfindTool.hierarchical = hierarchical;
+  pathfindTool.stale = true;
+}
+
+// F4 toggles the tool. While it is on it owns the left button: a press
+// picks the start, the next the goal and the one after a new start. The
+// path is found again whenever walkable cells change. Returns true while
+// the left button belongs to the tool.
+bool pathfindHandleInput(const InputFrame *input, Map *map, Tile tileTypes[],
+                         Camera2D camera) {
+  if (inputKeyPressed(input, KEY_F4)) {
+    pathfindTool.active = !pathfindTool.active;
+  }
+  if (!pathfindTool.active) {
+    return false;
+  }
+
+  if (inputMouseButtonPressed(input, MOUSE_BUTTON_LEFT)) {
+    WorldCoords cell =
+        getWorldGridCoords(input->mousePos, input->mousePos, camera);
+    if (!pathfindTool.hasStart || pathfindTool.hasGoal) {
+      pathfindTool.startX = cell.startX;
+      pathfindTool.startY = cell.startY;
+      pathfindTool.hasStart = true;
+      pathfindTool.hasGoal = false;
+    } else {
+      pathfindTool.goalX = cell.startX;
+      pathfindTool.goalY = cell.startY;
+      pathfindTool.hasGoal = true;
+      runTool(map, tileTypes);
+    }
+  }
+  if (pathfindTool.hasGoal) {
+    walkMapUpdate(map, tileTypes);
+    if (pathfindTool.stale || walkMap.version != pathfindTool.walkVersion) {
+      runTool(map, tileTypes);
+    }
+  }
+  return true;
+}
+
+// Draws the picked cells and the path between them, in world space
+void pathfindDraw(void) {
+  if (!pathfindTool.active || !pathfindTool.hasStart) {
+    return;
+  }
+  PathfindResult *result = &pathfindTool.result;
+  float half = TILE_SIZE / 2.0f;
+  if (pathfindTool.hasGoal && result->found) {
+    for (int i = 0; i < result->pointCount; i++) {
+      Vector2 point = {result->points[i][0] * TILE_SIZE + half,
+                       result->points[i][1] * TILE_SIZE + half};
+      if (i > 0) {
+        Vector2 previous = {result->points[i - 1][0] * TILE_SIZE + half,
+                            result->points[i - 1][1] * TILE_SIZE + half};
+        DrawLineEx(previous, point, TILE_SIZE / 4.0f, Fade(SKYBLUE, 0.8f));
+      }
+      DrawCircleV(point, TILE_SIZE / 6.0f, ORANGE);
+    }
+  }
+  DrawRectangleLines(pathfindTool.startX * TILE_SIZE,
+                     pathfindTool.startY * TILE_SIZE, TILE_SIZE, TILE_SIZE,
+                     GREEN);
+  if (pathfindTool.hasGoal) {
+    DrawRectangleLines(pathfindTool.goalX * TILE_SIZE,
+                       pathfindTool.goalY * TILE_SIZE, TILE_SIZE, TILE_SIZE,
+                       RED);
+  }
+}
+
+// Cost of the path, or what to click next, in the top-right corner of the
+// screen
+void pathfindDrawReadout(int screenWidth) {
+  if (!pathfindTool.active) {
+    return;
+  }
+  char text[128];
+  const char *search = pathfindTool.hierarchical ? "hpa" : "jps";
+  PathfindResult *result = &pathfindTool.result;
+  if (!pathfindTool.hasStart) {
+    snprintf(text, sizeof(text), "path (%s): click a start cell", search);
+  } else if (!pathfindTool.hasGoal) {
+    snprintf(text, sizeof(text), "path (%s): click a goal cell", search);
+  } else if (result->found) {
+    snprintf(text, sizeof(text), "path (%s): cost %.1f, %d steps (%.2f ms)",
+             search, result->cost, result->steps, pathfindTool.elapsed);
+  } else {
+    snprintf(text, sizeof(text), "path (%s): unreachable (%.2f ms)", search,
+             pathfindTool.elapsed);
+  }
+
+  int width = MeasureText(text, PATHFIND_FONT_SIZE);
+  DrawRectangle(screenWidth - width - 15, 5, width + 10,
+                PATHFIND_FONT_SIZE + 8, Fade(BLACK, 0.6f));
+  DrawText(text, screenWidth - width - 10, 9, PATHFIND_FONT_SIZE, RAYWHITE);
+}
+
+void pathfindResultFree(PathfindResult *result) {
+  free(result->points);
+  memset(result, 0, sizeof(PathfindResult));
+}
+
+void pathfindUnload(void) {
+  pathfindResultFree(&pathfindTool.result);
+  free(search.g);
+  free(search.parent);
+  free(search.opened);
+  free(search.closed);
+  free(search.open);
+  memset(&search, 0, sizeof(PathfindSearch));
+  memset(&pathfindTool, 0, sizeof(PathfindTool));
+}
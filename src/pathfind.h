@@ -0,0 +1,67 @@
+// pathfind.h
+#ifndef PATHFIND_H
+#define PATHFIND_H
+
+// includes
+#include "database.h"
+#include "input.h"
+#include <raylib.h>
+#include <stdbool.h>
+
+// definitions
+#define PATHFIND_DIAGONAL_COST 1.41421356f // straight steps cost 1
+#define PATHFIND_FONT_SIZE 10
+
+// structs
+typedef struct {
+  int (*points)[2]; // jump points from start to goal
+  int pointCount;
+  int pointCapacity;
+  int steps;    // cells moved along the path
+  float cost;   // straight steps cost 1, diagonal ones PATHFIND_DIAGONAL_COST
+  int expanded; // cells taken from the open list
+  bool found;
+} PathfindResult;
+
+// Interactive path query between two clicked cells
+typedef struct {
+  bool active;       // the tool owns left presses
+  bool hierarchical; // search the hpa.c abstraction instead of cells
+  bool stale;        // the result needs finding again
+  bool hasStart;
+  bool hasGoal;
+  int startX;
+  int startY;
+  int goalX;
+  int goalY;
+  unsigned int walkVersion; // walkMap.version the result was found at
+  double elapsed;           // milliseconds the last search took
+  PathfindResult result;
+} PathfindTool;
+
+// globals
+extern PathfindTool pathfindTool;
+
+// functions
+float pathfindOctile(int x0, int y0, int x1, int y1);
+
+bool pathfindFind(Map *map, Tile tileTypes[], int startX, int startY,
+                  int goalX, int goalY, PathfindResult *result);
+
+bool pathfindQuery(Map *map, Tile tileTypes[], int startX, int startY,
+                   int goalX, int goalY, PathfindResult *result);
+
+void pathfindSetHierarchical(bool hierarchical);
+
+bool pathfindHandleInput(const InputFrame *input, Map *map, Tile tileTypes[],
+                         Camera2D camera);
+
+void pathfindDraw(void);
+
+void pathfindDrawReadout(int screenWidth);
+
+void pathfindResultFree(PathfindResult *result);
+
+void pathfindUnload(void);
+
+#endif // PATHFIND_H
@@ -0,0 +1,165 @@
+// profile.c
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+
+#include "profile.h"
+#include "trace.h"
+#include <raylib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Variables
+Profiler profiler = {0};
+
+static const char *stageNames[STAGE_COUNT] = {
+    "input",         "draw_map", "update_drawn", "wall_orient",
+    "preview_edges", "commit",   "command",      "present"};
+
+// Helper functions
+static FrameProfile *currentFrame(void) {
+  return &profiler.history[profiler.head];
+}
+
+// Returns the completed frame `back` frames ago (0 is the latest)
+static FrameProfile *completedFrame(int back) {
+  int index = (profiler.head - 1 - back + PROFILE_HISTORY) % PROFILE_HISTORY;
+  return &profiler.history[index];
+}
+
+// Profiler functions
+double profileNow(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+void profileBeginFrame(void) {
+  memset(currentFrame(), 0, sizeof(FrameProfile));
+  profiler.lastTextureId = 0;
+  profiler.frameStart = profileNow();
+  traceBegin("frame");
+}
+
+void profileEndFrame(void) {
+  currentFrame()->frameMs = profileNow() - profiler.frameStart;
+  traceEnd("frame");
+
+  profiler.head = (profiler.head + 1) % PROFILE_HISTORY;
+  if (profiler.count < PROFILE_HISTORY) {
+    profiler.count++;
+  }
+}
+
+// Ends the frame without keeping it, for frames whose timings are not work
+// done, such as one that blocked on window events
+void profileDiscardFrame(void) { traceEnd("frame"); }
+
+const FrameProfile *profileLastFrame(void) { return completedFrame(0); }
+
+void profileBeginStage(ProfileStage stage) {
+  profiler.stageStart[stage] = profileNow();
+  traceBegin(stageNames[stage]);
+}
+
+void profileEndStage(ProfileStage stage) {
+  currentFrame()->stageMs[stage] += profileNow() - profiler.stageStart[stage];
+  traceEnd(stageNames[stage]);
+}
+
+void profileCountDraw(Texture2D texture) {
+  FrameProfile *frame = currentFrame();
+  frame->drawCalls++;
+  if (texture.id != profiler.lastTextureId) {
+    frame->textureBinds++;
+    profiler.lastTextureId = texture.id;
+  }
+}
+
+void profileCountCells(int cells) { currentFrame()->cellsDrawn += cells; }
+
+const char *profileStageName(ProfileStage stage) { return stageNames[stage]; }
+
+void profileDrawOverlay(int screenWidth, int screenHeight) {
+  (void)screenHeight;
+
+  if (!profiler.showOverlay || profiler.count == 0) {
+    return;
+  }
+
+  // Average the most recent frames
+  int frames = profiler.count < PROFILE_AVERAGE_FRAMES ? profiler.count
+                                                       : PROFILE_AVERAGE_FRAMES;
+  FrameProfile avg = {0};
+  for (int i = 0; i < frames; i++) {
+    FrameProfile *frame = completedFrame(i);
+    for (int s = 0; s < STAGE_COUNT; s++) {
+      avg.stageMs[s] += frame->stageMs[s] / frames;
+    }
+    avg.frameMs += frame->frameMs / frames;
+  }
+  FrameProfile *last = completedFrame(0);
+
+  int fontSize = 16;
+  int lineHeight = 18;
+  int lines = STAGE_COUNT + 4;
+  int width = 300;
+  int x = screenWidth - width - 10;
+  int y = 10;
+
+  DrawRectangle(x, y, width, lines * lineHeight + 10, Fade(BLACK, 0.75f));
+  x += 5;
+  y += 5;
+
+  DrawText(TextFormat("frame %6.2f ms (avg %6.2f)", last->frameMs,
+                      avg.frameMs),
+           x, y, fontSize, RAYWHITE);
+  y += lineHeight;
+
+  for (int s = 0; s < STAGE_COUNT; s++) {
+    DrawText(TextFormat("%-13s %6.2f ms (avg %6.2f)", stageNames[s],
+                        last->stageMs[s], avg.stageMs[s]),
+             x, y, fontSize, LIGHTGRAY);
+    y += lineHeight;
+  }
+
+  DrawText(TextFormat("draw calls    %d", last->drawCalls), x, y, fontSize,
+           YELLOW);
+  y += lineHeight;
+  DrawText(TextFormat("texture binds %d", last->textureBinds), x, y, fontSize,
+           YELLOW);
+  y += lineHeight;
+  DrawText(TextFormat("cells drawn   %d", last->cellsDrawn), x, y, fontSize,
+           YELLOW);
+}
+
+int profileDumpCsv(const char *path, int frames) {
+  if (frames > profiler.count) {
+    frames = profiler.count;
+  }
+
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    printf("Error opening profile output %s\n", path);
+    return -1;
+  }
+
+  fprintf(file, "frame,frame_ms");
+  for (int s = 0; s < STAGE_COUNT; s++) {
+    fprintf(file, ",%s_ms", stageNames[s]);
+  }
+  fprintf(file, ",draw_calls,texture_binds,cells_drawn\n");
+
+  // Oldest frame first
+  for (int i = frames - 1; i >= 0; i--) {
+    FrameProfile *frame = completedFrame(i);
+    fprintf(file, "%d,%.4f", frames - 1 - i, frame->frameMs);
+    for (int s = 0; s < STAGE_COUNT; s++) {
+      fprintf(file, ",%.4f", frame->stageMs[s]);
+    }
+    fprintf(file, ",%d,%d,%d\n", frame->drawCalls, frame->textureBinds,
+            frame->cellsDrawn);
+  }
+
+  fclose(file);
+  return frames;
+}
@@ -0,0 +1,73 @@
+// profile.h
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// includes
+#include <raylib.h>
+#include <stdbool.h>
+
+// definitions
+#define PROFILE_HISTORY 600       // frames kept in the rolling history
+#define PROFILE_AVERAGE_FRAMES 60 // frames averaged by the overlay
+
+// enums
+typedef enum {
+  STAGE_INPUT,         // window, camera, zoom and undo/redo handling
+  STAGE_DRAW_MAP,      // drawExistingMap (including the preview map)
+  STAGE_UPDATE_DRAWN,  // updateDrawnTiles and painter buffer updates
+  STAGE_WALL_ORIENT,   // calculateWallOrientations
+  STAGE_PREVIEW_EDGES, // edge/wall recompute in drawPreview
+  STAGE_COMMIT,        // mouse release: undo batch, apply, recompute
+  STAGE_COMMAND,       // handleCommandMode
+  STAGE_PRESENT,       // EndDrawing (buffer swap and frame wait)
+  STAGE_COUNT
+} ProfileStage;
+
+// structs
+typedef struct {
+  double stageMs[STAGE_COUNT]; // accumulated time per stage
+  double frameMs;              // total time between frame begin and end
+  int drawCalls;               // textured sprite submissions
+  int textureBinds;            // texture switches between submissions
+  int cellsDrawn;              // grid cells visited by drawExistingMap
+} FrameProfile;
+
+typedef struct {
+  FrameProfile history[PROFILE_HISTORY]; // ring buffer of frames
+  int head;                              // slot of the frame being recorded
+  int count;                             // completed frames in history
+  double frameStart;
+  double stageStart[STAGE_COUNT];
+  unsigned int lastTextureId; // last texture submitted this frame
+  bool showOverlay;
+} Profiler;
+
+// globals
+extern Profiler profiler;
+
+// functions
+double profileNow(void);
+
+void profileBeginFrame(void);
+
+void profileEndFrame(void);
+
+void profileDiscardFrame(void);
+
+const FrameProfile *profileLastFrame(void);
+
+void profileBeginStage(ProfileStage stage);
+
+void profileEndStage(ProfileStage stage);
+
+void profileCountDraw(Texture2D texture);
+
+void profileCountCells(int cells);
+
+const char *profileStageName(ProfileStage stage);
+
+void profileDrawOverlay(int screenWidth, int screenHeight);
+
+int profileDumpCsv(const char *path, int frames);
+
+#endif // PROFILE_H
@@ -0,0 +1,195 @@
+// regiontree.c
+#include "regiontree.h"
+#include "chunk.h"
+#include "runindex.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+RegionTree regionTree = {0};
+
+// Helper functions
+static int nodeIndex(int level, int nx, int ny) {
+  return regionTree.levelStart[level] + nx * regionTree.levelSide[level] + ny;
+}
+
+// Key of two parts of a region; REGION_NONE parts add nothing
+static int mergeKeys(int a, int b) {
+  if (a == REGION_NONE) {
+    return b;
+  }
+  if (b == REGION_NONE) {
+    return a;
+  }
+  return a == b ? a : REGION_MIXED;
+}
+
+static int nodeKey(const RegionNode *node, DrawType drawType) {
+  return drawType == DRAW_TILE ? node->tileKey : node->wallKey;
+}
+
+static bool allocTree(void) {
+  int side = CHUNK_COUNT;
+  int total = 0;
+  regionTree.levelCount = 0;
+  while (regionTree.levelCount < REGION_LEVEL_MAX) {
+    regionTree.levelStart[regionTree.levelCount] = total;
+    regionTree.levelSide[regionTree.levelCount] = side;
+    regionTree.levelCount++;
+    total += side * side;
+    if (side == 1) {
+      break;
+    }
+    side = (side + 1) / 2;
+  }
+
+  regionTree.nodes = (RegionNode *)malloc(total * sizeof(RegionNode));
+  regionTree.pending = (unsigned char *)calloc(total, 1);
+  if (regionTree.nodes == NULL || regionTree.pending == NULL) {
+    printf("Memory allocation failed\n");
+    regionTreeUnload();
+    return false;
+  }
+  return true;
+}
+
+// Recomputes a node above level 0 from its children
+static void refreshNode(int level, int nx, int ny) {
+  RegionNode merged = {REGION_NONE, REGION_NONE};
+  int side = regionTree.levelSide[level - 1];
+  for (int cx = nx * 2; cx < nx * 2 + 2 && cx < side; cx++) {
+    for (int cy = ny * 2; cy < ny * 2 + 2 && cy < side; cy++) {
+      RegionNode *child = &regionTree.nodes[nodeIndex(level - 1, cx, cy)];
+      merged.tileKey = mergeKeys(merged.tileKey, child->tileKey);
+      merged.wallKey = mergeKeys(merged.wallKey, child->wallKey);
+    }
+  }
+  regionTree.nodes[nodeIndex(level, nx, ny)] = merged;
+}
+
+// Key shared by the cells of rect below a node, REGION_NONE when rect
+// misses the node. Uniform nodes and mixed nodes inside rect answer at
+// once; only chunks that are mixed and cut by rect are scanned.
+static int queryNode(const Map *map, DrawType drawType, int level, int nx,
+                     int ny, const WorldCoords *rect) {
+  int span = CHUNK_SIZE << level;
+  int startX = nx * span;
+  int startY = ny * span;
+  int endX = startX + span - 1 < GRID_SIZE - 1 ? startX + span - 1
+                                               : GRID_SIZE - 1;
+  int endY = startY + span - 1 < GRID_SIZE - 1 ? startY + span - 1
+                                               : GRID_SIZE - 1;
+  if (startX > rect->endX || endX < rect->startX || startY > rect->endY ||
+      endY < rect->startY) {
+    return REGION_NONE;
+  }
+
+  int key = nodeKey(&regionTree.nodes[nodeIndex(level, nx, ny)], drawType);
+  bool covered = rect->startX <= startX && rect->endX >= endX &&
+                 rect->startY <= startY && rect->endY >= endY;
+  if (key != REGION_MIXED || covered) {
+    return key;
+  }
+
+  if (level == 0) {
+    int plane = drawType == DRAW_TILE ? 0 : 2;
+    int fromX = startX > rect->startX ? startX : rect->startX;
+    int fromY = startY > rect->startY ? startY : rect->startY;
+    int toX = endX < rect->endX ? endX : rect->endX;
+    int toY = endY < rect->endY ? endY : rect->endY;
+    key = map->grid[fromX][fromY][plane];
+    for (int x = fromX; x <= toX; x++) {
+      for (int y = fromY; y <= toY; y++) {
+        if (map->grid[x][y][plane] != key) {
+          return REGION_MIXED;
+        }
+      }
+    }
+    return key;
+  }
+
+  key = REGION_NONE;
+  int side = regionTree.levelSide[level - 1];
+  for (int cx = nx * 2; cx < nx * 2 + 2 && cx < side; cx++) {
+    for (int cy = ny * 2; cy < ny * 2 + 2 && cy < side; cy++) {
+      key = mergeKeys(key,
+                      queryNode(map, drawType, level - 1, cx, cy, rect));
+      if (key == REGION_MIXED) {
+        return REGION_MIXED;
+      }
+    }
+  }
+  return key;
+}
+
+// Region tree functions
+// Refreshes the nodes above changed chunks, building the whole tree when
+// the map is new to it. Call before a batch of queries.
+void regionTreeUpdate(Map *map) {
+  bool rebuild = regionTree.owner != map || regionTree.nodes == NULL;
+  if (rebuild) {
+    regionTreeUnload();
+    if (!allocTree()) {
+      return;
+    }
+    regionTree.owner = map;
+  }
+
+  traceBegin("regionTreeUpdate");
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      if (!rebuild && !chunkIsDirty(map, cx, cy, CHUNK_DIRTY_REGION)) {
+        continue;
+      }
+      RegionNode *node = &regionTree.nodes[nodeIndex(0, cx, cy)];
+      node->tileKey = runIndexUniformTile(map, cx, cy);
+      node->wallKey = runIndexUniformWall(map, cx, cy);
+      clearChunkDirty(map, cx, cy, CHUNK_DIRTY_REGION);
+      if (regionTree.levelCount > 1) {
+        regionTree.pending[nodeIndex(1, cx / 2, cy / 2)] = 1;
+      }
+    }
+  }
+
+  for (int level = 1; level < regionTree.levelCount; level++) {
+    int side = regionTree.levelSide[level];
+    for (int nx = 0; nx < side; nx++) {
+      for (int ny = 0; ny < side; ny++) {
+        int index = nodeIndex(level, nx, ny);
+        if (!regionTree.pending[index]) {
+          continue;
+        }
+        refreshNode(level, nx, ny);
+        regionTree.pending[index] = 0;
+        if (level + 1 < regionTree.levelCount) {
+          regionTree.pending[nodeIndex(level + 1, nx / 2, ny / 2)] = 1;
+        }
+      }
+    }
+  }
+  traceEnd("regionTreeUpdate");
+}
+
+// Key of drawType shared by every cell of rect, or REGION_MIXED when they
+// differ. Reflects the map as of the last regionTreeUpdate.
+int regionUniformKey(const Map *map, DrawType drawType, WorldCoords rect) {
+  if (regionTree.owner != map) {
+    return REGION_MIXED;
+  }
+  rect.startX = rect.startX > 0 ? rect.startX : 0;
+  rect.startY = rect.startY > 0 ? rect.startY : 0;
+  rect.endX = rect.endX < GRID_SIZE - 1 ? rect.endX : GRID_SIZE - 1;
+  rect.endY = rect.endY < GRID_SIZE - 1 ? rect.endY : GRID_SIZE - 1;
+  if (rect.startX > rect.endX || rect.startY > rect.endY) {
+    return REGION_NONE;
+  }
+  return queryNode(map, drawType, regionTree.levelCount - 1, 0, 0, &rect);
+}
+
+void regionTreeUnload(void) {
+  free(regionTree.nodes);
+  free(regionTree.pending);
+  memset(&regionTree, 0, sizeof(RegionTree));
+}
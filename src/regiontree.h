@@ -0,0 +1,44 @@
+// regiontree.h
+#ifndef REGIONTREE_H
+#define REGIONTREE_H
+
+// includes
+#include "database.h"
+#include "draw.h"
+#include "grid.h"
+#include <stdbool.h>
+
+// definitions
+#define REGION_LEVEL_MAX 16 // enough for any CHUNK_COUNT up to 1 << 15
+#define REGION_MIXED -1     // cells below a node differ
+#define REGION_NONE -2      // a query rectangle misses a node
+
+// structs
+typedef struct {
+  int tileKey; // key of every cell below the node, or REGION_MIXED
+  int wallKey;
+} RegionNode;
+
+// Pyramid of uniform keys over the chunks. Level 0 has a node per chunk and
+// each level above halves the side, up to a single root. Nodes are
+// refreshed from chunks marked CHUNK_DIRTY_REGION by regionTreeUpdate.
+typedef struct {
+  const Map *owner;
+  RegionNode *nodes;            // every level, level 0 first
+  unsigned char *pending;       // nodes whose children changed
+  int levelStart[REGION_LEVEL_MAX];
+  int levelSide[REGION_LEVEL_MAX];
+  int levelCount;
+} RegionTree;
+
+// globals
+extern RegionTree regionTree;
+
+// functions
+void regionTreeUpdate(Map *map);
+
+int regionUniformKey(const Map *map, DrawType drawType, WorldCoords rect);
+
+void regionTreeUnload(void);
+
+#endif // REGIONTREE_H
@@ -0,0 +1,158 @@
+// renderbench.c
+#include "renderbench.h"
+#include "chunk.h"
+#include "draw.h"
+#include "edge.h"
+#include "keyindex.h"
+#include "math.h"
+#include "profile.h"
+#include "trace.h"
+#include "wall.h"
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Helper functions
+static int compareDoubles(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int count, double p) {
+  int index = (int)(p * (count - 1) + 0.5);
+  return sorted[index];
+}
+
+// Zoom of a step, spaced geometrically from zoomMax down to zoomMin
+static float stepZoom(const RenderBenchOptions *options, int step) {
+  if (options->zoomSteps < 2) {
+    return options->zoomMax;
+  }
+  float t = (float)step / (float)(options->zoomSteps - 1);
+  return options->zoomMax * powf(options->zoomMin / options->zoomMax, t);
+}
+
+// Camera target on a circle around the map centre, one lap per zoom step
+static Vector2 pathTarget(int frame, int framesPerStep) {
+  float centre = GRID_SIZE * TILE_SIZE / 2.0f;
+  float radius = GRID_SIZE * TILE_SIZE / 4.0f;
+  float angle = 2.0f * PI * (float)frame / (float)framesPerStep;
+  return (Vector2){centre + radius * cosf(angle),
+                   centre + radius * sinf(angle)};
+}
+
+// Render bench functions
+// Fill the map with 4x4 blocks of random terrain and sparse walls
+void generateBenchMap(Map *map, Tile *tileTypes, unsigned int seed) {
+  srand(seed);
+  for (int bx = 0; bx < GRID_SIZE; bx += 4) {
+    for (int by = 0; by < GRID_SIZE; by += 4) {
+      int tileKey = 1 + rand() % 5;
+      for (int x = bx; x < bx + 4 && x < GRID_SIZE; x++) {
+        for (int y = by; y < by + 4 && y < GRID_SIZE; y++) {
+          map->grid[x][y][0] = tileKey;
+          map->grid[x][y][1] = getRandTileStyle(tileKey, tileTypes);
+          map->grid[x][y][2] = (rand() % 20 == 0) ? 1 + rand() % 8 : 0;
+        }
+      }
+    }
+  }
+  markMapDirty(map);
+}
+
+void renderBenchDefaults(RenderBenchOptions *options) {
+  memset(options, 0, sizeof(RenderBenchOptions));
+  options->framesPerStep = RENDER_BENCH_FRAMES;
+  options->zoomSteps = RENDER_BENCH_ZOOM_STEPS;
+  options->zoomMax = RENDER_BENCH_ZOOM_MAX;
+  options->zoomMin = RENDER_BENCH_ZOOM_MIN;
+  strncpy(options->path, RENDER_BENCH_DEFAULT_PATH, sizeof(options->path) - 1);
+}
+
+// Renders the map along a scripted camera path at each zoom level. Every
+// frame is written to the CSV report and a summary per zoom level is printed.
+int runRenderBench(Editor *editor, const RenderBenchOptions *options) {
+  if (options->framesPerStep < 1 || options->zoomSteps < 1) {
+    printf("Error: render bench needs at least one frame and zoom step\n");
+    return -1;
+  }
+
+  FILE *file = fopen(options->path, "w");
+  if (file == NULL) {
+    printf("Error opening render bench output %s\n", options->path);
+    return -1;
+  }
+
+  if (options->generateMap) {
+    traceBegin("generateBenchMap");
+    memset(editor->map.grid, 0, sizeof(editor->map.grid));
+    generateBenchMap(&editor->map, editor->tileTypes, 1);
+    computeMapEdges(editor->tileTypes, editor->edgeTypes, &editor->map);
+    computeMapWalls(editor->wallTypes, &editor->map);
+    keyIndexBuild(&editor->map);
+    traceEnd("generateBenchMap");
+  }
+
+  // Render as fast as possible
+  SetTargetFPS(0);
+
+  fprintf(file, "step,zoom,frame,frame_ms,draw_map_ms,present_ms,draw_calls,"
+                "texture_binds,cells_drawn\n");
+  printf("Render bench: GRID_SIZE %d, window %dx%d, %d frames per zoom\n",
+         GRID_SIZE, editor->windowState.width, editor->windowState.height,
+         options->framesPerStep);
+  printf("%8s %10s %10s %10s %10s %10s %10s %10s\n", "zoom", "cells",
+         "draws", "mean_ms", "p50_ms", "p95_ms", "p99_ms", "max_ms");
+
+  double *frameMs = (double *)malloc(options->framesPerStep * sizeof(double));
+  Camera2D camera = editor->camera;
+  for (int step = 0; step < options->zoomSteps; step++) {
+    camera.zoom = stepZoom(options, step);
+    long cells = 0;
+    long drawCalls = 0;
+    double sum = 0.0;
+
+    for (int frame = 0; frame < options->framesPerStep; frame++) {
+      camera.target = pathTarget(frame, options->framesPerStep);
+
+      profileBeginFrame();
+      BeginDrawing();
+      ClearBackground(BLACK);
+      BeginMode2D(camera);
+      drawExistingMap(&editor->map, editor->tileTypes, editor->wallTypes,
+                      camera, editor->windowState.width,
+                      editor->windowState.height);
+      EndMode2D();
+      profileBeginStage(STAGE_PRESENT);
+      EndDrawing();
+      profileEndStage(STAGE_PRESENT);
+      profileEndFrame();
+
+      const FrameProfile *profile = profileLastFrame();
+      fprintf(file, "%d,%.4f,%d,%.4f,%.4f,%.4f,%d,%d,%d\n", step,
+              camera.zoom, frame, profile->frameMs,
+              profile->stageMs[STAGE_DRAW_MAP],
+              profile->stageMs[STAGE_PRESENT], profile->drawCalls,
+              profile->textureBinds, profile->cellsDrawn);
+      frameMs[frame] = profile->frameMs;
+      sum += profile->frameMs;
+      cells += profile->cellsDrawn;
+      drawCalls += profile->drawCalls;
+    }
+
+    qsort(frameMs, options->framesPerStep, sizeof(double), compareDoubles);
+    int frames = options->framesPerStep;
+    printf("%8.3f %10ld %10ld %10.4f %10.4f %10.4f %10.4f %10.4f\n",
+           camera.zoom, cells / frames, drawCalls / frames, sum / frames,
+           percentile(frameMs, frames, 0.50), percentile(frameMs, frames, 0.95),
+           percentile(frameMs, frames, 0.99), frameMs[frames - 1]);
+  }
+
+  free(frameMs);
+  fclose(file);
+  SetTargetFPS(60);
+  printf("Render bench written to %s\n", options->path);
+  return 0;
+}
@@ -0,0 +1,34 @@
+// renderbench.h
+#ifndef RENDERBENCH_H
+#define RENDERBENCH_H
+
+// includes
+#include "database.h"
+#include "editor.h"
+#include <stdbool.h>
+
+// definitions
+#define RENDER_BENCH_DEFAULT_PATH "render_bench.csv"
+#define RENDER_BENCH_FRAMES 120 // frames per zoom level
+#define RENDER_BENCH_ZOOM_STEPS 8
+#define RENDER_BENCH_ZOOM_MAX 2.0f
+#define RENDER_BENCH_ZOOM_MIN 0.1f // editor zoom floor
+
+// structs
+typedef struct {
+  int framesPerStep; // frames rendered at each zoom level
+  int zoomSteps;     // zoom levels, spaced geometrically
+  float zoomMax;     // first zoom level
+  float zoomMin;     // last zoom level
+  bool generateMap;  // replace the loaded map with generated terrain
+  char path[256];    // per-frame CSV report
+} RenderBenchOptions;
+
+// functions
+void generateBenchMap(Map *map, Tile *tileTypes, unsigned int seed);
+
+void renderBenchDefaults(RenderBenchOptions *options);
+
+int runRenderBench(Editor *editor, const RenderBenchOptions *options);
+
+#endif // RENDERBENCH_H
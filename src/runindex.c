@@ -0,0 +1,145 @@
+// runindex.c
+#include "runindex.h"
+#include "chunk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+RunIndex runIndex = {0};
+
+// Helper functions
+static bool sameRun(const CellRun *run, const int *cell) {
+  return run->tileKey == cell[0] && run->tileStyle == cell[1] &&
+         run->wallKey == cell[2];
+}
+
+// Runs of chunk (cx, cy), rebuilt first if the chunk changed. NULL when
+// they cannot be stored.
+static ChunkRuns *getChunkRuns(Map *map, int cx, int cy) {
+  if (runIndex.owner != map) {
+    runIndexUnload();
+    runIndex.owner = map;
+  }
+  ChunkRuns *chunk = &runIndex.chunks[cx][cy];
+  if (chunk->runs != NULL && !chunkIsDirty(map, cx, cy, CHUNK_DIRTY_RUNS)) {
+    return chunk;
+  }
+
+  CellRun runs[CHUNK_SIZE * CHUNK_SIZE];
+  int count = 0;
+  int startX = cx * CHUNK_SIZE;
+  int startY = cy * CHUNK_SIZE;
+  int endX = startX + CHUNK_SIZE < GRID_SIZE ? startX + CHUNK_SIZE : GRID_SIZE;
+  int endY = startY + CHUNK_SIZE < GRID_SIZE ? startY + CHUNK_SIZE : GRID_SIZE;
+  int uniformTileKey = map->grid[startX][startY][0];
+  int uniformWallKey = map->grid[startX][startY][2];
+  for (int x = startX; x < endX; x++) {
+    for (int y = startY; y < endY; y++) {
+      const int *cell = map->grid[x][y];
+      if (cell[0] != uniformTileKey) {
+        uniformTileKey = -1;
+      }
+      if (cell[2] != uniformWallKey) {
+        uniformWallKey = -1;
+      }
+      if (count > 0 && sameRun(&runs[count - 1], cell)) {
+        runs[count - 1].length++;
+      } else {
+        runs[count++] = (CellRun){cell[0], cell[1], cell[2], 1};
+      }
+    }
+  }
+
+  if (count != chunk->runCount || chunk->runs == NULL) {
+    CellRun *resized =
+        (CellRun *)realloc(chunk->runs, count * sizeof(CellRun));
+    if (resized == NULL) {
+      printf("Memory allocation failed\n");
+      return NULL;
+    }
+    chunk->runs = resized;
+  }
+  memcpy(chunk->runs, runs, count * sizeof(CellRun));
+  runIndex.runCount += count - chunk->runCount;
+  chunk->runCount = count;
+  chunk->uniformTileKey = uniformTileKey;
+  chunk->uniformWallKey = uniformWallKey;
+  clearChunkDirty(map, cx, cy, CHUNK_DIRTY_RUNS);
+  return chunk;
+}
+
+// Run index functions
+// Tile key shared by every cell of chunk (cx, cy), or -1
+int runIndexUniformTile(Map *map, int cx, int cy) {
+  ChunkRuns *chunk = getChunkRuns(map, cx, cy);
+  return chunk ? chunk->uniformTileKey : -1;
+}
+
+// Wall key shared by every cell of chunk (cx, cy), or -1
+int runIndexUniformWall(Map *map, int cx, int cy) {
+  ChunkRuns *chunk = getChunkRuns(map, cx, cy);
+  return chunk ? chunk->uniformWallKey : -1;
+}
+
+// The only run of chunk (cx, cy), or NULL when its cells differ
+const CellRun *runIndexSingleRun(Map *map, int cx, int cy) {
+  ChunkRuns *chunk = getChunkRuns(map, cx, cy);
+  return chunk && chunk->runCount == 1 ? &chunk->runs[0] : NULL;
+}
+
+void runIterBegin(RunIterator *it, Map *map, int cx, int cy) {
+  it->map = map;
+  it->chunk = getChunkRuns(map, cx, cy);
+  it->x = cx * CHUNK_SIZE;
+  it->y = it->startY = cy * CHUNK_SIZE;
+  it->endX = it->x + CHUNK_SIZE < GRID_SIZE ? it->x + CHUNK_SIZE : GRID_SIZE;
+  it->endY = it->y + CHUNK_SIZE < GRID_SIZE ? it->y + CHUNK_SIZE : GRID_SIZE;
+  it->run = 0;
+  it->runOffset = 0;
+}
+
+// Next piece of a run within one column, starting at (x, y) and covering
+// run->length cells down the column. Returns false past the chunk's end.
+bool runIterNext(RunIterator *it, CellRun *run, int *x, int *y) {
+  if (it->x >= it->endX) {
+    return false;
+  }
+  *x = it->x;
+  *y = it->y;
+
+  int length = 1;
+  if (it->chunk == NULL) {
+    const int *cell = it->map->grid[it->x][it->y];
+    *run = (CellRun){cell[0], cell[1], cell[2], 1};
+  } else {
+    const CellRun *current = &it->chunk->runs[it->run];
+    length = current->length - it->runOffset;
+    if (length > it->endY - it->y) {
+      length = it->endY - it->y;
+    }
+    *run = *current;
+    run->length = length;
+    it->runOffset += length;
+    if (it->runOffset == current->length) {
+      it->run++;
+      it->runOffset = 0;
+    }
+  }
+
+  it->y += length;
+  if (it->y == it->endY) {
+    it->y = it->startY;
+    it->x++;
+  }
+  return true;
+}
+
+void runIndexUnload(void) {
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      free(runIndex.chunks[cx][cy].runs);
+    }
+  }
+  memset(&runIndex, 0, sizeof(RunIndex));
+}
@@ -0,0 +1,61 @@
+// runindex.h
+#ifndef RUNINDEX_H
+#define RUNINDEX_H
+
+// includes
+#include "database.h"
+#include <stdbool.h>
+
+// structs
+// Cells with the same tile key, style and wall key in the order of
+// Map.grid: down a column, then on to the next column of the chunk
+typedef struct {
+  int tileKey;
+  int tileStyle;
+  int wallKey;
+  int length;
+} CellRun;
+
+typedef struct {
+  CellRun *runs; // NULL until the chunk is first summarised
+  int runCount;
+  int uniformTileKey; // tile key of every cell, or -1 when they differ
+  int uniformWallKey; // wall key of every cell, or -1 when they differ
+} ChunkRuns;
+
+// Run-length summary of each chunk of the map, rebuilt lazily from chunks
+// marked CHUNK_DIRTY_RUNS. A uniform chunk is a single run.
+typedef struct {
+  const Map *owner;
+  ChunkRuns chunks[CHUNK_COUNT][CHUNK_COUNT];
+  int runCount; // runs held across the map
+} RunIndex;
+
+// Walks the runs of one chunk a column at a time; runs crossing into the
+// next column are split there
+typedef struct {
+  const Map *map;
+  const ChunkRuns *chunk; // NULL walks the grid one cell at a time
+  int startY, endX, endY; // chunk cells, end exclusive
+  int x, y;               // next cell
+  int run;                // run holding the next cell
+  int runOffset;          // cells of that run already walked
+} RunIterator;
+
+// globals
+extern RunIndex runIndex;
+
+// functions
+int runIndexUniformTile(Map *map, int cx, int cy);
+
+int runIndexUniformWall(Map *map, int cx, int cy);
+
+const CellRun *runIndexSingleRun(Map *map, int cx, int cy);
+
+void runIterBegin(RunIterator *it, Map *map, int cx, int cy);
+
+bool runIterNext(RunIterator *it, CellRun *run, int *x, int *y);
+
+void runIndexUnload(void);
+
+#endif // RUNINDEX_H
@@ -0,0 +1,289 @@
+// stats.c
+#include "stats.h"
+#include "chunk.h"
+#include "trace.h"
+#include "walkmap.h"
+#include <raylib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+RegionStats regionStats = {0};
+
+// Helper functions
+static int *chunkSum(int key, int cx, int cy) {
+  size_t side = CHUNK_COUNT + 1;
+  return &regionStats.chunkSums[((key + 1) * side + cx) * side + cy];
+}
+
+static void chunkBounds(int cx, int cy, WorldCoords *cells) {
+  cells->startX = cx * CHUNK_SIZE;
+  cells->startY = cy * CHUNK_SIZE;
+  cells->endX = cells->startX + CHUNK_SIZE < GRID_SIZE
+                    ? cells->startX + CHUNK_SIZE - 1
+                    : GRID_SIZE - 1;
+  cells->endY = cells->startY + CHUNK_SIZE < GRID_SIZE
+                    ? cells->startY + CHUNK_SIZE - 1
+                    : GRID_SIZE - 1;
+}
+
+static bool cellCounts(const Map *map, Tile tileTypes[], int key, int x,
+                       int y) {
+  return key == STATS_WALKABLE ? cellIsWalkable(map, tileTypes, x, y)
+                               : map->grid[x][y][0] == key;
+}
+
+// Finds the keys present in one chunk and builds a table for each key that
+// covers only part of it. Entries and tables share one allocation.
+static void buildChunk(const Map *map, Tile tileTypes[], int cx, int cy) {
+  ChunkStats *chunk = &regionStats.chunks[cx][cy];
+  free(chunk->entries);
+  chunk->entries = NULL;
+  chunk->entryCount = 0;
+
+  WorldCoords cells;
+  chunkBounds(cx, cy, &cells);
+  int width = cells.endX - cells.startX + 1;
+  int height = cells.endY - cells.startY + 1;
+  int area = width * height;
+
+  StatsEntry found[CHUNK_SIZE * CHUNK_SIZE + 1];
+  int foundCount = 1;
+  found[0] = (StatsEntry){STATS_WALKABLE, 0, NULL};
+  for (int x = cells.startX; x <= cells.endX; x++) {
+    for (int y = cells.startY; y <= cells.endY; y++) {
+      if (cellIsWalkable(map, tileTypes, x, y)) {
+        found[0].count++;
+      }
+      int key = map->grid[x][y][0];
+      int i = 1;
+      while (i < foundCount && found[i].key != key) {
+        i++;
+      }
+      if (i == foundCount) {
+        found[foundCount++] = (StatsEntry){key, 0, NULL};
+      }
+      found[i].count++;
+    }
+  }
+
+  int entryCount = 0;
+  int tableCount = 0;
+  for (int i = 0; i < foundCount; i++) {
+    if (found[i].count > 0) {
+      found[entryCount++] = found[i];
+      tableCount += found[i].count < area;
+    }
+  }
+
+  size_t tableSize =
+      sizeof(unsigned short[STATS_TABLE_SIZE][STATS_TABLE_SIZE]);
+  chunk->entries = (StatsEntry *)malloc(entryCount * sizeof(StatsEntry) +
+                                        tableCount * tableSize);
+  if (chunk->entries == NULL) {
+    printf("Memory allocation failed\n");
+    return;
+  }
+  memcpy(chunk->entries, found, entryCount * sizeof(StatsEntry));
+  chunk->entryCount = entryCount;
+
+  unsigned short (*tables)[STATS_TABLE_SIZE][STATS_TABLE_SIZE] =
+      (unsigned short (*)[STATS_TABLE_SIZE][STATS_TABLE_SIZE])(
+          chunk->entries + entryCount);
+  for (int i = 0; i < entryCount; i++) {
+    StatsEntry *entry = &chunk->entries[i];
+    if (entry->count == area) {
+      continue;
+    }
+    entry->table = *tables++;
+    memset(entry->table, 0, tableSize);
+    for (int x = 0; x < width; x++) {
+      for (int y = 0; y < height; y++) {
+        entry->table[x + 1][y + 1] =
+            entry->table[x][y + 1] + entry->table[x + 1][y] -
+            entry->table[x][y] +
+            cellCounts(map, tileTypes, entry->key, cells.startX + x,
+                       cells.startY + y);
+      }
+    }
+  }
+}
+
+// Cells of key within chunk-local cells (x0, y0) to (x1, y1), inclusive
+static int chunkCount(const ChunkStats *chunk, int key, int x0, int y0,
+                      int x1, int y1) {
+  for (int i = 0; i < chunk->entryCount; i++) {
+    const StatsEntry *entry = &chunk->entries[i];
+    if (entry->key != key) {
+      continue;
+    }
+    if (entry->table == NULL) {
+      return (x1 - x0 + 1) * (y1 - y0 + 1);
+    }
+    return entry->table[x1 + 1][y1 + 1] - entry->table[x0][y1 + 1] -
+           entry->table[x1 + 1][y0] + entry->table[x0][y0];
+  }
+  return 0;
+}
+
+// Stats functions
+// Rebuilds the tables of changed chunks and, when any changed, the prefix
+// sums of the chunk totals. Call before a batch of queries.
+void statsUpdate(Map *map, Tile tileTypes[]) {
+  bool rebuild = regionStats.owner != map || regionStats.chunkSums == NULL ||
+                 regionStats.keyCount != map->maxTileKey + 2;
+  if (rebuild) {
+    statsUnload();
+    regionStats.keyCount = map->maxTileKey + 2;
+    regionStats.chunkSums = (int *)malloc((size_t)regionStats.keyCount *
+                                          (CHUNK_COUNT + 1) *
+                                          (CHUNK_COUNT + 1) * sizeof(int));
+    if (regionStats.chunkSums == NULL) {
+      printf("Memory allocation failed\n");
+      statsUnload();
+      return;
+    }
+    regionStats.owner = map;
+  }
+
+  traceBegin("statsUpdate");
+  bool changed = rebuild;
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      if (rebuild || chunkIsDirty(map, cx, cy, CHUNK_DIRTY_STATS)) {
+        buildChunk(map, tileTypes, cx, cy);
+        clearChunkDirty(map, cx, cy, CHUNK_DIRTY_STATS);
+        changed = true;
+      }
+    }
+  }
+
+  if (changed) {
+    memset(regionStats.chunkSums, 0,
+           (size_t)regionStats.keyCount * (CHUNK_COUNT + 1) *
+               (CHUNK_COUNT + 1) * sizeof(int));
+    for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+      for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+        ChunkStats *chunk = &regionStats.chunks[cx][cy];
+        for (int i = 0; i < chunk->entryCount; i++) {
+          if (chunk->entries[i].key < regionStats.keyCount - 1) {
+            *chunkSum(chunk->entries[i].key, cx + 1, cy + 1) =
+                chunk->entries[i].count;
+          }
+        }
+      }
+    }
+    for (int key = STATS_WALKABLE; key < regionStats.keyCount - 1; key++) {
+      for (int cx = 1; cx <= CHUNK_COUNT; cx++) {
+        for (int cy = 1; cy <= CHUNK_COUNT; cy++) {
+          *chunkSum(key, cx, cy) += *chunkSum(key, cx - 1, cy) +
+                                    *chunkSum(key, cx, cy - 1) -
+                                    *chunkSum(key, cx - 1, cy - 1);
+        }
+      }
+    }
+  }
+  traceEnd("statsUpdate");
+}
+
+// Cells of rect holding tile key, or walkable cells for STATS_WALKABLE.
+// Chunks inside rect are summed from the prefix sums at once; only the
+// chunks cut by its border read their tables.
+int statsCount(const Map *map, int key, WorldCoords rect) {
+  if (regionStats.owner != map || key < STATS_WALKABLE ||
+      key >= regionStats.keyCount - 1) {
+    return 0;
+  }
+  rect.startX = rect.startX > 0 ? rect.startX : 0;
+  rect.startY = rect.startY > 0 ? rect.startY : 0;
+  rect.endX = rect.endX < GRID_SIZE - 1 ? rect.endX : GRID_SIZE - 1;
+  rect.endY = rect.endY < GRID_SIZE - 1 ? rect.endY : GRID_SIZE - 1;
+  if (rect.startX > rect.endX || rect.startY > rect.endY) {
+    return 0;
+  }
+
+  // Chunks wholly inside rect, end exclusive
+  int fullStartX = (rect.startX + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  int fullStartY = (rect.startY + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  int fullEndX = rect.endX == GRID_SIZE - 1 ? CHUNK_COUNT
+                                            : (rect.endX + 1) / CHUNK_SIZE;
+  int fullEndY = rect.endY == GRID_SIZE - 1 ? CHUNK_COUNT
+                                            : (rect.endY + 1) / CHUNK_SIZE;
+
+  int count = 0;
+  if (fullStartX < fullEndX && fullStartY < fullEndY) {
+    count += *chunkSum(key, fullEndX, fullEndY) -
+             *chunkSum(key, fullStartX, fullEndY) -
+             *chunkSum(key, fullEndX, fullStartY) +
+             *chunkSum(key, fullStartX, fullStartY);
+  }
+
+  for (int cx = rect.startX / CHUNK_SIZE; cx <= rect.endX / CHUNK_SIZE;
+       cx++) {
+    bool fullColumn = cx >= fullStartX && cx < fullEndX;
+    for (int cy = rect.startY / CHUNK_SIZE; cy <= rect.endY / CHUNK_SIZE;
+         cy++) {
+      if (fullColumn && cy >= fullStartY && cy < fullEndY) {
+        cy = fullEndY - 1;
+        continue;
+      }
+      WorldCoords cells;
+      chunkBounds(cx, cy, &cells);
+      int x0 = rect.startX > cells.startX ? rect.startX : cells.startX;
+      int y0 = rect.startY > cells.startY ? rect.startY : cells.startY;
+      int x1 = rect.endX < cells.endX ? rect.endX : cells.endX;
+      int y1 = rect.endY < cells.endY ? rect.endY : cells.endY;
+      count += chunkCount(&regionStats.chunks[cx][cy], key,
+                          x0 - cells.startX, y0 - cells.startY,
+                          x1 - cells.startX, y1 - cells.startY);
+    }
+  }
+  return count;
+}
+
+// Size, walkable share and tile counts of rect, in the top-left corner of
+// the screen
+void statsDrawReadout(Map *map, Tile tileTypes[], WorldCoords rect) {
+  statsUpdate(map, tileTypes);
+  int width = rect.endX - rect.startX + 1;
+  int height = rect.endY - rect.startY + 1;
+  int walkable = statsCount(map, STATS_WALKABLE, rect);
+
+  char lines[STATS_LINE_MAX][64];
+  int lineCount = 0;
+  snprintf(lines[lineCount++], sizeof(lines[0]), "%dx%d: %d cells", width,
+           height, width * height);
+  snprintf(lines[lineCount++], sizeof(lines[0]), "walkable %d (%d%%)",
+           walkable, walkable * 100 / (width * height));
+  for (int key = 0; key <= map->maxTileKey && lineCount < STATS_LINE_MAX;
+       key++) {
+    int count = statsCount(map, key, rect);
+    if (count > 0) {
+      snprintf(lines[lineCount++], sizeof(lines[0]), "tile %d: %d", key,
+               count);
+    }
+  }
+
+  int panelWidth = 0;
+  for (int i = 0; i < lineCount; i++) {
+    int textWidth = MeasureText(lines[i], STATS_FONT_SIZE);
+    panelWidth = textWidth > panelWidth ? textWidth : panelWidth;
+  }
+  int lineHeight = STATS_FONT_SIZE + 2;
+  DrawRectangle(5, 5, panelWidth + 10, lineCount * lineHeight + 8,
+                Fade(BLACK, 0.6f));
+  for (int i = 0; i < lineCount; i++) {
+    DrawText(lines[i], 10, 9 + i * lineHeight, STATS_FONT_SIZE, RAYWHITE);
+  }
+}
+
+void statsUnload(void) {
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      free(regionStats.chunks[cx][cy].entries);
+    }
+  }
+  free(regionStats.chunkSums);
+  memset(&regionStats, 0, sizeof(RegionStats));
+}
@@ -0,0 +1,52 @@
+// stats.h
+#ifndef STATS_H
+#define STATS_H
+
+// includes
+#include "database.h"
+#include "grid.h"
+#include <stdbool.h>
+
+// definitions
+#define STATS_WALKABLE -1 // counts walkable cells instead of a tile key
+#define STATS_TABLE_SIZE (CHUNK_SIZE + 1)
+#define STATS_FONT_SIZE 10
+#define STATS_LINE_MAX 16 // readout lines, tile counts after the first two
+
+// structs
+// Cells of one chunk holding a tile key (or walkable) with a summed-area
+// table over them. Keys covering the whole chunk need no table.
+typedef struct {
+  int key; // tile key, or STATS_WALKABLE
+  int count;
+  unsigned short (*table)[STATS_TABLE_SIZE]; // NULL when count is the area
+} StatsEntry;
+
+typedef struct {
+  StatsEntry *entries; // keys present in the chunk, tables after them
+  int entryCount;
+} ChunkStats;
+
+// Per-chunk summed-area tables of each tile key and of walkable cells, and
+// prefix sums of the chunk totals across the map. Chunks marked
+// CHUNK_DIRTY_STATS are rebuilt by statsUpdate.
+typedef struct {
+  const Map *owner;
+  ChunkStats chunks[CHUNK_COUNT][CHUNK_COUNT];
+  int keyCount;   // walkable and the tile keys, in chunkSums
+  int *chunkSums; // [key + 1][CHUNK_COUNT + 1][CHUNK_COUNT + 1]
+} RegionStats;
+
+// globals
+extern RegionStats regionStats;
+
+// functions
+void statsUpdate(Map *map, Tile tileTypes[]);
+
+int statsCount(const Map *map, int key, WorldCoords rect);
+
+void statsDrawReadout(Map *map, Tile tileTypes[], WorldCoords rect);
+
+void statsUnload(void);
+
+#endif // STATS_H
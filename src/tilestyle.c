@@ -0,0 +1,82 @@
+// tilestyle.c
+#include "tilestyle.h"
+#include "draw.h"
+#include <stdio.h>
+
+// Variables
+TileStyleState tileStyles = {.seed = TILE_STYLE_SEED,
+                             .override = TILE_STYLE_NO_OVERRIDE};
+
+// Tile style functions
+// Mixes the cell, key and seed with the murmur3 finaliser, so neighbouring
+// cells get unrelated variants
+uint32_t tileStyleHash(int x, int y, int tileKey, uint32_t seed) {
+  uint32_t h = seed;
+  h ^= (uint32_t)x * 0x8da6b343u;
+  h ^= (uint32_t)y * 0xd8163841u;
+  h ^= (uint32_t)tileKey * 0xcb1ab31fu;
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}
+
+// Style to store for a newly placed tile
+int pickTileStyle(int tileKey, Tile *tileTypes) {
+  if (tileStyles.override != TILE_STYLE_NO_OVERRIDE &&
+      tileStyles.override < tileTypes[tileKey].texCount) {
+    return tileStyles.override;
+  }
+  if (tileStyles.hashed) {
+    return TILE_STYLE_HASHED;
+  }
+  return getRandTileStyle(tileKey, tileTypes);
+}
+
+// True when every new tile stores TILE_STYLE_HASHED, so edits need not
+// record new styles
+bool tileStylesImplied(void) {
+  return tileStyles.hashed && tileStyles.override == TILE_STYLE_NO_OVERRIDE;
+}
+
+// Variant to draw for a stored style at (x, y)
+int resolveTileStyle(Tile *tileTypes, int tileKey, int tileStyle, int x,
+                     int y) {
+  if (tileStyle != TILE_STYLE_HASHED) {
+    return tileStyle;
+  }
+  int texCount = tileTypes[tileKey].texCount;
+  if (texCount <= 1) {
+    return 0;
+  }
+  return (int)(tileStyleHash(x, y, tileKey, tileStyles.seed) %
+               (uint32_t)texCount);
+}
+
+// Reads the seed from the map's settings table, or the default seed for maps
+// saved without one. Hashed cells store no variant, so their look depends on
+// the seed they were drawn with.
+void tileStyleLoad(sqlite3 *db, const char *table) {
+  char name[256];
+  snprintf(name, sizeof(name), "%s_meta", table);
+  tileStyles.seed =
+      (uint32_t)loadMapSetting(db, name, "style_seed", TILE_STYLE_SEED);
+}
+
+void tileStyleSave(sqlite3 *db, const char *table) {
+  char name[256];
+  snprintf(name, sizeof(name), "%s_meta", table);
+  saveMapSetting(db, name, "style_seed", tileStyles.seed);
+}
+
+// Styles of span undo batches are kept one byte per cell
+unsigned char packTileStyle(int tileStyle) {
+  return tileStyle == TILE_STYLE_HASHED ? TILE_STYLE_HASHED_BYTE
+                                        : (unsigned char)tileStyle;
+}
+
+int unpackTileStyle(unsigned char packed) {
+  return packed == TILE_STYLE_HASHED_BYTE ? TILE_STYLE_HASHED : packed;
+}
@@ -0,0 +1,47 @@
+// tilestyle.h
+#ifndef TILESTYLE_H
+#define TILESTYLE_H
+
+// includes
+#include "database.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// definitions
+#define TILE_STYLE_HASHED -1        // variant derived from the cell's position
+#define TILE_STYLE_HASHED_BYTE 0xff // TILE_STYLE_HASHED in undo style arrays
+#define TILE_STYLE_SEED 0x2545f491u // default map seed
+#define TILE_STYLE_NO_OVERRIDE -1
+
+// structs
+// How newly placed tiles pick their variant. In hashed mode the stored style
+// is TILE_STYLE_HASHED and the variant comes from a hash of the cell, the
+// tile key and the seed; an override stores a hand-picked variant instead.
+typedef struct {
+  bool hashed;
+  uint32_t seed;
+  int override; // variant stored for new tiles, or TILE_STYLE_NO_OVERRIDE
+} TileStyleState;
+
+// globals
+extern TileStyleState tileStyles;
+
+// functions
+uint32_t tileStyleHash(int x, int y, int tileKey, uint32_t seed);
+
+int pickTileStyle(int tileKey, Tile *tileTypes);
+
+bool tileStylesImplied(void);
+
+int resolveTileStyle(Tile *tileTypes, int tileKey, int tileStyle, int x,
+                     int y);
+
+void tileStyleLoad(sqlite3 *db, const char *table);
+
+void tileStyleSave(sqlite3 *db, const char *table);
+
+unsigned char packTileStyle(int tileStyle);
+
+int unpackTileStyle(unsigned char packed);
+
+#endif // TILESTYLE_H
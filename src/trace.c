@@ -0,0 +1,89 @@
+// trace.c
+#include "trace.h"
+#include "profile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Variables
+Tracer tracer = {0};
+
+// Helper functions
+static void traceRecord(const char *name, char phase) {
+  if (!tracer.enabled) {
+    return;
+  }
+  if (tracer.count >= tracer.capacity) {
+    tracer.dropped++;
+    return;
+  }
+
+  TraceEvent *event = &tracer.events[tracer.count];
+  event->name = name;
+  event->timestamp = (profileNow() - tracer.origin) * 1000.0;
+  event->phase = phase;
+  tracer.count++;
+}
+
+// Trace functions
+bool traceInit(const char *path, int capacity) {
+  tracer.events = (TraceEvent *)malloc(capacity * sizeof(TraceEvent));
+  if (tracer.events == NULL) {
+    printf("Memory allocation failed\n");
+    return false;
+  }
+
+  tracer.capacity = capacity;
+  tracer.count = 0;
+  tracer.dropped = 0;
+  tracer.origin = profileNow();
+  tracer.enabled = true;
+  snprintf(tracer.path, sizeof(tracer.path), "%s", path);
+  printf("Tracing enabled, %d events preallocated\n", capacity);
+  return true;
+}
+
+void traceBegin(const char *name) { traceRecord(name, 'B'); }
+
+void traceEnd(const char *name) { traceRecord(name, 'E'); }
+
+int traceWriteJson(const char *path) {
+  if (tracer.events == NULL) {
+    printf("Tracing is not enabled\n");
+    return -1;
+  }
+
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    printf("Error opening trace output %s\n", path);
+    return -1;
+  }
+
+  // Chrome trace-event format, loadable in chrome://tracing or Perfetto
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  for (int i = 0; i < tracer.count; i++) {
+    TraceEvent *event = &tracer.events[i];
+    fprintf(file,
+            "{\"name\":\"%s\",\"cat\":\"editor\",\"ph\":\"%c\",\"ts\":%.3f,"
+            "\"pid\":1,\"tid\":1}%s\n",
+            event->name, event->phase, event->timestamp,
+            i + 1 < tracer.count ? "," : "");
+  }
+  fprintf(file, "]}\n");
+  fclose(file);
+
+  if (tracer.dropped > 0) {
+    printf("Warning: trace buffer full, %d events dropped\n", tracer.dropped);
+  }
+  printf("Trace of %d events written to %s\n", tracer.count, path);
+  return tracer.count;
+}
+
+void traceShutdown(void) {
+  if (tracer.events == NULL) {
+    return;
+  }
+  traceWriteJson(tracer.path);
+  free(tracer.events);
+  memset(&tracer, 0, sizeof(tracer));
+}
@@ -0,0 +1,43 @@
+// trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+// includes
+#include <stdbool.h>
+
+// definitions
+#define TRACE_CAPACITY 262144 // events preallocated when tracing is enabled
+#define TRACE_DEFAULT_PATH "trace.json"
+
+// structs
+typedef struct {
+  const char *name; // static string, never copied
+  double timestamp; // microseconds since tracing started
+  char phase;       // 'B' (begin) or 'E' (end)
+} TraceEvent;
+
+typedef struct {
+  TraceEvent *events; // preallocated event buffer
+  int capacity;
+  int count;
+  int dropped; // events lost after the buffer filled up
+  double origin;
+  bool enabled;
+  char path[256]; // output written on exit
+} Tracer;
+
+// globals
+extern Tracer tracer;
+
+// functions
+bool traceInit(const char *path, int capacity);
+
+void traceBegin(const char *name);
+
+void traceEnd(const char *name);
+
+int traceWriteJson(const char *path);
+
+void traceShutdown(void);
+
+#endif // TRACE_H
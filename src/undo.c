@@ -1,21 +1,136 @@
 #include "undo.h"
+#include "chunk.h"
 #include "database.h"
 #include "draw.h"
 #include "edge.h"
+#include "keyindex.h"
+#include "layer.h"
+#include "tilestyle.h"
+#include "trace.h"
 #include "wall.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Helper functions
+// Appends a batch after the current one, dropping any redo branch
+static void pushBatch(UndoRedoManager *manager, TileChangeBatch *batch) {
+  // If we're in the middle of the stack, truncate the "dead branches"
+  if (manager->current && manager->current->next) {
+    printf("Truncating redo stack.\n");
+    TileChangeBatch *toDelete = manager->current->next;
+    while (toDelete) {
+      printf("Deleting TileChangeBatch at %p\n", (void *)toDelete);
+      TileChangeBatch *next = toDelete->next;
+      freeTileChangeBatch(toDelete);
+      toDelete = next;
+    }
+    manager->current->next = NULL;
+  }
+
+  // Add the new batch to the list
+  if (manager->current) {
+    printf("Appending batch to the existing list.\n");
+    manager->current->next = batch;
+    batch->prev = manager->current;
+  } else {
+    printf("Starting a new list with this batch.\n");
+    manager->head = batch;
+  }
+  manager->current = batch;
+
+  printf("Batch added. Current batch is at %p\n", (void *)manager->current);
+}
+
+// Writes the old (undoing) or new keys and styles of a batch's spans. A
+// missing style array means every style is hashed.
+static void applySpans(TileChangeBatch *batch, Map *map, bool undoing) {
+  int cell = 0;
+  for (int i = 0; i < batch->spanCount; i++) {
+    TileChangeSpan *span = &batch->spans[i];
+    int key = undoing ? span->oldKey : span->newKey;
+    unsigned char *styles = undoing ? batch->oldStyles : batch->newStyles;
+    for (int y = span->y; y < span->y + span->length; y++, cell++) {
+      markCellDirty(map, span->x, y);
+      keyIndexUpdate(map, batch->spanType, span->x, y,
+                     undoing ? span->newKey : span->oldKey, key);
+      switch (batch->spanType) {
+      case DRAW_TILE:
+        map->grid[span->x][y][0] = key;
+        map->grid[span->x][y][1] =
+            styles ? unpackTileStyle(styles[cell]) : TILE_STYLE_HASHED;
+        break;
+      case DRAW_WALL:
+        map->grid[span->x][y][2] = key;
+        break;
+      }
+    }
+  }
+}
+
+// Copies the old (undoing) or new cells of a rectangle batch back, one
+// column at a time
+static void applyRect(TileChangeBatch *batch, Map *map, bool undoing) {
+  if (batch->oldCells == NULL) {
+    return;
+  }
+  WorldCoords rect = batch->cellRect;
+  int height = rect.endY - rect.startY + 1;
+  int (*from)[3] = undoing ? batch->newCells : batch->oldCells;
+  int (*to)[3] = undoing ? batch->oldCells : batch->newCells;
+
+  for (int x = rect.startX; x <= rect.endX; x++) {
+    int column = (x - rect.startX) * height;
+    for (int i = 0; i < height; i++) {
+      int y = rect.startY + i;
+      markCellDirty(map, x, y);
+      keyIndexUpdate(map, DRAW_TILE, x, y, from[column + i][0],
+                     to[column + i][0]);
+      keyIndexUpdate(map, DRAW_WALL, x, y, from[column + i][2],
+                     to[column + i][2]);
+    }
+    memcpy(map->grid[x][rect.startY], to[column], height * sizeof(int[3]));
+  }
+}
+
+// Recomputes the batch's neighbourhood once all of its cells are written
+static void recomputeBatch(TileChangeBatch *batch, Map *map, Tile *tileTypes,
+                           Edge *edgeTypes, Wall *wallTypes) {
+  // Named layers have no edges or wall quadrants
+  if (batch->changeCount > 0 && batch->changes[0].layer != 0) {
+    return;
+  }
+  if (batch->oldCells != NULL) {
+    computeEdges(batch->visitedTiles, batch->visitedCount, map, tileTypes,
+                 edgeTypes);
+    computeWalls(batch->visitedTiles, batch->visitedCount, map, wallTypes);
+    return;
+  }
+
+  DrawType drawType =
+      batch->changeCount > 0 ? batch->changes[0].drawType : batch->spanType;
+  switch (drawType) {
+  case DRAW_TILE:
+    computeEdges(batch->visitedTiles, batch->visitedCount, map, tileTypes,
+                 edgeTypes);
+    break;
+  case DRAW_WALL:
+    computeWalls(batch->visitedTiles, batch->visitedCount, map, wallTypes);
+    break;
+  }
+}
+
 // Undo/Redo functions
 void createTileChangeBatch(UndoRedoManager *manager, Map *map,
                            DrawingState *drawState, int visitedTiles[][2],
                            int visitedCount) {
+  traceBegin("createTileChangeBatch");
   printf("Creating tile change batch with %d tiles.\n",
          drawState->drawnTilesCount);
 
   TileChange *changes =
       (TileChange *)malloc(drawState->drawnTilesCount * sizeof(TileChange));
+  int layer = layerEditTarget(drawState);
 
   for (int i = 0; i < drawState->drawnTilesCount; i++) {
     int x = drawState->drawnTiles[i][0];
@@ -23,6 +138,16 @@ void createTileChangeBatch(UndoRedoManager *manager, Map *map,
     changes[i].x = x;
     changes[i].y = y;
     changes[i].drawType = drawState->drawType;
+    changes[i].layer = layer;
+
+    if (layer != 0) {
+      const int *cell = layerGetCell(map, layer, x, y);
+      changes[i].oldKey = cell ? cell[0] : 0;
+      changes[i].oldStyle = cell ? cell[1] : 0;
+      changes[i].newKey = drawState->activeTileKey;
+      changes[i].newStyle = drawState->drawnTiles[i][2];
+      continue;
+    }
 
     switch (drawState->drawType) {
     case DRAW_TILE:
@@ -33,7 +158,7 @@ void createTileChangeBatch(UndoRedoManager *manager, Map *map,
       break;
     case DRAW_WALL:
       changes[i].oldKey = map->grid[x][y][2];
-      changes[i].newKey = drawState->activeWallKey;
+      changes[i].newKey = drawState->drawnTiles[i][2];
       break;
     }
     printf("Creating change %d: [%d, %d] Key=%d -> Key=%d with Type=%d\n", i,
@@ -45,6 +170,13 @@ void createTileChangeBatch(UndoRedoManager *manager, Map *map,
 
   batch->changes = changes; // Point to the changes array
   batch->changeCount = drawState->drawnTilesCount;
+  batch->spans = NULL;
+  batch->spanCount = 0;
+  batch->spanType = drawState->drawType;
+  batch->oldStyles = NULL;
+  batch->newStyles = NULL;
+  batch->oldCells = NULL;
+  batch->newCells = NULL;
   batch->visitedTiles = (int (*)[2])malloc(visitedCount * sizeof(int[2]));
   memcpy(batch->visitedTiles, visitedTiles, visitedCount * sizeof(int[2]));
   batch->visitedCount = visitedCount;
@@ -56,37 +188,97 @@ void createTileChangeBatch(UndoRedoManager *manager, Map *map,
   printf("TileChangeBatch created. changeCount=%d\n",
          drawState->drawnTilesCount);
 
-  // If we're in the middle of the stack, truncate the "dead branches"
-  if (manager->current && manager->current->next) {
-    printf("Truncating redo stack.\n");
-    TileChangeBatch *toDelete = manager->current->next;
-    while (toDelete) {
-      printf("Deleting TileChangeBatch at %p\n", (void *)toDelete);
-      TileChangeBatch *next = toDelete->next;
-      free(toDelete->changes);
-      free(toDelete);
-      toDelete = next;
-    }
-    manager->current->next = NULL;
-  }
+  pushBatch(manager, batch);
+  traceEnd("createTileChangeBatch");
+}
 
-  // Add the new batch to the list
-  if (manager->current) {
-    printf("Appending batch to the existing list.\n");
-    manager->current->next = batch;
-    batch->prev = manager->current;
-  } else {
-    printf("Starting a new list with this batch.\n");
-    manager->head = batch;
-  }
-  manager->current = batch;
+// Records a large edit as column runs. The batch takes ownership of the
+// span and style arrays.
+void createSpanChangeBatch(UndoRedoManager *manager, DrawType spanType,
+                           TileChangeSpan *spans, int spanCount,
+                           unsigned char *oldStyles, unsigned char *newStyles,
+                           int visitedTiles[][2], int visitedCount) {
+  traceBegin("createSpanChangeBatch");
+  printf("Creating span change batch with %d spans.\n", spanCount);
 
-  printf("Batch added. Current batch is at %p\n", (void *)manager->current);
+  TileChangeBatch *batch = (TileChangeBatch *)malloc(sizeof(TileChangeBatch));
+  batch->changes = NULL;
+  batch->changeCount = 0;
+  batch->spans = spans;
+  batch->spanCount = spanCount;
+  batch->spanType = spanType;
+  batch->oldStyles = oldStyles;
+  batch->newStyles = newStyles;
+  batch->oldCells = NULL;
+  batch->newCells = NULL;
+  batch->visitedTiles = (int (*)[2])malloc(visitedCount * sizeof(int[2]));
+  memcpy(batch->visitedTiles, visitedTiles, visitedCount * sizeof(int[2]));
+  batch->visitedCount = visitedCount;
+  batch->next = NULL;
+  batch->prev = NULL;
+
+  pushBatch(manager, batch);
+  traceEnd("createSpanChangeBatch");
+}
+
+// Records a rectangle edit as the cells before and after it, column by
+// column as in Map.grid. The batch takes ownership of both cell arrays.
+void createRectChangeBatch(UndoRedoManager *manager, WorldCoords cellRect,
+                           int (*oldCells)[3], int (*newCells)[3],
+                           int visitedTiles[][2], int visitedCount) {
+  traceBegin("createRectChangeBatch");
+  printf("Creating rect change batch of %dx%d cells.\n",
+         cellRect.endX - cellRect.startX + 1,
+         cellRect.endY - cellRect.startY + 1);
+
+  TileChangeBatch *batch = (TileChangeBatch *)malloc(sizeof(TileChangeBatch));
+  batch->changes = NULL;
+  batch->changeCount = 0;
+  batch->spans = NULL;
+  batch->spanCount = 0;
+  batch->spanType = DRAW_TILE;
+  batch->oldStyles = NULL;
+  batch->newStyles = NULL;
+  batch->cellRect = cellRect;
+  batch->oldCells = oldCells;
+  batch->newCells = newCells;
+  batch->visitedTiles = (int (*)[2])malloc(visitedCount * sizeof(int[2]));
+  memcpy(batch->visitedTiles, visitedTiles, visitedCount * sizeof(int[2]));
+  batch->visitedCount = visitedCount;
+  batch->next = NULL;
+  batch->prev = NULL;
+
+  pushBatch(manager, batch);
+  traceEnd("createRectChangeBatch");
+}
+
+void freeTileChangeBatch(TileChangeBatch *batch) {
+  free(batch->changes);
+  free(batch->oldCells);
+  free(batch->newCells);
+  free(batch->spans);
+  free(batch->oldStyles);
+  free(batch->newStyles);
+  free(batch->visitedTiles);
+  free(batch);
+}
+
+// Frees every batch of the manager, leaving it empty
+void freeUndoHistory(UndoRedoManager *manager) {
+  TileChangeBatch *batch = manager->head;
+  while (batch) {
+    TileChangeBatch *nextBatch = batch->next;
+    freeTileChangeBatch(batch);
+    batch = nextBatch;
+  }
+  manager->head = NULL;
+  manager->current = NULL;
 }
 
 void undo(UndoRedoManager *manager, Map *map, Tile *tileTypes, Edge *edgeTypes,
           Wall *wallTypes) {
   if (manager->current) {
+    traceBegin("undo");
     TileChangeBatch *batch = manager->current;
     printf("Undoing batch at %p with %d changes.\n", (void *)batch,
            batch->changeCount);
@@ -98,19 +290,27 @@ void undo(UndoRedoManager *manager, Map *map, Tile *tileTypes, Edge *edgeTypes,
       printf("Undoing change %d: [%d, %d] Key=%d -> Key=%d with Type=%d\n", i,
              change->x, change->y, change->newKey, change->oldKey,
              (int)change->drawType);
+      if (change->layer != 0) {
+        layerSetCell(map, change->layer, change->x, change->y, change->oldKey,
+                     change->oldStyle);
+        continue;
+      }
+      markCellDirty(map, change->x, change->y);
+      keyIndexUpdate(map, change->drawType, change->x, change->y,
+                     change->newKey, change->oldKey);
       switch (change->drawType) {
       case DRAW_TILE:
         map->grid[change->x][change->y][0] = change->oldKey;
         map->grid[change->x][change->y][1] = change->oldStyle;
-        computeEdges(batch->visitedTiles, batch->visitedCount, map, tileTypes,
-                     edgeTypes);
         break;
       case DRAW_WALL:
         map->grid[change->x][change->y][2] = change->oldKey;
-        computeWalls(batch->visitedTiles, batch->visitedCount, map, wallTypes);
         break;
       }
     }
+    applySpans(batch, map, true);
+    applyRect(batch, map, true);
+    recomputeBatch(batch, map, tileTypes, edgeTypes, wallTypes);
 
     manager->current = manager->current->prev;
     if (manager->current) {
@@ -118,6 +318,7 @@ void undo(UndoRedoManager *manager, Map *map, Tile *tileTypes, Edge *edgeTypes,
     } else {
       printf("No previous batch. Reached the beginning of the stack.\n");
     }
+    traceEnd("undo");
   } else {
     printf("Nothing to undo. Current is NULL.\n");
   }
@@ -144,6 +345,8 @@ void redo(UndoRedoManager *manager, Map *map, Tile *tileTypes, Edge *edgeTypes,
     return;
   }
 
+  traceBegin("redo");
+
   printf("Redoing batch at %p with %d changes.\n", (void *)batch,
          batch->changeCount);
 
@@ -154,24 +357,32 @@ void redo(UndoRedoManager *manager, Map *map, Tile *tileTypes, Edge *edgeTypes,
            (int)change->drawType);
 
     // Apply new tile information
-
+    if (change->layer != 0) {
+      layerSetCell(map, change->layer, change->x, change->y, change->newKey,
+                   change->newStyle);
+      continue;
+    }
+    markCellDirty(map, change->x, change->y);
+    keyIndexUpdate(map, change->drawType, change->x, change->y, change->oldKey,
+                   change->newKey);
     switch (change->drawType) {
     case DRAW_TILE:
       map->grid[change->x][change->y][0] = change->newKey;
       map->grid[change->x][change->y][1] = change->newStyle;
-      computeEdges(batch->visitedTiles, batch->visitedCount, map, tileTypes,
-                   edgeTypes);
       break;
     case DRAW_WALL:
       map->grid[change->x][change->y][2] = change->newKey;
-      computeWalls(batch->visitedTiles, batch->visitedCount, map, wallTypes);
       break;
     }
   }
+  applySpans(batch, map, false);
+  applyRect(batch, map, false);
+  recomputeBatch(batch, map, tileTypes, edgeTypes, wallTypes);
 
   if (manager->current->next) {
     printf("Moved to next batch at %p.\n", (void *)manager->current);
   } else {
     printf("No next batch. Reached the end of the stack.\n");
   }
+  traceEnd("redo");
 }
@@ -13,11 +13,27 @@ typedef struct TileChange {
   int oldKey, oldStyle; // Old tile data
   int newKey, newStyle; // New tile data
   DrawType drawType;
+  int layer; // 0 for the map's grid, otherwise a named layer's tiles
 } TileChange;
 
+// Column run of cells changed from one key to another
+typedef struct {
+  int x, y;   // first cell of the run
+  int length; // cells from y downwards
+  int oldKey, newKey;
+} TileChangeSpan;
+
 typedef struct TileChangeBatch {
   TileChange *changes;          // Array of changes
   int changeCount;              // Number of changes in the batch
+  TileChangeSpan *spans;        // Compressed changes of large edits
+  int spanCount;
+  DrawType spanType;
+  unsigned char *oldStyles; // per span cell, tiles only
+  unsigned char *newStyles;
+  WorldCoords cellRect;  // Rectangle edits, whole cells column by column
+  int (*oldCells)[3];
+  int (*newCells)[3];
   struct TileChangeBatch *next; // Pointer to the next batch
   struct TileChangeBatch *prev; // Pointer to the previous batch
   int (*visitedTiles)[2];
@@ -34,6 +50,19 @@ void createTileChangeBatch(UndoRedoManager *manager, Map *map,
                            DrawingState *drawState, int visitedTiles[][2],
                            int visitedCount);
 
+void createSpanChangeBatch(UndoRedoManager *manager, DrawType spanType,
+                           TileChangeSpan *spans, int spanCount,
+                           unsigned char *oldStyles, unsigned char *newStyles,
+                           int visitedTiles[][2], int visitedCount);
+
+void createRectChangeBatch(UndoRedoManager *manager, WorldCoords cellRect,
+                           int (*oldCells)[3], int (*newCells)[3],
+                           int visitedTiles[][2], int visitedCount);
+
+void freeTileChangeBatch(TileChangeBatch *batch);
+
+void freeUndoHistory(UndoRedoManager *manager);
+
 void undo(UndoRedoManager *manager, Map *map, Tile *tileTypes, Edge *edgeTypes,
           Wall *wallTypes);
 
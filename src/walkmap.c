@@ -0,0 +1,74 @@
+// walkmap.c
+#include "walkmap.h"
+#include "chunk.h"
+#include "trace.h"
+#include <string.h>
+
+// Variables
+WalkMap walkMap = {0};
+
+// Helper functions
+static void setBit(uint64_t *line, int bit, bool value) {
+  uint64_t mask = 1ULL << (bit % 64);
+  if (value) {
+    line[bit / 64] |= mask;
+  } else {
+    line[bit / 64] &= ~mask;
+  }
+}
+
+static void updateChunk(const Map *map, Tile tileTypes[], int cx, int cy) {
+  int startX = cx * CHUNK_SIZE;
+  int startY = cy * CHUNK_SIZE;
+  int endX = startX + CHUNK_SIZE < GRID_SIZE ? startX + CHUNK_SIZE : GRID_SIZE;
+  int endY = startY + CHUNK_SIZE < GRID_SIZE ? startY + CHUNK_SIZE : GRID_SIZE;
+  for (int x = startX; x < endX; x++) {
+    for (int y = startY; y < endY; y++) {
+      bool walkable = cellIsWalkable(map, tileTypes, x, y);
+      setBit(walkMap.rows[y], x, walkable);
+      setBit(walkMap.cols[x], y, walkable);
+    }
+  }
+}
+
+// Walk map functions
+// Cells a unit can stand on: a walkable tile and no wall
+bool cellIsWalkable(const Map *map, Tile tileTypes[], int x, int y) {
+  return tileTypes[map->grid[x][y][0]].walkable && map->grid[x][y][2] == 0;
+}
+
+// Refreshes the bits of changed chunks, building the whole bitmap when the
+// map is new to it. Returns true when any chunk was refreshed.
+bool walkMapUpdate(Map *map, Tile tileTypes[]) {
+  bool rebuild = walkMap.owner != map;
+  if (rebuild) {
+    memset(walkMap.rows, 0, sizeof(walkMap.rows));
+    memset(walkMap.cols, 0, sizeof(walkMap.cols));
+    walkMap.owner = map;
+  }
+
+  traceBegin("walkMapUpdate");
+  bool changed = rebuild;
+  for (int cx = 0; cx < CHUNK_COUNT; cx++) {
+    for (int cy = 0; cy < CHUNK_COUNT; cy++) {
+      if (rebuild || chunkIsDirty(map, cx, cy, CHUNK_DIRTY_WALK)) {
+        updateChunk(map, tileTypes, cx, cy);
+        clearChunkDirty(map, cx, cy, CHUNK_DIRTY_WALK);
+        changed = true;
+      }
+    }
+  }
+  if (changed) {
+    walkMap.version++;
+  }
+  traceEnd("walkMapUpdate");
+  return changed;
+}
+
+// Walkability of cell (x, y) as of the last walkMapUpdate; false off the map
+bool walkMapGet(int x, int y) {
+  if (x < 0 || x >= GRID_SIZE || y < 0 || y >= GRID_SIZE) {
+    return false;
+  }
+  return (walkMap.rows[y][x / 64] >> (x % 64)) & 1;
+}
@@ -0,0 +1,35 @@
+// walkmap.h
+#ifndef WALKMAP_H
+#define WALKMAP_H
+
+// includes
+#include "database.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// definitions
+#define WALK_WORDS ((GRID_SIZE + 63) / 64) // 64-bit words per bitmap line
+
+// structs
+// Walkable cells packed one bit per cell, stored both by row and by column
+// so runs along either axis can be scanned a word at a time. Bits past
+// GRID_SIZE stay clear. Chunks marked CHUNK_DIRTY_WALK are refreshed by
+// walkMapUpdate.
+typedef struct {
+  const Map *owner;
+  unsigned int version; // bumped whenever a bit may have changed
+  uint64_t rows[GRID_SIZE][WALK_WORDS]; // bit x of row y
+  uint64_t cols[GRID_SIZE][WALK_WORDS]; // bit y of column x
+} WalkMap;
+
+// globals
+extern WalkMap walkMap;
+
+// functions
+bool cellIsWalkable(const Map *map, Tile tileTypes[], int x, int y);
+
+bool walkMapUpdate(Map *map, Tile tileTypes[]);
+
+bool walkMapGet(int x, int y);
+
+#endif // WALKMAP_H
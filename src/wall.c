@@ -1,7 +1,10 @@
 #include "wall.h"
+#include "chunk.h"
 #include "database.h"
 #include "draw.h"
 #include "edge.h"
+#include "profile.h"
+#include "trace.h"
 #include <limits.h>
 #include <raylib.h>
 #include <sqlite3.h>
@@ -9,6 +12,7 @@
 
 void calculateWallGrid(DrawingState *drawState, int visitedTiles[][2],
                        int *visitedCount) {
+  setVisitedBits(visitedTiles, *visitedCount, true);
 
   for (int i = 0; i < drawState->drawnTilesCount; i++) {
     int x = drawState->drawnTiles[i][0];
@@ -17,26 +21,14 @@ void calculateWallGrid(DrawingState *drawState, int visitedTiles[][2],
     int directions[3][2] = {{x, y - 1}, {x - 1, y}, {x - 1, y - 1}};
 
     // populate visited tiles first with placedTiles
-    if (!visitedCheck(visitedTiles, *visitedCount, x, y)) {
-
-      visitedTiles[*visitedCount][0] = x;
-      visitedTiles[*visitedCount][1] = y;
-      (*visitedCount)++;
-    }
+    visitCell(visitedTiles, visitedCount, x, y);
 
     for (int j = 0; j < 3; j++) {
-      int nx = directions[j][0];
-      int ny = directions[j][1];
-
-      bool visited = visitedCheck(visitedTiles, *visitedCount, nx, ny);
-
-      if (!visited && nx >= 0 && ny >= 0 && ny < GRID_SIZE && nx < GRID_SIZE) {
-        visitedTiles[*visitedCount][0] = nx;
-        visitedTiles[*visitedCount][1] = ny;
-        (*visitedCount)++;
-      }
+      visitCell(visitedTiles, visitedCount, directions[j][0], directions[j][1]);
     }
   }
+
+  setVisitedBits(visitedTiles, *visitedCount, false);
 }
 
 void getWallTextures(Map *map, int x, int y, Wall wallTypes[],
@@ -64,6 +56,198 @@ void getWallTextures(Map *map, int x, int y, Wall wallTypes[],
   }
 }
 
+// Position of a cell within the drawn bounds, one bit per side it lies on
+#define POSITION_MIN_X 1
+#define POSITION_MAX_X 2
+#define POSITION_MIN_Y 4
+#define POSITION_MAX_Y 8
+#define POSITION_COUNT 16
+
+// Position of a cell along a diagonal path
+#define DIAGONAL_START 1
+#define DIAGONAL_END 2
+#define DIAGONAL_ON 4
+#define DIAGONAL_COUNT 8
+
+// Orientation per position class, built once from the rules below
+static unsigned char boxOrientations[POSITION_COUNT];
+static unsigned char pathOrientations[3][8][POSITION_COUNT];
+static unsigned char diagonalOrientations[8][2][DIAGONAL_COUNT];
+static const unsigned char painterOrientations[POSITION_COUNT] = {0};
+static bool orientationTablesBuilt = false;
+
+// Step from the path's origin corner for each PathQuadrant
+static const signed char diagonalSteps[8][2] = {
+    {+1, -1}, // NORTHEAST
+    {+1, +1}, // SOUTHEAST
+    {-1, +1}, // SOUTHWEST
+    {-1, -1}, // NORTHWEST
+    {+1, +1}, // NORTH
+    {+1, +1}, // SOUTH
+    {+1, +1}, // EAST
+    {+1, +1}  // WEST
+};
+
+static int classifyBox(int position) {
+  bool minX = position & POSITION_MIN_X;
+  bool maxX = position & POSITION_MAX_X;
+  bool minY = position & POSITION_MIN_Y;
+  bool maxY = position & POSITION_MAX_Y;
+
+  if (maxX && maxY)
+    return WALL_STYLE_CORNER;
+  if (minX && minY)
+    return WALL_STYLE_POST;
+  if (minX && maxY)
+    return WALL_STYLE_VERTICAL;
+  if (maxX && minY)
+    return WALL_STYLE_HORIZONTAL;
+  if (minY || maxY)
+    return WALL_STYLE_HORIZONTAL;
+  if (minX || maxX)
+    return WALL_STYLE_VERTICAL;
+  return WALL_STYLE_NONE;
+}
+
+static int classifyPath(int position, PathMode pathMode,
+                        PathQuadrant pathQuadrant) {
+  bool minX = position & POSITION_MIN_X;
+  bool maxX = position & POSITION_MAX_X;
+  bool minY = position & POSITION_MIN_Y;
+  bool maxY = position & POSITION_MAX_Y;
+
+  if (maxX && maxY) {
+    if (pathQuadrant == QUADRANT_SOUTHEAST && pathMode == PATH_STEEP)
+      return WALL_STYLE_HORIZONTAL;
+    if (pathQuadrant == QUADRANT_SOUTHEAST && pathMode == PATH_SHALLOW)
+      return WALL_STYLE_VERTICAL;
+    if (pathQuadrant == QUADRANT_NORTHWEST && pathMode == PATH_SHALLOW)
+      return WALL_STYLE_HORIZONTAL;
+    if (pathQuadrant == QUADRANT_NORTHWEST && pathMode == PATH_STEEP)
+      return WALL_STYLE_VERTICAL;
+    if (pathQuadrant == QUADRANT_NORTH || pathQuadrant == QUADRANT_SOUTH)
+      return WALL_STYLE_VERTICAL;
+    if (pathQuadrant == QUADRANT_WEST || pathQuadrant == QUADRANT_EAST)
+      return WALL_STYLE_HORIZONTAL;
+    return WALL_STYLE_CORNER;
+  }
+  if (minX && minY) {
+    if (pathQuadrant == QUADRANT_NORTHWEST && pathMode == PATH_STEEP)
+      return WALL_STYLE_HORIZONTAL;
+    if (pathQuadrant == QUADRANT_NORTHWEST && pathMode == PATH_SHALLOW)
+      return WALL_STYLE_VERTICAL;
+    return WALL_STYLE_POST;
+  }
+  if (minX && maxY) {
+    if (pathQuadrant == QUADRANT_SOUTHWEST && pathMode == PATH_STEEP)
+      return WALL_STYLE_HORIZONTAL;
+    if (pathQuadrant == QUADRANT_SOUTHWEST && pathMode == PATH_SHALLOW)
+      return WALL_STYLE_VERTICAL;
+    if (pathQuadrant == QUADRANT_NORTHEAST && pathMode == PATH_SHALLOW)
+      return WALL_STYLE_POST;
+    return WALL_STYLE_VERTICAL;
+  }
+  if (maxX && minY) {
+    if (pathQuadrant == QUADRANT_NORTHEAST && pathMode == PATH_STEEP)
+      return WALL_STYLE_HORIZONTAL;
+    if (pathQuadrant == QUADRANT_NORTHEAST && pathMode == PATH_SHALLOW)
+      return WALL_STYLE_VERTICAL;
+    if (pathQuadrant == QUADRANT_SOUTHWEST && pathMode == PATH_STEEP)
+      return WALL_STYLE_POST;
+    return WALL_STYLE_HORIZONTAL;
+  }
+  if (minY || maxY)
+    return WALL_STYLE_HORIZONTAL;
+  if (minX || maxX)
+    return WALL_STYLE_VERTICAL;
+  return WALL_STYLE_NONE;
+}
+
+static int classifyDiagonal(int diagonal, PathQuadrant pathQuadrant,
+                            DiagonalPriority priority) {
+  // Start takes precedence over end when the path is a single cell
+  int part = (diagonal & DIAGONAL_START) ? 0
+             : (diagonal & DIAGONAL_END) ? 1
+             : (diagonal & DIAGONAL_ON)  ? 2
+                                         : 3;
+  bool x = priority == PRIORITY_X;
+  bool y = priority == PRIORITY_Y;
+
+  switch (pathQuadrant) {
+  case QUADRANT_SOUTHEAST: {
+    const int styles[4] = {
+        WALL_STYLE_POST,
+        x ? WALL_STYLE_VERTICAL : WALL_STYLE_HORIZONTAL,
+        x ? WALL_STYLE_VERTICAL : WALL_STYLE_HORIZONTAL,
+        x ? WALL_STYLE_HORIZONTAL : WALL_STYLE_VERTICAL,
+    };
+    return styles[part];
+  }
+  case QUADRANT_NORTHEAST: {
+    const int styles[4] = {
+        x ? WALL_STYLE_POST : WALL_STYLE_VERTICAL,
+        x ? WALL_STYLE_POST : WALL_STYLE_HORIZONTAL,
+        x ? WALL_STYLE_POST : WALL_STYLE_CORNER,
+        x ? WALL_STYLE_CORNER : WALL_STYLE_POST,
+    };
+    return styles[part];
+  }
+  case QUADRANT_SOUTHWEST: {
+    const int styles[4] = {
+        y ? WALL_STYLE_POST : WALL_STYLE_HORIZONTAL,
+        y ? WALL_STYLE_POST : WALL_STYLE_VERTICAL,
+        y ? WALL_STYLE_POST : WALL_STYLE_CORNER,
+        y ? WALL_STYLE_CORNER : WALL_STYLE_POST,
+    };
+    return styles[part];
+  }
+  case QUADRANT_NORTHWEST: {
+    const int styles[4] = {
+        y ? WALL_STYLE_VERTICAL : WALL_STYLE_HORIZONTAL,
+        WALL_STYLE_POST,
+        y ? WALL_STYLE_VERTICAL : WALL_STYLE_HORIZONTAL,
+        y ? WALL_STYLE_HORIZONTAL : WALL_STYLE_VERTICAL,
+    };
+    return styles[part];
+  }
+  default:
+    return WALL_STYLE_POST;
+  }
+}
+
+// Evaluates the rules once for every enum combination and position class so
+// that per-cell resolution is a table read
+static void buildOrientationTables(void) {
+  for (int position = 0; position < POSITION_COUNT; position++) {
+    boxOrientations[position] = classifyBox(position);
+    for (int mode = 0; mode < 3; mode++) {
+      for (int quadrant = 0; quadrant < 8; quadrant++) {
+        pathOrientations[mode][quadrant][position] =
+            classifyPath(position, mode, quadrant);
+      }
+    }
+  }
+  for (int quadrant = 0; quadrant < 8; quadrant++) {
+    for (int priority = 0; priority < 2; priority++) {
+      for (int diagonal = 0; diagonal < DIAGONAL_COUNT; diagonal++) {
+        diagonalOrientations[quadrant][priority][diagonal] =
+            classifyDiagonal(diagonal, quadrant, priority);
+      }
+    }
+  }
+  orientationTablesBuilt = true;
+}
+
+// Wall key of srcKey's group with the given orientation, or srcKey when the
+// group has none
+int lookupWallOrientation(WallOrientMap *map, int srcKey, int orient) {
+  if (map == NULL || srcKey < 0 || srcKey >= map->sourceCount || orient < 0 ||
+      orient >= WALL_ORIENTATION_COUNT) {
+    return srcKey;
+  }
+  return map->targets[srcKey * WALL_ORIENTATION_COUNT + orient];
+}
+
 void calculateWallOrientations(DrawingState *drawState, WallOrientMap *map) {
   int srcKey = drawState->activeWallKey;
   int n = drawState->drawnTilesCount;
@@ -71,6 +255,12 @@ void calculateWallOrientations(DrawingState *drawState, WallOrientMap *map) {
   if (n <= 0)
     return;
 
+  profileBeginStage(STAGE_WALL_ORIENT);
+
+  if (!orientationTablesBuilt) {
+    buildOrientationTables();
+  }
+
   // Initialize bounds to the first tile
   int x0 = drawState->drawnTiles[0][0];
   int y0 = drawState->drawnTiles[0][1];
@@ -91,244 +281,64 @@ void calculateWallOrientations(DrawingState *drawState, WallOrientMap *map) {
       maxY = y;
   }
 
-  for (int i = 0; i < n; i++) {
-    int x = drawState->drawnTiles[i][0];
-    int y = drawState->drawnTiles[i][1];
+  // The active key's wall per orientation
+  int targets[WALL_ORIENTATION_COUNT];
+  for (int orient = 0; orient < WALL_ORIENTATION_COUNT; orient++) {
+    targets[orient] = lookupWallOrientation(map, srcKey, orient);
+  }
 
-    int orient = WALL_STYLE_NONE;
-
-    // corner/post/edge logic
-    switch (drawState->drawMode) {
-    case MODE_BOX:
-      if (x == maxX && y == maxY)
-        orient = WALL_STYLE_CORNER;
-      else if (x == minX && y == minY)
-        orient = WALL_STYLE_POST;
-      else if (x == minX && y == maxY)
-        orient = WALL_STYLE_VERTICAL;
-      else if (x == maxX && y == minY)
-        orient = WALL_STYLE_HORIZONTAL;
-      else if (y == minY || y == maxY)
-        orient = WALL_STYLE_HORIZONTAL;
-      else if (x == minX || x == maxX)
-        orient = WALL_STYLE_VERTICAL;
-      break;
-    case MODE_PATHING:
-      if (drawState->pathMode == PATH_DIAGONAL) {
-        int x0, y0, sx, sy;
-        switch (drawState->pathQuadrant) {
-        case QUADRANT_SOUTHEAST:
-          x0 = minX;
-          y0 = minY;
-          sx = +1;
-          sy = +1;
-          break;
-        case QUADRANT_NORTHEAST:
-          x0 = minX;
-          y0 = maxY;
-          sx = +1;
-          sy = -1;
-          break;
-        case QUADRANT_SOUTHWEST:
-          x0 = maxX;
-          y0 = minY;
-          sx = -1;
-          sy = +1;
-          break;
-        case QUADRANT_NORTHWEST:
-          x0 = maxX;
-          y0 = maxY;
-          sx = -1;
-          sy = -1;
-          break;
-        default:
-          x0 = minX;
-          y0 = minY;
-          sx = +1;
-          sy = +1;
-          break;
-        }
-
-        int dx = sx * (x - x0);
-        int dy = sy * (y - y0);
-        int len = (maxX - minX < maxY - minY) ? (maxX - minX) : (maxY - minY);
-
-        bool onDiag = (dx == dy && dx >= 0 && dx <= len);
-        bool isStart = (dx == 0 && dy == 0);
-        bool isEnd = (dx == len && dy == len);
-
-        switch (drawState->pathQuadrant) {
-        case QUADRANT_SOUTHEAST:
-          if (isStart) {
-            orient = WALL_STYLE_POST;
-          } else if (isEnd) {
-            orient = (drawState->diagonalPriority == PRIORITY_X)
-                         ? WALL_STYLE_VERTICAL
-                         : WALL_STYLE_HORIZONTAL;
-          } else if (onDiag) {
-            orient = (drawState->diagonalPriority == PRIORITY_X)
-                         ? WALL_STYLE_VERTICAL
-                         : WALL_STYLE_HORIZONTAL;
-          } else {
-            orient = (drawState->diagonalPriority == PRIORITY_X)
-                         ? WALL_STYLE_HORIZONTAL
-                         : WALL_STYLE_VERTICAL;
-          }
-          break;
-        case QUADRANT_NORTHEAST:
-          if (isStart) {
-            orient = (drawState->diagonalPriority == PRIORITY_X)
-                         ? WALL_STYLE_POST
-                         : WALL_STYLE_VERTICAL;
-          } else if (isEnd) {
-            orient = (drawState->diagonalPriority == PRIORITY_X)
-                         ? WALL_STYLE_POST
-                         : WALL_STYLE_HORIZONTAL;
-          } else if (onDiag) {
-            orient = (drawState->diagonalPriority == PRIORITY_X)
-                         ? WALL_STYLE_POST
-                         : WALL_STYLE_CORNER;
-          } else {
-            orient = (drawState->diagonalPriority == PRIORITY_X)
-                         ? WALL_STYLE_CORNER
-                         : WALL_STYLE_POST;
-          }
-          break;
-        case QUADRANT_SOUTHWEST:
-          if (isStart) {
-            orient = (drawState->diagonalPriority == PRIORITY_Y)
-                         ? WALL_STYLE_POST
-                         : WALL_STYLE_HORIZONTAL;
-          } else if (isEnd) {
-            orient = (drawState->diagonalPriority == PRIORITY_Y)
-                         ? WALL_STYLE_POST
-                         : WALL_STYLE_VERTICAL;
-          } else if (onDiag) {
-            orient = (drawState->diagonalPriority == PRIORITY_Y)
-                         ? WALL_STYLE_POST
-                         : WALL_STYLE_CORNER;
-          } else {
-            orient = (drawState->diagonalPriority == PRIORITY_Y)
-                         ? WALL_STYLE_CORNER
-                         : WALL_STYLE_POST;
-          }
-          break;
-        case QUADRANT_NORTHWEST:
-          if (isStart) {
-            orient = (drawState->diagonalPriority == PRIORITY_Y)
-                         ? WALL_STYLE_VERTICAL
-                         : WALL_STYLE_HORIZONTAL;
-          } else if (isEnd) {
-            orient = WALL_STYLE_POST;
-          } else if (onDiag) {
-            orient = (drawState->diagonalPriority == PRIORITY_Y)
-                         ? WALL_STYLE_VERTICAL
-                         : WALL_STYLE_HORIZONTAL;
-          } else {
-            orient = (drawState->diagonalPriority == PRIORITY_Y)
-                         ? WALL_STYLE_HORIZONTAL
-                         : WALL_STYLE_VERTICAL;
-          }
-          break;
-        default:
-          orient = WALL_STYLE_POST;
-          break;
-        }
-
-      } else if (x == maxX && y == maxY) {
-        if (drawState->pathQuadrant == QUADRANT_SOUTHEAST &&
-            drawState->pathMode == PATH_STEEP) {
-          orient = WALL_STYLE_HORIZONTAL;
-        } else if (drawState->pathQuadrant == QUADRANT_SOUTHEAST &&
-                   drawState->pathMode == PATH_SHALLOW) {
-          orient = WALL_STYLE_VERTICAL;
-        } else if (drawState->pathQuadrant == QUADRANT_NORTHWEST &&
-                   drawState->pathMode == PATH_SHALLOW) {
-          orient = WALL_STYLE_HORIZONTAL;
-        } else if (drawState->pathQuadrant == QUADRANT_NORTHWEST &&
-                   drawState->pathMode == PATH_STEEP) {
-          orient = WALL_STYLE_VERTICAL;
-        } else if (drawState->pathQuadrant == QUADRANT_NORTH ||
-                   drawState->pathQuadrant == QUADRANT_SOUTH) {
-          orient = WALL_STYLE_VERTICAL;
-        } else if (drawState->pathQuadrant == QUADRANT_WEST ||
-                   drawState->pathQuadrant == QUADRANT_EAST) {
-          orient = WALL_STYLE_HORIZONTAL;
-        } else {
-          // Default case for this corner
-          orient = WALL_STYLE_CORNER;
-        }
-      } else if (x == minX && y == minY) {
-        if (drawState->pathQuadrant == QUADRANT_NORTHWEST &&
-            drawState->pathMode == PATH_STEEP) {
-          orient = WALL_STYLE_HORIZONTAL;
-        } else if (drawState->pathQuadrant == QUADRANT_NORTHWEST &&
-                   drawState->pathMode == PATH_SHALLOW) {
-          orient = WALL_STYLE_VERTICAL;
-        } else {
-          // Default case for this corner
-          orient = WALL_STYLE_POST;
-        }
-      } else if (x == minX && y == maxY) {
-        if (drawState->pathQuadrant == QUADRANT_SOUTHWEST &&
-            drawState->pathMode == PATH_STEEP) {
-          orient = WALL_STYLE_HORIZONTAL;
-        } else if (drawState->pathQuadrant == QUADRANT_SOUTHWEST &&
-                   drawState->pathMode == PATH_SHALLOW) {
-          orient = WALL_STYLE_VERTICAL;
-        } else if (drawState->pathQuadrant == QUADRANT_NORTHEAST &&
-                   drawState->pathMode == PATH_SHALLOW) {
-          orient = WALL_STYLE_POST;
-        } else {
-          // Default case for this corner
-          orient = WALL_STYLE_VERTICAL;
-        }
-      } else if (x == maxX && y == minY) {
-        if (drawState->pathQuadrant == QUADRANT_NORTHEAST &&
-            drawState->pathMode == PATH_STEEP) {
-          orient = WALL_STYLE_HORIZONTAL;
-        } else if (drawState->pathQuadrant == QUADRANT_NORTHEAST &&
-                   drawState->pathMode == PATH_SHALLOW) {
-          orient = WALL_STYLE_VERTICAL;
-        } else if (drawState->pathQuadrant == QUADRANT_SOUTHWEST &&
-                   drawState->pathMode == PATH_STEEP) {
-          orient = WALL_STYLE_POST;
-        } else {
-          // Default case for this corner
-          orient = WALL_STYLE_HORIZONTAL;
-        }
-      } else if (y == minY || y == maxY) {
-        orient = WALL_STYLE_HORIZONTAL;
-      } else if (x == minX || x == maxX) {
-        orient = WALL_STYLE_VERTICAL;
-      }
-    case MODE_PAINTER:
-      break;
+  PathQuadrant quadrant = drawState->pathQuadrant;
+
+  if (drawState->drawMode == MODE_PATHING &&
+      drawState->pathMode == PATH_DIAGONAL) {
+    // Cells are classed by their offset from the corner the path starts at
+    const unsigned char *table =
+        diagonalOrientations[quadrant][drawState->diagonalPriority];
+    int sx = diagonalSteps[quadrant][0];
+    int sy = diagonalSteps[quadrant][1];
+    int originX = sx > 0 ? minX : maxX;
+    int originY = sy > 0 ? minY : maxY;
+    int len = (maxX - minX < maxY - minY) ? (maxX - minX) : (maxY - minY);
+
+    for (int i = 0; i < n; i++) {
+      int dx = sx * (drawState->drawnTiles[i][0] - originX);
+      int dy = sy * (drawState->drawnTiles[i][1] - originY);
+      int diagonal = (dx == 0 && dy == 0) * DIAGONAL_START |
+                     (dx == len && dy == len) * DIAGONAL_END |
+                     (dx == dy && dx >= 0 && dx <= len) * DIAGONAL_ON;
+      drawState->drawnTiles[i][2] = targets[table[diagonal]];
     }
-
-    // hash lookup
-    unsigned idx = ((unsigned)srcKey ^ ((unsigned)orient << 1)) % map->capacity;
-    Entry *e = map->buckets[idx];
-
-    int target = srcKey;
-    while (e) {
-      if (e->sourceWallKey == srcKey && e->orientationKey == orient) {
-        target = e->targetWallKey;
-        break;
-      }
-      e = e->next;
+  } else {
+    // Cells are classed by which sides of the bounds they lie on
+    const unsigned char *table = painterOrientations;
+    if (drawState->drawMode == MODE_BOX) {
+      table = boxOrientations;
+    } else if (drawState->drawMode == MODE_PATHING) {
+      table = pathOrientations[drawState->pathMode][quadrant];
     }
 
-    drawState->drawnTiles[i][2] = target;
+    for (int i = 0; i < n; i++) {
+      int x = drawState->drawnTiles[i][0];
+      int y = drawState->drawnTiles[i][1];
+      int position = (x == minX) * POSITION_MIN_X |
+                     (x == maxX) * POSITION_MAX_X |
+                     (y == minY) * POSITION_MIN_Y |
+                     (y == maxY) * POSITION_MAX_Y;
+      drawState->drawnTiles[i][2] = targets[table[position]];
+    }
   }
+
+  profileEndStage(STAGE_WALL_ORIENT);
 }
 
 void computeWalls(int wallGrid[][2], int wallGridCount, Map *map,
                   Wall wallTypes[]) {
+  traceBegin("computeWalls");
 
   for (int i = 0; i < wallGridCount; i++) {
     int x = wallGrid[i][0];
     int y = wallGrid[i][1];
+    markCellDirty(map, x, y);
 
     // Initialize to empty texture
     for (int j = 0; j < 3; j++) {
@@ -348,19 +358,17 @@ void computeWalls(int wallGrid[][2], int wallGridCount, Map *map,
     }
     map->wallCount[x][y] = textureCount;
   }
+  traceEnd("computeWalls");
 }
 
 void computeMapWalls(Wall wallTypes[], Map *map) {
-  int wallGrid[GRID_SIZE * GRID_SIZE][2] = {0};
-  int wallGridCount = 0;
-
+  // Compute walls one column at a time to keep the stack small
+  int wallGrid[GRID_SIZE][2];
   for (int x = 0; x < GRID_SIZE; x++) {
     for (int y = 0; y < GRID_SIZE; y++) {
-      wallGrid[wallGridCount][0] = x;
-      wallGrid[wallGridCount][1] = y;
-      wallGridCount++;
+      wallGrid[y][0] = x;
+      wallGrid[y][1] = y;
     }
+    computeWalls(wallGrid, GRID_SIZE, map, wallTypes);
   }
-
-  computeWalls(wallGrid, wallGridCount, map, wallTypes);
 }
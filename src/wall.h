@@ -22,6 +22,8 @@ void computeWalls(int wallGrid[][2], int wallGridCount, Map *map,
 void calculateWallGrid(DrawingState *drawState, int visitedTiles[][2],
                        int *visitedCount);
 
+int lookupWallOrientation(WallOrientMap *map, int srcKey, int orient);
+
 void calculateWallOrientations(DrawingState *drawState, WallOrientMap *map);
 
 #endif // WALL_H
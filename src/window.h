@@ -22,6 +22,7 @@ typedef struct {
 // functions
 void UpdateCameraOffset(Camera2D *camera, int newWidth, int newHeight);
 
-void HandleWindowResize(WindowState *windowState, Camera2D *camera);
+void HandleWindowResize(WindowState *windowState, Camera2D *camera,
+                        int newWidth, int newHeight);
 
 #endif // WINDOW_H
@@ -30,11 +30,11 @@ CREATE TABLE IF NOT EXISTS tile(
 ) WITHOUT rowid;
 INSERT INTO tile (tile_key, walkable, description, edge_indicator, edge_priority)
     VALUES (0, 0, 'default'    , 0, 1),
-           (1, 0, 'grass'      , 1, 4),
+           (1, 1, 'grass'      , 1, 4),
            (2, 0, 'water'      , 0, 1),
-           (3, 0, 'dirt'       , 1, 3),
+           (3, 1, 'dirt'       , 1, 3),
            (4, 0, 'rock'       , 0, 1),
-           (5, 0, 'stone'      , 1, 2)
+           (5, 1, 'stone'      , 1, 2)
 ; 
 END_SQL
 